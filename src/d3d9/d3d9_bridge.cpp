@@ -104,6 +104,12 @@ namespace dxvk {
     return m_device->ResetSwapChain(Params, nullptr);
   }
 
+  HRESULT DxvkLegacyD3DDeviceBridge::SetPresentationInterval(UINT PresentationInterval) {
+    auto lock = m_device->LockDevice();
+
+    return m_device->SetPresentationInterval(PresentationInterval);
+  }
+
   HRESULT DxvkLegacyD3DDeviceBridge::SetColorKeyState(bool colorKeyState) {
     return m_device->SetColorKeyState(colorKeyState);
   }
@@ -120,6 +126,62 @@ namespace dxvk {
     return m_device->SetAlternatePixelCenter(alternatePixelCenter);
   }
 
+  HRESULT DxvkLegacyD3DDeviceBridge::SetSurfacePalette(
+        IDirect3DSurface9*  pSurface,
+        const PALETTEENTRY* pEntries) {
+    auto lock = m_device->LockDevice();
+
+    D3D9Surface* surface = static_cast<D3D9Surface*>(pSurface);
+
+    if (unlikely(surface == nullptr || pEntries == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    D3D9CommonTexture* texture = surface->GetCommonTexture();
+
+    if (unlikely(texture->GetFormatMapping().ConversionFormatInfo.FormatType != D3D9ConversionFormat_P8))
+      return D3DERR_INVALIDCALL;
+
+    texture->SetPalette(pEntries);
+
+    // Nothing has been uploaded yet, so there is nothing to expand
+    if (texture->GetMapMode() == D3D9_COMMON_TEXTURE_MAP_MODE_NONE
+     || (texture->GetMapMode() == D3D9_COMMON_TEXTURE_MAP_MODE_BACKED && texture->GetBuffer() == nullptr))
+      return D3D_OK;
+
+    // Converted textures always keep their data around, so expand it again
+    const VkOffset3D offset = { 0, 0, 0 };
+    for (UINT subresource = 0; subresource < texture->CountSubresources(); subresource++) {
+      m_device->UpdateTextureFromBuffer(
+        texture, texture,
+        subresource, subresource,
+        offset, texture->GetExtentMip(subresource), offset
+      );
+    }
+
+    if (texture->IsAutomaticMip())
+      m_device->MarkTextureMipsDirty(texture);
+
+    return D3D_OK;
+  }
+
+  HRESULT DxvkLegacyD3DDeviceBridge::GetColorKeyState(bool* pColorKeyState) {
+    if (unlikely(pColorKeyState == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    *pColorKeyState = m_device->GetColorKeyState();
+
+    return D3D_OK;
+  }
+
+  HRESULT DxvkLegacyD3DDeviceBridge::GetColorKey(DWORD* pColorKeyLow, DWORD* pColorKeyHigh) {
+    if (unlikely(pColorKeyLow == nullptr || pColorKeyHigh == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    m_device->GetColorKey(pColorKeyLow, pColorKeyHigh);
+
+    return D3D_OK;
+  }
+
   DxvkLegacyD3DInterfaceBridge::DxvkLegacyD3DInterfaceBridge(D3D9InterfaceEx* pObject)
     : m_interface(pObject) {
   }
@@ -66,6 +66,16 @@ IDxvkLegacyD3DDeviceBridge : public IUnknown {
    */
   virtual HRESULT ResetSwapChain(D3DPRESENT_PARAMETERS* Params) = 0;
 
+  /**
+   * \brief Changes the presentation interval of the implicit swapchain
+   *
+   * Takes effect with the next present, without resetting the
+   * swapchain, so all back buffers and their contents are kept.
+   *
+   * \param [in] PresentationInterval D3DPRESENT_INTERVAL value to be used
+   */
+  virtual HRESULT SetPresentationInterval(UINT PresentationInterval) = 0;
+
   /**
    * \brief Updates the color key transparency state in D3D9
    *
@@ -93,6 +103,34 @@ IDxvkLegacyD3DDeviceBridge : public IUnknown {
    * \param [in] Params bool value to be used
    */
   virtual HRESULT SetAlternatePixelCenter(bool alternatePixelCenter) = 0;
+
+  /**
+   * \brief Updates the palette used to expand a P8 surface or texture
+   *
+   * The already uploaded index data gets expanded again on the GPU,
+   * so there is no need to upload any of the surface data again.
+   *
+   * \param [in] pSurface Surface, or any surface level of the texture
+   * \param [in] pEntries 256 palette entries, with the alpha value stored in peFlags
+   */
+  virtual HRESULT SetSurfacePalette(
+      IDirect3DSurface9*        pSurface,
+      const PALETTEENTRY*       pEntries) = 0;
+
+  /**
+   * \brief Retrieves the color key transparency state in D3D9
+   *
+   * \param [out] pColorKeyState Current color key state
+   */
+  virtual HRESULT GetColorKeyState(bool* pColorKeyState) = 0;
+
+  /**
+   * \brief Retrieves the color key transparency value in D3D9
+   *
+   * \param [out] pColorKeyLow  Current low color key value
+   * \param [out] pColorKeyHigh Current high color key value
+   */
+  virtual HRESULT GetColorKey(DWORD* pColorKeyLow, DWORD* pColorKeyHigh) = 0;
 };
 
 /**
@@ -154,6 +192,8 @@ namespace dxvk {
 
     HRESULT ResetSwapChain(D3DPRESENT_PARAMETERS* Params);
 
+    HRESULT SetPresentationInterval(UINT PresentationInterval);
+
     HRESULT SetColorKeyState(bool colorKeyState);
 
     HRESULT SetColorKey(DWORD colorKeyLow, DWORD colorKeyHigh);
@@ -162,6 +202,14 @@ namespace dxvk {
 
     HRESULT SetAlternatePixelCenter(bool alternatePixelCenter);
 
+    HRESULT SetSurfacePalette(
+        IDirect3DSurface9*        pSurface,
+        const PALETTEENTRY*       pEntries);
+
+    HRESULT GetColorKeyState(bool* pColorKeyState);
+
+    HRESULT GetColorKey(DWORD* pColorKeyLow, DWORD* pColorKeyHigh);
+
   private:
 
     D3D9DeviceEx* m_device;
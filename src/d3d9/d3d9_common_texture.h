@@ -494,6 +494,22 @@ namespace dxvk {
 
     ID3D9VkInteropTexture* GetVkInterop() { return &m_d3d9Interop; }
 
+    /**
+     * \brief Palette
+     * \returns The palette used to expand P8 texture data
+     */
+    const std::array<PALETTEENTRY, caps::MaxPaletteEntries>& GetPalette() const {
+      return m_palette;
+    }
+
+    /**
+     * \brief Sets the palette used to expand P8 texture data
+     * \param [in] pEntries 256 entries, with the alpha value stored in peFlags
+     */
+    void SetPalette(const PALETTEENTRY* pEntries) {
+      std::memcpy(m_palette.data(), pEntries, sizeof(PALETTEENTRY) * m_palette.size());
+    }
+
   private:
 
     D3D9DeviceEx*                 m_device;
@@ -540,6 +556,9 @@ namespace dxvk {
 
     std::array<D3DBOX, 6>         m_dirtyBoxes;
 
+    std::array<PALETTEENTRY,
+      caps::MaxPaletteEntries>    m_palette = { };
+
     D3D9VkInteropTexture          m_d3d9Interop;
 
     Rc<DxvkImage> CreatePrimaryImage(D3DRESOURCETYPE ResourceType, HANDLE* pSharedHandle) const;
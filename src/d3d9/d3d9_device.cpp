@@ -5424,15 +5424,22 @@ namespace dxvk {
       VkExtent3D srcBlockCount = util::computeBlockCount(srcTexLevelExtent, srcBlockSize);
       srcBlockCount.height *= std::min(pSrcTexture->GetPlaneCount(), 2u);
 
+      // P8 textures get their palette placed in front of the index data
+      const VkDeviceSize paletteSize = convertFormat.FormatType == D3D9ConversionFormat_P8
+                                     ? sizeof(PALETTEENTRY) * PaletteEntryCount : 0;
+
       // the converter can not handle the 4 aligned pitch so we always repack into a staging buffer
-      D3D9BufferSlice slice = AllocStagingBuffer(pSrcTexture->GetMipSize(SrcSubresource));
+      D3D9BufferSlice slice = AllocStagingBuffer(paletteSize + pSrcTexture->GetMipSize(SrcSubresource));
       VkDeviceSize pitch = align(srcBlockCount.width * formatElementSize, 4);
 
       const DxvkFormatInfo* convertedFormatInfo = lookupFormatInfo(convertFormat.Format);
       VkImageSubresourceLayers convertedDstLayers = { convertedFormatInfo->aspectMask, dstSubresource.mipLevel, dstSubresource.arrayLayer, 1 };
 
+      if (unlikely(paletteSize != 0))
+        std::memcpy(slice.mapPtr, pDestTexture->GetPalette().data(), paletteSize);
+
       util::packImageData(
-        slice.mapPtr, mapPtr, srcBlockCount, formatElementSize,
+        reinterpret_cast<uint8_t*>(slice.mapPtr) + paletteSize, mapPtr, srcBlockCount, formatElementSize,
         pitch, std::min(pSrcTexture->GetPlaneCount(), 2u) * pitch * srcBlockCount.height);
 
       EmitCs([this,
@@ -9005,6 +9012,24 @@ namespace dxvk {
   }
 
 
+  HRESULT D3D9DeviceEx::SetPresentationInterval(UINT PresentationInterval) {
+    if (unlikely(PresentationInterval != D3DPRESENT_INTERVAL_DEFAULT
+              && PresentationInterval != D3DPRESENT_INTERVAL_ONE
+              && PresentationInterval != D3DPRESENT_INTERVAL_TWO
+              && PresentationInterval != D3DPRESENT_INTERVAL_THREE
+              && PresentationInterval != D3DPRESENT_INTERVAL_FOUR
+              && PresentationInterval != D3DPRESENT_INTERVAL_IMMEDIATE))
+      return D3DERR_INVALIDCALL;
+
+    if (unlikely(m_implicitSwapchain == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    m_implicitSwapchain->SetPresentationInterval(PresentationInterval);
+
+    return D3D_OK;
+  }
+
+
   HRESULT D3D9DeviceEx::InitialReset(D3DPRESENT_PARAMETERS* pPresentationParameters, D3DDISPLAYMODEEX* pFullscreenDisplayMode) {
     ResetState(pPresentationParameters);
 
@@ -1099,6 +1099,8 @@ namespace dxvk {
     void ResetState(D3DPRESENT_PARAMETERS* pPresentationParameters);
     HRESULT ResetSwapChain(D3DPRESENT_PARAMETERS* pPresentationParameters, D3DDISPLAYMODEEX* pFullscreenDisplayMode);
 
+    HRESULT SetPresentationInterval(UINT PresentationInterval);
+
     HRESULT InitialReset(D3DPRESENT_PARAMETERS* pPresentationParameters, D3DDISPLAYMODEEX* pFullscreenDisplayMode);
 
     /**
@@ -1468,6 +1470,15 @@ namespace dxvk {
       return D3D_OK;
     }
 
+    bool GetColorKeyState() const {
+      return m_specData.colorKeyEnable;
+    }
+
+    void GetColorKey(DWORD* pColorKeyLow, DWORD* pColorKeyHigh) const {
+      *pColorKeyLow  = m_pushData.ffps.colorKeyLow;
+      *pColorKeyHigh = m_pushData.ffps.colorKeyHigh;
+    }
+
     void UpdateFixedFunctionVS();
 
     void UpdateFixedFunctionPS();
@@ -103,7 +103,13 @@ namespace dxvk {
 
       case D3D9Format::A8P8: return {}; // Unsupported
 
-      case D3D9Format::P8: return {}; // Unsupported
+      case D3D9Format::P8: return { // Supported in D3D7 and earlier
+        VK_FORMAT_R8_UNORM,
+        VK_FORMAT_UNDEFINED,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+          VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
+        { D3D9ConversionFormat_P8, VK_FORMAT_B8G8R8A8_UNORM }};
 
       case D3D9Format::L8: return {
         VK_FORMAT_R8_UNORM,
@@ -496,6 +502,8 @@ namespace dxvk {
     m_x4r4g4b4Support = options.supportX4R4G4B4;
     // R3G3B2 is only supported by D3D7 and earlier
     m_r3g3b2Support = false;
+    // P8 is only supported by D3D7 and earlier
+    m_p8Support = false;
     // W11V11U10 is only supported by D3D8
     m_w11v11u10Support = false;
     // Only AMD supports D16_LOCKABLE natively
@@ -540,6 +548,9 @@ namespace dxvk {
     if (Format == D3D9Format::R3G3B2 && !m_r3g3b2Support)
       return D3D9_VK_FORMAT_MAPPING();
 
+    if (Format == D3D9Format::P8 && !m_p8Support)
+      return D3D9_VK_FORMAT_MAPPING();
+
     if (Format == D3D9Format::W11V11U10 && !m_w11v11u10Support)
       return D3D9_VK_FORMAT_MAPPING();
 
@@ -604,6 +615,7 @@ namespace dxvk {
       case D3D9Format::A8P8:
         return &a8p8;
 
+      // only supported by D3D7 and earlier
       case D3D9Format::P8:
         return &p8;
 
@@ -663,6 +675,8 @@ namespace dxvk {
     const D3D9Adapter*          pParent) {
     // R3G2B2 is only supported by D3D7 and earlier
     m_r3g3b2Support = pParent->IsD3DCompatibile(D3DCompatibility::D3D7);
+    // P8 is only supported by D3D7 and earlier
+    m_p8Support = pParent->IsD3DCompatibile(D3DCompatibility::D3D7);
     // W11V11U10 is only supported by D3D8
     m_w11v11u10Support = pParent->IsD3DCompatibile(D3DCompatibility::D3D8);
   }
@@ -145,6 +145,7 @@ namespace dxvk {
     D3D9ConversionFormat_W11V11U10,
     D3D9ConversionFormat_NV12,
     D3D9ConversionFormat_YV12,
+    D3D9ConversionFormat_P8,
     D3D9ConversionFormat_Count
   };
 
@@ -241,6 +242,7 @@ namespace dxvk {
     bool m_dfSupport;
     bool m_x4r4g4b4Support;
     bool m_r3g3b2Support;
+    bool m_p8Support;
     bool m_w11v11u10Support;
     bool m_d16lockableSupport;
 
@@ -8,6 +8,7 @@
 #include <d3d9_convert_w11v11u10.h>
 #include <d3d9_convert_nv12.h>
 #include <d3d9_convert_yv12.h>
+#include <d3d9_convert_p8.h>
 
 namespace dxvk {
 
@@ -51,6 +52,10 @@ namespace dxvk {
         ConvertGenericFormat(ctx, conversionFormat, dstImage, dstSubresource, srcSlice, VK_FORMAT_R8_UINT, { 1u, 1u });
         break;
 
+      case D3D9ConversionFormat_P8:
+        ConvertGenericFormat(ctx, conversionFormat, dstImage, dstSubresource, srcSlice, VK_FORMAT_R8_UINT, { 1u, 1u });
+        break;
+
       case D3D9ConversionFormat_L6V5U5:
         ConvertGenericFormat(ctx, conversionFormat, dstImage, dstSubresource, srcSlice, VK_FORMAT_R16_UINT, { 1u, 1u });
         break;
@@ -155,6 +160,7 @@ namespace dxvk {
     m_pipelines[D3D9ConversionFormat_W11V11U10] = CreatePipeline(sizeof(d3d9_convert_w11v11u10), d3d9_convert_w11v11u10, 0);
     m_pipelines[D3D9ConversionFormat_NV12] = CreatePipeline(sizeof(d3d9_convert_nv12), d3d9_convert_nv12, 0);
     m_pipelines[D3D9ConversionFormat_YV12] = CreatePipeline(sizeof(d3d9_convert_yv12), d3d9_convert_yv12, 0);
+    m_pipelines[D3D9ConversionFormat_P8] = CreatePipeline(sizeof(d3d9_convert_p8), d3d9_convert_p8, 0);
   }
 
 
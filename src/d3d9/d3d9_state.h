@@ -19,7 +19,7 @@ namespace dxvk {
   static constexpr uint32_t SamplerStateCount = D3DSAMP_DMAPOFFSET + 1;
   static constexpr uint32_t SamplerCount      = caps::MaxTexturesPS + caps::MaxTexturesVS + 1;
   static constexpr uint32_t TextureStageStateCount = DXVK_TSS_COUNT;
-  static constexpr uint32_t PaletteEntryCount = 256;
+  static constexpr uint32_t PaletteEntryCount = caps::MaxPaletteEntries;
   
   struct D3D9ClipPlane {
     float coeff[4] = {};
@@ -130,6 +130,12 @@ namespace dxvk {
 
     const D3DPRESENT_PARAMETERS* GetPresentParams() const { return &m_presentParams; }
 
+    // The presenter picks up the new sync interval on
+    // the next present, so nothing needs to be recreated
+    void SetPresentationInterval(UINT PresentationInterval) {
+      m_presentParams.PresentationInterval = PresentationInterval;
+    }
+
     void SyncFrameLatency();
 
     void DestroyBackBuffers();
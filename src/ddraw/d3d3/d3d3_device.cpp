@@ -369,6 +369,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D3Device::BeginScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(m_commonD3DDevice->IsInScene()))
@@ -386,6 +388,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D3Device::EndScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(!m_commonD3DDevice->IsInScene()))
@@ -444,6 +448,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D3Device::Execute(IDirect3DExecuteBuffer *buffer, IDirect3DViewport *viewport, DWORD flags) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(buffer == nullptr || viewport == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -451,8 +457,8 @@ namespace dxvk {
 
     D3D3ExecuteBuffer* d3d3ExecuteBuffer = static_cast<D3D3ExecuteBuffer*>(buffer);
 
-    std::vector<uint8_t> executeBuffer = d3d3ExecuteBuffer->GetBuffer();
-    if (unlikely(executeBuffer.size() == 0))
+    // The buffer contents are read in place, without making a copy
+    if (unlikely(d3d3ExecuteBuffer->GetBufferSize() == 0))
       return DDERR_INVALIDPARAMS;
 
     d3d3ExecuteBuffer->SetExecutedState(true);
@@ -479,25 +485,37 @@ namespace dxvk {
 
     D3DEXECUTEDATA* executeData = d3d3ExecuteBuffer->GetExecuteDataInternal();
 
-    uint8_t* buf = executeBuffer.data();
+    // The instruction stream only gets decoded again after a Lock or SetExecuteData
+    const std::vector<D3D3ExecuteInstruction>& program = d3d3ExecuteBuffer->GetProgram();
+
+    uint8_t* buf = d3d3ExecuteBuffer->GetBufferData();
+    const size_t bufferSize = d3d3ExecuteBuffer->GetBufferSize();
     D3DVERTEX* vertexBuffer = reinterpret_cast<D3DVERTEX*>(buf + executeData->dwVertexOffset);
-    D3DTLVERTEX* hVertexBuffer = reinterpret_cast<D3DTLVERTEX*>(buf + executeData->dwHVertexOffset);
+    D3DTLVERTEX* hVertexBuffer = d3d3ExecuteBuffer->GetProcessedVertices();
 
-    uint8_t* ptr = buf + executeData->dwInstructionOffset;
+    // Vertices will have to be processed again before they can be drawn
+    m_executeVerticesDirty = true;
 
-    // We can't rely on executeData->dwInstructionLength being correct.
-    while (true) {
-      D3DINSTRUCTION* instruction = reinterpret_cast<D3DINSTRUCTION*>(ptr);
-      ptr += sizeof(D3DINSTRUCTION);
-      uint8_t* operation = ptr;
+    uint32_t index = 0;
 
-      if (instruction->bOpcode == D3DOP_EXIT)
-        break;
+    while (index < program.size()) {
+      const D3D3ExecuteInstruction& instruction = program[index];
+      uint8_t* operation = buf + instruction.offset;
 
-      switch (instruction->bOpcode) {
+      index = instruction.next;
+
+      // Consecutive draws get merged into a single indexed draw,
+      // which needs to go out before any state can be changed
+      if (instruction.opcode != D3DOP_TRIANGLE && instruction.opcode != D3DOP_LINE
+       && instruction.opcode != D3DOP_POINT    && instruction.opcode != D3DOP_BRANCHFORWARD)
+        FlushExecuteDraws(executeData->dwVertexCount, hVertexBuffer);
+
+      switch (instruction.opcode) {
+        case D3DOP_EXIT:
+          break;
         case D3DOP_BRANCHFORWARD: {
           D3DBRANCH* branch = reinterpret_cast<D3DBRANCH*>(operation);
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             const D3DBRANCH& b = branch[i];
 
             bool masked = (executeData->dsStatus.dwStatus & b.dwMask) == b.dwValue;
@@ -505,41 +523,37 @@ namespace dxvk {
               masked = !masked;
             }
 
+            // Branch offsets are relative to the start of the instruction
             if (masked && b.dwOffset) {
-              ptr = reinterpret_cast<uint8_t*>(instruction) + branch->dwOffset;
+              index = d3d3ExecuteBuffer->GetInstructionIndex(instruction.offset - sizeof(D3DINSTRUCTION) + b.dwOffset);
               break;
             }
-
-            ptr += instruction->bSize;
           }
 
           break;
         }
         case D3DOP_LINE: {
           D3DLINE* line = reinterpret_cast<D3DLINE*>(operation);
-          DrawLineInternal(line, instruction->wCount, executeData->dwVertexCount, hVertexBuffer);
+          DrawLineInternal(line, instruction.count, executeData->dwVertexCount, hVertexBuffer);
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_POINT: {
           D3DPOINT* point = reinterpret_cast<D3DPOINT*>(operation);
-          DrawPointInternal(point, instruction->wCount, executeData->dwVertexCount, hVertexBuffer);
+          DrawPointInternal(point, instruction.count, executeData->dwVertexCount, hVertexBuffer);
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_TRIANGLE: {
           D3DTRIANGLE* triangle = reinterpret_cast<D3DTRIANGLE*>(operation);
-          DrawTriangleInternal(triangle, instruction->wCount, executeData->dwVertexCount, hVertexBuffer);
+          DrawTriangleInternal(triangle, instruction.count, executeData->dwVertexCount, hVertexBuffer);
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_MATRIXLOAD: {
           D3DMATRIXLOAD* matrixLoad = reinterpret_cast<D3DMATRIXLOAD*>(operation);
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             D3DMATRIXLOAD& ml = matrixLoad[i];
 
             D3DMATRIX srcMatrix;
@@ -554,13 +568,12 @@ namespace dxvk {
               Logger::warn(str::format("D3D3Device::Execute: D3DOP_MATRIXLOAD failed to set matrix to destination: ", ml.hDestMatrix));
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_MATRIXMULTIPLY: {
           D3DMATRIXMULTIPLY* matrixMultiply = reinterpret_cast<D3DMATRIXMULTIPLY*>(operation);
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             D3DMATRIXMULTIPLY& mm = matrixMultiply[i];
 
             D3DMATRIX srcMatrix1;
@@ -586,16 +599,26 @@ namespace dxvk {
               Logger::warn(str::format("D3D3Device::Execute: D3DOP_MATRIXMULTIPLY failed to set matrix to destination: ", mm.hDestMatrix));
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_PROCESSVERTICES: {
           D3DPROCESSVERTICES* processVertices = reinterpret_cast<D3DPROCESSVERTICES*>(operation);
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             D3DPROCESSVERTICES& pv = processVertices[i];
             const DWORD op = pv.dwFlags & D3DPROCESSVERTICES_OPMASK;
 
+            // Both the source vertices and the processed vertices need to stay within their buffers
+            if (unlikely(pv.wDest + pv.dwCount > executeData->dwVertexCount
+                      || executeData->dwVertexOffset + (pv.wStart + pv.dwCount) * sizeof(D3DVERTEX) > bufferSize)) {
+              static bool s_processVerticesErrorShown;
+
+              if (!std::exchange(s_processVerticesErrorShown, true))
+                Logger::warn("D3D3Device::Execute: D3DOP_PROCESSVERTICES is out of bounds");
+
+              continue;
+            }
+
             switch (op) {
               case D3DPROCESSVERTICES_COPY: {
                 memcpy(&hVertexBuffer[pv.wDest], &vertexBuffer[pv.wStart], sizeof(D3DTLVERTEX) * pv.dwCount);
@@ -613,7 +636,7 @@ namespace dxvk {
                 pvData.inData = buf + executeData->dwVertexOffset + pv.wStart * sizeof(D3DVERTEX);
                 pvData.inFVF = doLighting ? D3DFVF_VERTEX : D3DFVF_LVERTEX;
                 pvData.inStride = sizeof(D3DVERTEX);
-                pvData.outData = buf + executeData->dwHVertexOffset + pv.wDest * sizeof(D3DTLVERTEX);
+                pvData.outData = reinterpret_cast<uint8_t*>(&hVertexBuffer[pv.wDest]);
                 pvData.outFVF = D3DFVF_TLVERTEX;
                 pvData.outStride = sizeof(D3DTLVERTEX);
                 pvData.vertexCount = pv.dwCount;
@@ -624,16 +647,10 @@ namespace dxvk {
                 pvData.doNotCopyData = pv.dwFlags & D3DPROCESSVERTICES_NOCOLOR;
                 pvData.doExtents = pv.dwFlags & D3DPROCESSVERTICES_UPDATEEXTENTS;
                 pvData.isLegacy = true;
+                pvData.viewport = commonViewport;
+                pvData.workerPool = m_commonD3DDevice->GetWorkerPool();
 
-                std::vector<d3d9::D3DLIGHT9> lights9;
-                if (doLighting) {
-                  commonViewport->GetD3D9Lights(&lights9);
-                  pvData.lights = &lights9;
-                } else {
-                  pvData.lights = nullptr;
-                }
-
-                ProcessVerticesSW(device9, m_commonIntf->GetOptions(), &pvData);
+                ProcessVerticesSW(m_commonD3DDevice.ptr(), m_commonIntf->GetOptions(), &pvData);
 
                 break;
               }
@@ -642,43 +659,41 @@ namespace dxvk {
             m_stats.dwVerticesProcessed += pv.dwCount;
           }
 
-          ptr += instruction->bSize * instruction->wCount;
+          m_executeVerticesDirty = true;
+
           break;
         }
         case D3DOP_SPAN: {
           D3DSPAN* span = reinterpret_cast<D3DSPAN*>(operation);
-          DrawSpanInternal(span, instruction->wCount, executeData->dwVertexCount, hVertexBuffer);
+          DrawSpanInternal(span, instruction.count, executeData->dwVertexCount, hVertexBuffer);
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_STATELIGHT: {
           D3DSTATE* state = reinterpret_cast<D3DSTATE*>(operation);
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             const D3DSTATE& s = state[i];
             SetLightStateInternal(s.dlstLightStateType, s.dwArg[0]);
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_STATERENDER: {
           D3DSTATE* state = reinterpret_cast<D3DSTATE*>(operation);
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             const D3DSTATE& s = state[i];
             SetRenderStateInternal(s.drstRenderStateType, s.dwArg[0]);
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_STATETRANSFORM: {
           D3DSTATE* state = reinterpret_cast<D3DSTATE*>(operation);
           D3DMATRIX matrix;
 
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             const D3DSTATE& s = state[i];
 
             if (unlikely(s.dwArg[0] == 0))
@@ -688,7 +703,7 @@ namespace dxvk {
             if (unlikely(FAILED(hr)))
               continue;
 
-            hr = device9->SetTransform(ConvertTransformState(s.dtstTransformStateType), &matrix);
+            hr = m_commonD3DDevice->SetTransform(ConvertTransformState(s.dtstTransformStateType), &matrix);
             if (likely(SUCCEEDED(hr))) {
               if (s.dtstTransformStateType == D3DTRANSFORMSTATE_WORLD) {
                 m_worldHandle = s.dwArg[0];
@@ -702,32 +717,30 @@ namespace dxvk {
             }
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_SETSTATUS: {
           D3DSTATUS* status = reinterpret_cast<D3DSTATUS*>(operation);
-          for (uint16_t i = 0; i < instruction->wCount; i++) {
+          for (uint16_t i = 0; i < instruction.count; i++) {
             executeData->dsStatus = status[i];
           }
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
         case D3DOP_TEXTURELOAD: {
           D3DTEXTURELOAD* textureLoad = reinterpret_cast<D3DTEXTURELOAD*>(operation);
-          TextureLoadInternal(textureLoad, instruction->wCount);
+          TextureLoadInternal(textureLoad, instruction.count);
 
-          ptr += instruction->bSize * instruction->wCount;
           break;
         }
+        // Unknown opcodes have already been reported during compilation
         default:
-          Logger::err(str::format("D3D3Device::Execute: Unknown opcode encountered: ", static_cast<uint32_t>(instruction->bOpcode)));
-          ptr += instruction->bSize * instruction->wCount;
           break;
       }
     }
 
+    FlushExecuteDraws(executeData->dwVertexCount, hVertexBuffer);
+
     d3d3ExecuteBuffer->SetExecutedState(false);
 
     return D3D_OK;
@@ -794,17 +807,17 @@ namespace dxvk {
 
     // Update D3D9 transforms if the updated matrix is in use
     if (m_worldHandle == handle) {
-      HRESULT hr = m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), matrix);
+      HRESULT hr = m_commonD3DDevice->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), matrix);
       if (unlikely(FAILED(hr)))
         Logger::warn("D3D3Device::SetMatrix: Failed to update D3D9 world transform");
     }
     if (m_viewHandle == handle) {
-      HRESULT hr = m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), matrix);
+      HRESULT hr = m_commonD3DDevice->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), matrix);
       if (unlikely(FAILED(hr)))
         Logger::warn("D3D3Device::SetMatrix: Failed to update D3D9 view transform");
     }
     if (m_projectionHandle == handle) {
-      HRESULT hr = m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), matrix);
+      HRESULT hr = m_commonD3DDevice->SetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), matrix);
       if (unlikely(FAILED(hr)))
         Logger::warn("D3D3Device::SetMatrix: Failed to update D3D9 projection transform");
     }
@@ -1316,7 +1329,10 @@ namespace dxvk {
   }
 
   inline void D3D3Device::DrawTriangleInternal(D3DTRIANGLE* triangle, uint16_t count, DWORD vertexCount, const D3DTLVERTEX* vertexBuffer) {
-    std::vector<D3DTLVERTEX> vertices;
+    if (m_executePrimitiveType != d3d9::D3DPT_TRIANGLELIST)
+      FlushExecuteDraws(vertexCount, vertexBuffer);
+
+    m_executePrimitiveType = d3d9::D3DPT_TRIANGLELIST;
 
     for (uint16_t i = 0; i < count; i++) {
       const D3DTRIANGLE& t = triangle[i];
@@ -1328,36 +1344,17 @@ namespace dxvk {
       // (D3DTRIFLAG_START, D3DTRIFLAG_STARTFLAT(1-29), D3DTRIFLAG_ODD(strip),
       // D3DTRIFLAG_EVEN(fan) and D3DTRIFLAG_EDGEENABLE).
 
-      vertices.push_back(vertexBuffer[t.v1]);
-      vertices.push_back(vertexBuffer[t.v2]);
-      vertices.push_back(vertexBuffer[t.v3]);
-    }
-
-    if (likely(!vertices.empty())) {
-      DDrawDirtySurfaceUpload();
-
-      d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
-
-      device9->SetFVF(D3DFVF_TLVERTEX);
-      HRESULT hr = device9->DrawPrimitiveUP(
-           d3d9::D3DPT_TRIANGLELIST,
-           GetPrimitiveCount(D3DPT_TRIANGLELIST, vertices.size()),
-           vertices.data(),
-           GetFVFSize(D3DFVF_TLVERTEX));
-
-      if (SUCCEEDED(hr)) {
-        UpdateSurfaceDirtyTracking(true, true, true);
-        m_stats.dwTrianglesDrawn += std::max<DWORD>(vertices.size() / 3, 0u);
-      } else {
-        Logger::err(str::format("D3D3Device::Execute: D3DOP_TRIANGLE failed to draw vertices: ", vertices.size()));
-      }
-
-      vertices.clear();
+      m_executeIndices.push_back(t.v1);
+      m_executeIndices.push_back(t.v2);
+      m_executeIndices.push_back(t.v3);
     }
   }
 
   inline void D3D3Device::DrawLineInternal(D3DLINE* line, uint16_t count, DWORD vertexCount, const D3DTLVERTEX* vertexBuffer) {
-    std::vector<D3DTLVERTEX> vertices;
+    if (m_executePrimitiveType != d3d9::D3DPT_LINELIST)
+      FlushExecuteDraws(vertexCount, vertexBuffer);
+
+    m_executePrimitiveType = d3d9::D3DPT_LINELIST;
 
     for (uint16_t i = 0; i < count; i++) {
       const D3DLINE& l = line[i];
@@ -1365,35 +1362,16 @@ namespace dxvk {
       if (l.v1 >= vertexCount || l.v2 >= vertexCount)
         continue;
 
-      vertices.push_back(vertexBuffer[l.v1]);
-      vertices.push_back(vertexBuffer[l.v2]);
-    }
-
-    if (likely(!vertices.empty())) {
-      DDrawDirtySurfaceUpload();
-
-      d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
-
-      device9->SetFVF(D3DFVF_TLVERTEX);
-      HRESULT hr = device9->DrawPrimitiveUP(
-           d3d9::D3DPT_LINELIST,
-           GetPrimitiveCount(D3DPT_LINELIST, vertices.size()),
-           vertices.data(),
-           GetFVFSize(D3DFVF_TLVERTEX));
-
-      if (SUCCEEDED(hr)) {
-        UpdateSurfaceDirtyTracking(true, true, true);
-        m_stats.dwLinesDrawn += std::max<DWORD>(vertices.size() / 2, 0u);
-      } else {
-        Logger::err(str::format("D3D3Device::Execute: D3DOP_LINE failed to draw vertices: ", vertices.size()));
-      }
-
-      vertices.clear();
+      m_executeIndices.push_back(l.v1);
+      m_executeIndices.push_back(l.v2);
     }
   }
 
   inline void D3D3Device::DrawPointInternal(D3DPOINT* point, uint16_t count, DWORD vertexCount, const D3DTLVERTEX* vertexBuffer) {
-    std::vector<D3DTLVERTEX> vertices;
+    if (m_executePrimitiveType != d3d9::D3DPT_POINTLIST)
+      FlushExecuteDraws(vertexCount, vertexBuffer);
+
+    m_executePrimitiveType = d3d9::D3DPT_POINTLIST;
 
     for (uint16_t i = 0; i < count; i++) {
       const D3DPOINT& p = point[i];
@@ -1402,31 +1380,73 @@ namespace dxvk {
         continue;
 
       for (DWORD x = 0; x < std::min(static_cast<DWORD>(p.wCount), vertexCount - p.wFirst); x++) {
-        vertices.push_back(vertexBuffer[p.wFirst + x]);
+        m_executeIndices.push_back(static_cast<WORD>(p.wFirst + x));
       }
     }
+  }
 
-    if (likely(!vertices.empty())) {
-      DDrawDirtySurfaceUpload();
+  inline void D3D3Device::FlushExecuteDraws(DWORD vertexCount, const D3DTLVERTEX* vertexBuffer) {
+    if (m_executeIndices.empty())
+      return;
 
-      d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
+    const UINT indexCount = static_cast<UINT>(m_executeIndices.size());
 
-      device9->SetFVF(D3DFVF_TLVERTEX);
-      HRESULT hr = device9->DrawPrimitiveUP(
-           d3d9::D3DPT_POINTLIST,
-           GetPrimitiveCount(D3DPT_POINTLIST, vertices.size()),
-           vertices.data(),
-           GetFVFSize(D3DFVF_TLVERTEX));
+    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-      if (SUCCEEDED(hr)) {
-        UpdateSurfaceDirtyTracking(true, true, true);
-        m_stats.dwPointsDrawn += static_cast<DWORD>(vertices.size());
-      } else {
-        Logger::err(str::format("D3D3Device::Execute: D3DOP_POINT failed to draw vertices: ", vertices.size()));
-      }
+    DDrawDirtySurfaceUpload();
 
-      vertices.clear();
+    // Anything pending may still write to the streaming buffers
+    m_commonD3DDevice->FlushBatchedDraws();
+
+    // Processed vertices only get uploaded once, until they are processed
+    // again, or until the streaming vertex buffer gets discarded
+    HRESULT hr;
+    if (m_executeVerticesDirty || m_executeVBDiscards != m_commonD3DDevice->GetStreamingVertexDiscards()) {
+      hr = m_commonD3DDevice->SetStreamingVertices(D3DFVF_TLVERTEX, vertexBuffer, vertexCount, &m_executeBaseVertex);
+
+      m_executeVerticesDirty = false;
+      m_executeVBDiscards    = m_commonD3DDevice->GetStreamingVertexDiscards();
+    } else {
+      hr = m_commonD3DDevice->BindStreamingVertices(D3DFVF_TLVERTEX);
     }
+
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D3Device::FlushExecuteDraws: Failed to upload vertices");
+      m_executeVerticesDirty = true;
+      m_executeIndices.clear();
+      return;
+    }
+
+    UINT startIndex = 0;
+    hr = m_commonD3DDevice->SetStreamingIndices(m_executeIndices.data(), indexCount, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D3Device::FlushExecuteDraws: Failed to upload indices");
+      m_executeIndices.clear();
+      return;
+    }
+
+    hr = device9->DrawIndexedPrimitive(
+                      m_executePrimitiveType,
+                      m_executeBaseVertex,
+                      0,
+                      vertexCount,
+                      startIndex,
+                      GetPrimitiveCount(D3DPRIMITIVETYPE(m_executePrimitiveType), indexCount));
+
+    if (likely(SUCCEEDED(hr))) {
+      UpdateSurfaceDirtyTracking(true, true, true);
+
+      if (m_executePrimitiveType == d3d9::D3DPT_TRIANGLELIST)
+        m_stats.dwTrianglesDrawn += indexCount / 3;
+      else if (m_executePrimitiveType == d3d9::D3DPT_LINELIST)
+        m_stats.dwLinesDrawn += indexCount / 2;
+      else
+        m_stats.dwPointsDrawn += indexCount;
+    } else {
+      Logger::err(str::format("D3D3Device::FlushExecuteDraws: Failed to draw indices: ", indexCount));
+    }
+
+    m_executeIndices.clear();
   }
 
   inline void D3D3Device::DrawSpanInternal(D3DSPAN* span, uint16_t count, DWORD vertexCount, const D3DTLVERTEX* vertexBuffer) {
@@ -1448,12 +1468,15 @@ namespace dxvk {
 
       d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-      device9->SetFVF(D3DFVF_TLVERTEX);
-      HRESULT hr = device9->DrawPrimitiveUP(
-           d3d9::D3DPT_LINESTRIP,
-           GetPrimitiveCount(D3DPT_LINESTRIP, vertices.size()),
-           vertices.data(),
-           GetFVFSize(D3DFVF_TLVERTEX));
+      UINT baseVertex = 0;
+
+      HRESULT hr = m_commonD3DDevice->SetStreamingVertices(D3DFVF_TLVERTEX, vertices.data(), vertices.size(), &baseVertex);
+      if (SUCCEEDED(hr)) {
+        hr = device9->DrawPrimitive(
+             d3d9::D3DPT_LINESTRIP,
+             baseVertex,
+             GetPrimitiveCount(D3DPT_LINESTRIP, vertices.size()));
+      }
 
       if (SUCCEEDED(hr)) {
         UpdateSurfaceDirtyTracking(true, true, true);
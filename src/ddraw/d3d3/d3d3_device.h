@@ -124,6 +124,8 @@ namespace dxvk {
 
     inline void DrawSpanInternal(D3DSPAN* span, uint16_t count, DWORD vertexCount, const D3DTLVERTEX* vertexBuffer);
 
+    inline void FlushExecuteDraws(DWORD vertexCount, const D3DTLVERTEX* vertexBuffer);
+
     inline void TextureLoadInternal(D3DTEXTURELOAD* textureLoad, uint16_t count);
 
     inline void RefreshLastUsedDevice() {
@@ -156,6 +158,14 @@ namespace dxvk {
     std::atomic<D3DMATRIXHANDLE>    m_matrixHandle     = 0;
     std::unordered_map<D3DMATRIXHANDLE, D3DMATRIX> m_matrices;
 
+    // Execute buffer draws get merged into indexed draws of the processed
+    // vertices, whenever possible, which stay in the streaming vertex buffer
+    UINT                              m_executeBaseVertex    = 0;
+    uint64_t                          m_executeVBDiscards    = 0;
+    bool                              m_executeVerticesDirty = true;
+    d3d9::D3DPRIMITIVETYPE            m_executePrimitiveType = d3d9::D3DPT_TRIANGLELIST;
+    std::vector<WORD>                 m_executeIndices;
+
   };
 
 }
\ No newline at end of file
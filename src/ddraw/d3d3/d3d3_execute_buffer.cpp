@@ -76,6 +76,8 @@ namespace dxvk {
     lpDesc->lpData = m_buffer.data();
 
     m_locked = true;
+    // The application is free to change the instruction stream
+    m_programValid = false;
 
     return D3D_OK;
   }
@@ -101,6 +103,7 @@ namespace dxvk {
       return DDERR_INVALIDPARAMS;
 
     m_executeData = *lpData;
+    m_programValid = false;
 
     return D3D_OK;
   }
@@ -124,4 +127,103 @@ namespace dxvk {
     return DDERR_UNSUPPORTED;
   }
 
+  void D3D3ExecuteBuffer::CompileProgram() {
+    m_program.clear();
+    m_programOffsets.clear();
+
+    m_hVertices.resize(m_executeData.dwVertexCount);
+
+    const size_t bufferSize = m_buffer.size();
+
+    // Branch targets get compiled as separate runs of instructions,
+    // since whatever lies in between them may not be valid at all
+    std::vector<uint32_t> pending = { m_executeData.dwInstructionOffset };
+
+    while (!pending.empty()) {
+      uint32_t offset = pending.back();
+      pending.pop_back();
+
+      uint32_t prevIndex = InvalidInstruction;
+
+      while (true) {
+        // Link up with any instructions which have already been compiled
+        auto programOffset = m_programOffsets.find(offset);
+        if (programOffset != m_programOffsets.end()) {
+          if (prevIndex != InvalidInstruction)
+            m_program[prevIndex].next = programOffset->second;
+          break;
+        }
+
+        const uint32_t index = static_cast<uint32_t>(m_program.size());
+        if (prevIndex != InvalidInstruction)
+          m_program[prevIndex].next = index;
+        m_programOffsets.emplace(offset, index);
+
+        D3D3ExecuteInstruction instruction = { D3DOP_EXIT, 0, 0,
+                                               static_cast<uint32_t>(offset + sizeof(D3DINSTRUCTION)),
+                                               InvalidInstruction };
+
+        // We can't rely on dwInstructionLength being correct, so
+        // only stop at D3DOP_EXIT or at the end of the buffer
+        if (unlikely(instruction.offset > bufferSize)) {
+          Logger::warn("D3D3ExecuteBuffer::CompileProgram: Instruction stream overruns the buffer");
+          m_program.push_back(instruction);
+          break;
+        }
+
+        const D3DINSTRUCTION* header = reinterpret_cast<const D3DINSTRUCTION*>(m_buffer.data() + offset);
+        const size_t dataSize = header->bSize * header->wCount;
+
+        if (header->bOpcode == D3DOP_EXIT) {
+          m_program.push_back(instruction);
+          break;
+        }
+
+        if (unlikely(instruction.offset + dataSize > bufferSize)) {
+          Logger::warn("D3D3ExecuteBuffer::CompileProgram: Instruction data overruns the buffer");
+          m_program.push_back(instruction);
+          break;
+        }
+
+        instruction.opcode = header->bOpcode;
+        instruction.size   = header->bSize;
+        instruction.count  = header->wCount;
+
+        switch (instruction.opcode) {
+          case D3DOP_BRANCHFORWARD: {
+            const D3DBRANCH* branch = reinterpret_cast<const D3DBRANCH*>(m_buffer.data() + instruction.offset);
+            for (uint16_t i = 0; i < instruction.count; i++) {
+              if (branch[i].dwOffset != 0)
+                pending.push_back(offset + branch[i].dwOffset);
+            }
+            break;
+          }
+          case D3DOP_POINT:
+          case D3DOP_LINE:
+          case D3DOP_TRIANGLE:
+          case D3DOP_MATRIXLOAD:
+          case D3DOP_MATRIXMULTIPLY:
+          case D3DOP_STATETRANSFORM:
+          case D3DOP_STATELIGHT:
+          case D3DOP_STATERENDER:
+          case D3DOP_PROCESSVERTICES:
+          case D3DOP_TEXTURELOAD:
+          case D3DOP_SPAN:
+          case D3DOP_SETSTATUS:
+            break;
+          default:
+            Logger::err(str::format("D3D3ExecuteBuffer::CompileProgram: Unknown opcode encountered: ", static_cast<uint32_t>(instruction.opcode)));
+            break;
+        }
+
+        m_program.push_back(instruction);
+
+        prevIndex = index;
+        offset    = static_cast<uint32_t>(instruction.offset + dataSize);
+      }
+    }
+
+    m_programValid = true;
+  }
+
 }
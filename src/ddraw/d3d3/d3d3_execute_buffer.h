@@ -6,9 +6,24 @@
 #include "d3d3_device.h"
 
 #include <vector>
+#include <unordered_map>
 
 namespace dxvk {
 
+  /**
+  * \brief Decoded execute buffer instruction
+  *
+  * References the operand data of the instruction, which gets read in
+  * place from the execute buffer, as well as the instruction that follows.
+  */
+  struct D3D3ExecuteInstruction {
+    BYTE     opcode;
+    BYTE     size;
+    WORD     count;
+    uint32_t offset; // Operand data offset within the execute buffer
+    uint32_t next;   // Index of the next instruction in the program
+  };
+
   class D3D3ExecuteBuffer final : public DDrawChildObject<D3D3Device, IDirect3DExecuteBuffer> {
 
   public:
@@ -45,19 +60,53 @@ namespace dxvk {
       return &m_executeData;
     }
 
-    std::vector<uint8_t> GetBuffer() const {
-      return m_buffer;
+    uint8_t* GetBufferData() {
+      return m_buffer.data();
+    }
+
+    size_t GetBufferSize() const {
+      return m_buffer.size();
+    }
+
+    D3DTLVERTEX* GetProcessedVertices() {
+      return m_hVertices.data();
+    }
+
+    const std::vector<D3D3ExecuteInstruction>& GetProgram() {
+      if (unlikely(!m_programValid))
+        CompileProgram();
+
+      return m_program;
+    }
+
+    uint32_t GetInstructionIndex(uint32_t instructionOffset) const {
+      auto programOffset = m_programOffsets.find(instructionOffset);
+
+      return programOffset != m_programOffsets.end() ? programOffset->second : InvalidInstruction;
     }
 
+    static constexpr uint32_t InvalidInstruction = ~0u;
+
   private:
 
-    bool                 m_locked     = false;
-    bool                 m_executed   = false;
+    void CompileProgram();
+
+    bool                 m_locked       = false;
+    bool                 m_executed     = false;
+    bool                 m_programValid = false;
 
     D3DEXECUTEDATA       m_executeData;
 
     std::vector<uint8_t> m_buffer;
 
+    // Processed (TL) vertices, which are kept apart from the application's data
+    std::vector<D3DTLVERTEX> m_hVertices;
+
+    // The instruction stream only gets parsed once, for as long
+    // as it can't have been modified by the application
+    std::vector<D3D3ExecuteInstruction>    m_program;
+    std::unordered_map<uint32_t, uint32_t> m_programOffsets;
+
   };
 
 }
@@ -70,6 +70,7 @@ namespace dxvk {
       const D3DMATERIALHANDLE currentHandle = commonDevice->GetCurrentMaterialHandle();
       if (handle && currentHandle == handle) {
         //Logger::debug(str::format("D3D3Material::SetMaterial: Applying material nr. ", handle, " to D3D9"));
+        commonDevice->FlushBatchedDraws();
         commonDevice->GetD3D9Device()->SetMaterial(material9);
       }
     }
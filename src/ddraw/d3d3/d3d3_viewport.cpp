@@ -203,16 +203,16 @@ namespace dxvk {
       if (currentViewport != nullptr) {
         currentViewport9 = *currentViewport->GetCommonViewport()->GetD3D9Viewport();
       } else {
-        d3d9Device->GetViewport(&currentViewport9);
+        m_commonViewport->GetCommonD3DDevice()->GetViewport(&currentViewport9);
       }
-      d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     }
 
     HRESULT hr = m_commonViewport->TransformVertices(vertex_count, data, flags, offscreen);
 
     // Restore the previously active viewport
     if (!m_commonViewport->IsCurrentViewport()) {
-      d3d9Device->SetViewport(&currentViewport9);
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(&currentViewport9);
     }
 
     return hr;
@@ -317,6 +317,8 @@ namespace dxvk {
       }
     }
 
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     // Temporarily activate this viewport in order to clear it
@@ -327,9 +329,9 @@ namespace dxvk {
       if (currentViewport != nullptr) {
         currentViewport9 = *currentViewport->GetCommonViewport()->GetD3D9Viewport();
       } else {
-        d3d9Device->GetViewport(&currentViewport9);
+        m_commonViewport->GetCommonD3DDevice()->GetViewport(&currentViewport9);
       }
-      d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     }
 
     static constexpr D3DCOLOR defaultColor = D3DCOLOR_ARGB(0, 0, 0, 0);
@@ -343,7 +345,7 @@ namespace dxvk {
 
     // Restore the previously active viewport
     if (!isCurrentViewport) {
-      d3d9Device->SetViewport(&currentViewport9);
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(&currentViewport9);
     }
 
     // Can fail in D3D9 only in case of a missing depth stencil surface
@@ -377,6 +379,8 @@ namespace dxvk {
     lights.push_back(d3dLight);
     d3dLight->SetViewport3(this);
 
+    D3DCommonDevice::InvalidateLights();
+
     if (m_commonViewport->HasDevice() && m_commonViewport->IsCurrentViewport())
       ApplyAndActivateLight(d3dLight->GetIndex(), d3dLight);
 
@@ -399,11 +403,14 @@ namespace dxvk {
       if (m_commonViewport->HasDevice() && m_commonViewport->IsCurrentViewport() && d3dLight->IsActive()) {
         const DWORD light9Index = d3dLight->GetIndex();
         //Logger::debug(str::format("D3D3Viewport: Disabling light nr. ", light9Index));
+        m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
         d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
         d3d9Device->LightEnable(light9Index, FALSE);
       }
       lights.erase(it);
       d3dLight->SetViewport3(nullptr);
+
+      D3DCommonDevice::InvalidateLights();
     } else {
       Logger::warn("D3D3Viewport::DeleteLight: Light not found");
       return DDERR_INVALIDPARAMS;
@@ -443,7 +450,7 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
-    HRESULT hr = d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+    HRESULT hr = m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     if (unlikely(FAILED(hr))) {
       Logger::err("D3D3Viewport: Failed to set the D3D9 viewport");
       return hr;
@@ -470,6 +477,8 @@ namespace dxvk {
     if (!lights.size())
       return D3D_OK;
 
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     for (auto light: lights) {
@@ -484,6 +493,8 @@ namespace dxvk {
   }
 
   HRESULT D3D3Viewport::ApplyAndActivateLight(DWORD light9Index, D3DLight* light) {
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     HRESULT hr = d3d9Device->SetLight(light9Index, light->GetD3D9Light());
@@ -372,6 +372,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::BeginScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(m_commonD3DDevice->IsInScene()))
@@ -389,6 +391,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::EndScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(!m_commonD3DDevice->IsInScene()))
@@ -422,6 +426,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::SetCurrentViewport(IDirect3DViewport2 *viewport) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(viewport == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -469,6 +475,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::SetRenderTarget(IDirectDrawSurface *surface, DWORD flags) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(surface == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -497,6 +505,9 @@ namespace dxvk {
       return hr;
     }
 
+    // D3D9 resets the viewport to cover the new RT
+    m_commonD3DDevice->InvalidateViewport();
+
     m_rt = rt5;
     m_ds = m_rt->GetAttachedDepthStencil();
 
@@ -537,16 +548,37 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::Begin(D3DPRIMITIVETYPE d3dptPrimitiveType, D3DVERTEXTYPE dwVertexTypeDesc, DWORD dwFlags) {
     D3DDeviceLock lock = LockDevice();
 
-    m_vertexStreamInfo.d3dpt = d3dptPrimitiveType;
-    m_vertexStreamInfo.d3dvt = dwVertexTypeDesc;
-    m_vertexStreamInfo.dwFlags = dwFlags;
+    if (unlikely(dwVertexTypeDesc != D3DVT_VERTEX &&
+                 dwVertexTypeDesc != D3DVT_LVERTEX &&
+                 dwVertexTypeDesc != D3DVT_TLVERTEX)) {
+      Logger::warn("D3D5Device::Begin: Invalid vertex type");
+      return DDERR_INVALIDPARAMS;
+    }
+
+    if (unlikely(m_immediate.IsActive()))
+      return D3DERR_INBEGIN;
 
-    return D3D_OK;
+    HRESULT hr = m_immediate.Begin(m_commonD3DDevice.ptr(), d3dptPrimitiveType, ConvertVertexType(dwVertexTypeDesc), dwFlags);
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D5Device::Begin: Failed to begin vertex stream");
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::BeginIndexed(D3DPRIMITIVETYPE primitive_type, D3DVERTEXTYPE fvf, void *vertices, DWORD vertex_count, DWORD flags) {
-    Logger::warn("!!! D3D5Device::BeginIndexed: Stub");
-    return D3D_OK;
+    D3DDeviceLock lock = LockDevice();
+
+    if (unlikely(vertices == nullptr || !vertex_count))
+      return DDERR_INVALIDPARAMS;
+
+    if (unlikely(m_immediate.IsActive()))
+      return D3DERR_INBEGIN;
+
+    HRESULT hr = m_immediate.BeginIndexed(m_commonD3DDevice.ptr(), primitive_type, ConvertVertexType(fvf), vertices, vertex_count, flags);
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D5Device::BeginIndexed: Failed to begin index stream");
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::Vertex(void *vertex) {
@@ -555,59 +587,58 @@ namespace dxvk {
     if (unlikely(vertex == nullptr))
       return DDERR_INVALIDPARAMS;
 
-    switch (m_vertexStreamInfo.d3dvt) {
-      case D3DVT_VERTEX:
-        m_vertexStream.push_back(*reinterpret_cast<D3DVERTEX*>(vertex));
-        break;
-      case D3DVT_LVERTEX:
-        m_lvertexStream.push_back(*reinterpret_cast<D3DLVERTEX*>(vertex));
-        break;
-      case D3DVT_TLVERTEX:
-        m_tlvertexStream.push_back(*reinterpret_cast<D3DTLVERTEX*>(vertex));
-        break;
-      default:
-        Logger::warn(">>> D3D5Device::Vertex: Invalid vertex type");
-        return DDERR_INVALIDPARAMS;
+    if (unlikely(!m_immediate.IsActive() || m_immediate.IsIndexed()))
+      return D3DERR_NOTINBEGIN;
+
+    // Draw what we have so far and continue in a new chunk
+    if (unlikely(m_immediate.IsFull())) {
+      HRESULT hr = FlushImmediate();
+      if (unlikely(FAILED(hr))) {
+        m_immediate.Reset();
+        return hr;
+      }
+
+      m_immediate.Continue();
     }
 
+    m_immediate.Add(vertex);
+
     return D3D_OK;
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::Index(WORD wVertexIndex) {
-    Logger::warn("!!! D3D5Device::Index: Stub");
+    D3DDeviceLock lock = LockDevice();
+
+    if (unlikely(!m_immediate.IsActive() || !m_immediate.IsIndexed()))
+      return D3DERR_NOTINBEGIN;
+
+    if (unlikely(m_immediate.IsFull())) {
+      HRESULT hr = FlushImmediate();
+      if (unlikely(FAILED(hr))) {
+        m_immediate.Reset();
+        return hr;
+      }
+
+      m_immediate.Continue();
+    }
+
+    m_immediate.Add(&wVertexIndex);
+
     return D3D_OK;
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::End(DWORD dwFlags) {
     D3DDeviceLock lock = LockDevice();
 
-    HRESULT hr;
+    if (unlikely(!m_immediate.IsActive()))
+      return D3DERR_NOTINBEGIN;
 
-    switch (m_vertexStreamInfo.d3dvt) {
-      case D3DVT_VERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_vertexStream.data(),
-                           m_vertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_vertexStream.clear();
-        break;
-      case D3DVT_LVERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_lvertexStream.data(),
-                           m_lvertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_lvertexStream.clear();
-        break;
-      case D3DVT_TLVERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_tlvertexStream.data(),
-                           m_tlvertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_tlvertexStream.clear();
-        break;
-      default:
-        Logger::warn(">>> D3D5Device::End: Invalid vertex type");
-        return DDERR_INVALIDPARAMS;
-    }
+    HRESULT hr = FlushImmediate();
 
-    if (unlikely(FAILED(hr)))
-      Logger::err(">>> D3D5Device::End: Failed call to DrawPrimitive");
+    m_immediate.Reset();
 
-    m_vertexStreamInfo = { };
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D5Device::End: Failed to draw vertex stream");
 
     return hr;
   }
@@ -892,6 +923,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::SetRenderState(D3DRENDERSTATETYPE dwRenderStateType, DWORD dwRenderState) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
     d3d9::D3DRENDERSTATETYPE State9 = d3d9::D3DRENDERSTATETYPE(dwRenderStateType);
 
@@ -1358,6 +1391,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D5Device::SetLightState(D3DLIGHTSTATETYPE dwLightStateType, DWORD dwLightState) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     switch (dwLightStateType) {
@@ -1406,15 +1441,21 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::SetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->SetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::GetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->GetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->GetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::MultiplyTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->MultiplyTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->MultiplyTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D5Device::DrawPrimitive(D3DPRIMITIVETYPE primitive_type, D3DVERTEXTYPE vertex_type, void *vertices, DWORD vertex_count, DWORD flags) {
@@ -1433,27 +1474,34 @@ namespace dxvk {
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     const DWORD vertex_type5 = ConvertVertexType(vertex_type);
+
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(vertex_type5, vertices, vertex_count, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D5Device::DrawPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (vertex_type5 & D3DFVF_NORMAL) &&
                               m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(vertex_type5);
-    HRESULT hr = device9->DrawPrimitiveUP(
+    hr = device9->DrawPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
-                      GetPrimitiveCount(primitive_type, vertex_count),
-                      vertices,
-                      GetFVFSize(vertex_type5));
+                      baseVertex,
+                      GetPrimitiveCount(primitive_type, vertex_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D5Device::DrawPrimitive: Failed D3D9 call to DrawPrimitiveUP");
+      Logger::err("D3D5Device::DrawPrimitive: Failed D3D9 call to DrawPrimitive");
       return hr;
     }
 
@@ -1478,31 +1526,45 @@ namespace dxvk {
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     const DWORD fvf5 = ConvertVertexType(fvf);
+
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(fvf5, vertices, vertex_count, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D5Device::DrawIndexedPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
+    UINT startIndex = 0;
+
+    hr = m_commonD3DDevice->SetStreamingIndices(indices, index_count, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D5Device::DrawIndexedPrimitive: Failed to upload indices");
+      return hr;
+    }
+
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (fvf5 & D3DFVF_NORMAL) &&
                               m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(fvf5);
-    HRESULT hr = device9->DrawIndexedPrimitiveUP(
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
+                      baseVertex,
                       0,
                       vertex_count,
-                      GetPrimitiveCount(primitive_type, index_count),
-                      indices,
-                      d3d9::D3DFMT_INDEX16,
-                      vertices,
-                      GetFVFSize(fvf5));
+                      startIndex,
+                      GetPrimitiveCount(primitive_type, index_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D5Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitiveUP");
+      Logger::err("D3D5Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitive");
       return hr;
     }
 
@@ -1523,7 +1585,7 @@ namespace dxvk {
       return DDERR_INVALIDPARAMS;
 
     d3d9::D3DVIEWPORT9 viewport9;
-    if (SUCCEEDED(m_commonD3DDevice->GetD3D9Device()->GetViewport(&viewport9))) {
+    if (SUCCEEDED(m_commonD3DDevice->GetViewport(&viewport9))) {
       clip_status->dwFlags = D3DCLIPSTATUS_EXTENTS2;
       clip_status->dwStatus = 0;
       clip_status->minx = viewport9.X;
@@ -1598,6 +1660,61 @@ namespace dxvk {
     }
   }
 
+  HRESULT D3D5Device::FlushImmediate() {
+    RefreshLastUsedDevice();
+
+    // Upload dirty surfaces first, since that may flush other streamed draws
+    DDrawDirtySurfaceUpload();
+
+    D3DImmediateDraw draw;
+
+    HRESULT hr = m_immediate.Finish(&draw);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    const UINT primitiveCount = GetPrimitiveCount(draw.type, draw.indexed ? draw.indexCount : draw.vertexCount);
+    if (unlikely(!primitiveCount))
+      return D3D_OK;
+
+    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
+
+    const bool useLighting = !(draw.flags & D3DDP_DONOTLIGHT) &&
+                              (draw.fvf & D3DFVF_NORMAL) &&
+                              m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
+
+    if (!useLighting)
+      device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
+    HandlePreDrawLegacyProjection(draw.flags);
+
+    if (draw.indexed) {
+      hr = device9->DrawIndexedPrimitive(
+                        d3d9::D3DPRIMITIVETYPE(draw.type),
+                        draw.baseVertex,
+                        0,
+                        draw.vertexCount,
+                        draw.startIndex,
+                        primitiveCount);
+    } else {
+      hr = device9->DrawPrimitive(
+                        d3d9::D3DPRIMITIVETYPE(draw.type),
+                        draw.baseVertex,
+                        primitiveCount);
+    }
+
+    if (!useLighting)
+      device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
+    HandlePostDrawLegacyProjection();
+
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D5Device::FlushImmediate: Failed D3D9 draw call");
+      return hr;
+    }
+
+    UpdateSurfaceDirtyTracking(true, true, true);
+
+    return D3D_OK;
+  }
+
   inline HRESULT D3D5Device::SetTextureInternal(DDrawSurface* surface, DWORD textureHandle) {
     HRESULT hr;
 
@@ -6,6 +6,7 @@
 #include "../ddraw_caps.h"
 
 #include "../d3d_common_device.h"
+#include "../d3d_immediate.h"
 
 #include "../d3d_multithread.h"
 
@@ -135,6 +136,8 @@ namespace dxvk {
 
     inline void DDrawDirtySurfaceUpload();
 
+    HRESULT FlushImmediate();
+
     inline HRESULT SetTextureInternal(DDrawSurface* surface, DWORD textureHandle);
 
     inline void RefreshLastUsedDevice() {
@@ -142,20 +145,20 @@ namespace dxvk {
         m_commonIntf->SetCommonD3DDevice(m_commonD3DDevice.ptr());
     }
 
-    inline void HandlePreDrawLegacyProjection(d3d9::IDirect3DDevice9* device9, DWORD drawFlags) {
+    inline void HandlePreDrawLegacyProjection(DWORD drawFlags) {
       if (likely(m_currentViewport != nullptr)) {
         m_legacyProjection = m_currentViewport->GetCommonViewport()->GetLegacyProjectionMatrix(drawFlags);
 
         if (m_legacyProjection != nullptr) {
-          device9->GetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
-          device9->MultiplyTransform(d3d9::D3DTS_PROJECTION, m_legacyProjection);
+          m_commonD3DDevice->GetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
+          m_commonD3DDevice->MultiplyTransform(d3d9::D3DTS_PROJECTION, m_legacyProjection);
         }
       }
     }
 
-    inline void HandlePostDrawLegacyProjection(d3d9::IDirect3DDevice9* device9) {
+    inline void HandlePostDrawLegacyProjection() {
       if (m_legacyProjection != nullptr) {
-        device9->SetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
+        m_commonD3DDevice->SetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
       }
     }
 
@@ -180,10 +183,7 @@ namespace dxvk {
     D3DMATRIX                       m_projectionMatrix = { };
     const D3DMATRIX*                m_legacyProjection = nullptr;
 
-    VertexStreamInfo                m_vertexStreamInfo;
-    std::vector<D3DVERTEX>          m_vertexStream;
-    std::vector<D3DLVERTEX>         m_lvertexStream;
-    std::vector<D3DTLVERTEX>        m_tlvertexStream;
+    D3DImmediateStream              m_immediate;
 
   };
 
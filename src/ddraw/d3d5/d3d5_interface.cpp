@@ -521,9 +521,8 @@ namespace dxvk {
     params.PresentationInterval       = D3DPRESENT_INTERVAL_DEFAULT; // A D3D5 device always uses VSync
 
     Com<d3d9::IDirect3DDevice9> device9;
-    HRESULT hr = m_commonD3DIntf->GetD3D9Interface()->CreateDevice(
-      D3DADAPTER_DEFAULT,
-      d3d9::D3DDEVTYPE_HAL,
+    HRESULT hr = m_commonD3DIntf->CreateD3D9Device(
+      m_commonIntf,
       hWnd,
       deviceCreationFlags9,
       &params,
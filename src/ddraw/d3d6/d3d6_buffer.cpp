@@ -141,7 +141,8 @@ namespace dxvk {
 
     D3DDeviceLock lock = device6->LockDevice();
 
-    d3d9::IDirect3DDevice9* device9 = device6->GetCommonD3DDevice()->GetD3D9Device();
+    D3DCommonDevice* commonDevice = device6->GetCommonD3DDevice();
+    d3d9::IDirect3DDevice9* device9 = commonDevice->GetD3D9Device();
 
     const D3DOptions* d3dOptions = m_commonIntf->GetOptions();
 
@@ -170,7 +171,7 @@ namespace dxvk {
       // "If the rendering device does not have a material assigned to it, the Direct3D lighting engine is disabled."
       const bool doLighting = (dwVertexOp & D3DVOP_LIGHT) &&
                               (srcBuffer6->GetFVF() & D3DFVF_NORMAL) &&
-                              device6->GetCommonD3DDevice()->GetCurrentMaterialHandle() != 0;
+                              commonDevice->GetCurrentMaterialHandle() != 0;
 
       D3DCommonViewport* commonViewport = device6->GetCurrentViewportInternal()->GetCommonViewport();
 
@@ -189,16 +190,10 @@ namespace dxvk {
       pvData.doNotCopyData = dwFlags & D3DPV_DONOTCOPYDATA;
       pvData.doExtents = true;
       pvData.isLegacy = true;
+      pvData.viewport = commonViewport;
+      pvData.workerPool = commonDevice->GetWorkerPool();
 
-      std::vector<d3d9::D3DLIGHT9> lights9;
-      if (doLighting) {
-        commonViewport->GetD3D9Lights(&lights9);
-        pvData.lights = &lights9;
-      } else {
-        pvData.lights = nullptr;
-      }
-
-      ProcessVerticesSW(device9, m_commonIntf->GetOptions(), &pvData);
+      ProcessVerticesSW(commonDevice, m_commonIntf->GetOptions(), &pvData);
 
       m_vb9->Unlock();
       srcBuffer9->Unlock();
@@ -217,18 +212,18 @@ namespace dxvk {
 
         if (legacyProjection != nullptr) {
           //Logger::debug("D3D6Device: Applying legacy projection");
-          device9->GetTransform(d3d9::D3DTS_PROJECTION, &projectionMatrix);
-          device9->MultiplyTransform(d3d9::D3DTS_PROJECTION, legacyProjection);
+          commonDevice->GetTransform(d3d9::D3DTS_PROJECTION, &projectionMatrix);
+          commonDevice->MultiplyTransform(d3d9::D3DTS_PROJECTION, legacyProjection);
         }
       }
 
-      device9->SetFVF(srcBuffer6->GetFVF());
-      device9->SetStreamSource(0, srcBuffer6->GetD3D9VertexBuffer(), 0, srcBuffer6->GetStride());
+      commonDevice->SetFVF(srcBuffer6->GetFVF());
+      commonDevice->SetStreamSource(0, srcBuffer6->GetD3D9VertexBuffer(), 0, srcBuffer6->GetStride());
       HRESULT hr = device9->ProcessVertices(dwSrcIndex, dwDestIndex, dwCount, m_vb9.ptr(), nullptr, dwFlags);
 
       if (legacyProjection != nullptr) {
         //Logger::debug("D3D6Device: Reverting legacy projection");
-        device9->SetTransform(d3d9::D3DTS_PROJECTION, &projectionMatrix);
+        commonDevice->SetTransform(d3d9::D3DTS_PROJECTION, &projectionMatrix);
       }
 
       if (unlikely(FAILED(hr))) {
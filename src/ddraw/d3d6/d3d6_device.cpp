@@ -58,18 +58,6 @@ namespace dxvk {
       m_ds = m_rt->GetAttachedDepthStencil();
     }
 
-    // Common D3D9 index buffers
-    static constexpr DWORD Usage = D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY;
-
-    for (uint8_t ibIndex = 0; ibIndex < ddrawCaps::IndexBufferCount ; ibIndex++) {
-      const UINT ibSize = ddrawCaps::IndexCount[ibIndex] * sizeof(WORD);
-
-      HRESULT hr = device9->CreateIndexBuffer(ibSize, Usage, d3d9::D3DFMT_INDEX16,
-                                              d3d9::D3DPOOL_DEFAULT, &m_ib9[ibIndex], nullptr);
-      if (unlikely(FAILED(hr)))
-        throw DxvkError("D3D6Device: ERROR! Failed to initialize D3D9 index buffers.");
-    }
-
     // Get the bridge interface to D3D9
     if (unlikely(FAILED(device9->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&m_bridge))))) {
       throw DxvkError("D3D6Device: ERROR! Failed to get D3D9 Bridge. d3d9.dll might not be DXVK!");
@@ -395,6 +383,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::BeginScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(m_commonD3DDevice->IsInScene()))
@@ -412,6 +402,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::EndScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(!m_commonD3DDevice->IsInScene()))
@@ -445,6 +437,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::SetCurrentViewport(IDirect3DViewport3 *viewport) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(viewport == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -492,6 +486,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::SetRenderTarget(IDirectDrawSurface4 *surface, DWORD flags) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(surface == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -520,6 +516,9 @@ namespace dxvk {
       return hr;
     }
 
+    // D3D9 resets the viewport to cover the new RT
+    m_commonD3DDevice->InvalidateViewport();
+
     m_rt = rt6;
     m_ds = m_rt->GetAttachedDepthStencil();
 
@@ -569,16 +568,30 @@ namespace dxvk {
       return DDERR_INVALIDPARAMS;
     }
 
-    m_vertexStreamInfo.d3dpt = d3dptPrimitiveType;
-    m_vertexStreamInfo.d3dvt = ConvertFVFType(dwVertexTypeDesc);
-    m_vertexStreamInfo.dwFlags = dwFlags;
+    if (unlikely(m_immediate.IsActive()))
+      return D3DERR_INBEGIN;
 
-    return D3D_OK;
+    HRESULT hr = m_immediate.Begin(m_commonD3DDevice.ptr(), d3dptPrimitiveType, dwVertexTypeDesc, dwFlags);
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D6Device::Begin: Failed to begin vertex stream");
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::BeginIndexed(D3DPRIMITIVETYPE primitive_type, DWORD fvf, void *vertices, DWORD vertex_count, DWORD flags) {
-    Logger::warn("!!! D3D6Device::BeginIndexed: Stub");
-    return D3D_OK;
+    D3DDeviceLock lock = LockDevice();
+
+    if (unlikely(vertices == nullptr || !vertex_count))
+      return DDERR_INVALIDPARAMS;
+
+    if (unlikely(m_immediate.IsActive()))
+      return D3DERR_INBEGIN;
+
+    HRESULT hr = m_immediate.BeginIndexed(m_commonD3DDevice.ptr(), primitive_type, fvf, vertices, vertex_count, flags);
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D6Device::BeginIndexed: Failed to begin index stream");
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::Vertex(void *vertex) {
@@ -587,59 +600,58 @@ namespace dxvk {
     if (unlikely(vertex == nullptr))
       return DDERR_INVALIDPARAMS;
 
-    switch (m_vertexStreamInfo.d3dvt) {
-      case D3DVT_VERTEX:
-        m_vertexStream.push_back(*reinterpret_cast<D3DVERTEX*>(vertex));
-        break;
-      case D3DVT_LVERTEX:
-        m_lvertexStream.push_back(*reinterpret_cast<D3DLVERTEX*>(vertex));
-        break;
-      case D3DVT_TLVERTEX:
-        m_tlvertexStream.push_back(*reinterpret_cast<D3DTLVERTEX*>(vertex));
-        break;
-      default:
-        Logger::warn(">>> D3D6Device::Vertex: Invalid vertex type");
-        return DDERR_INVALIDPARAMS;
+    if (unlikely(!m_immediate.IsActive() || m_immediate.IsIndexed()))
+      return D3DERR_NOTINBEGIN;
+
+    // Draw what we have so far and continue in a new chunk
+    if (unlikely(m_immediate.IsFull())) {
+      HRESULT hr = FlushImmediate();
+      if (unlikely(FAILED(hr))) {
+        m_immediate.Reset();
+        return hr;
+      }
+
+      m_immediate.Continue();
     }
 
+    m_immediate.Add(vertex);
+
     return D3D_OK;
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::Index(WORD wVertexIndex) {
-    Logger::warn("!!! D3D6Device::Index: Stub");
+    D3DDeviceLock lock = LockDevice();
+
+    if (unlikely(!m_immediate.IsActive() || !m_immediate.IsIndexed()))
+      return D3DERR_NOTINBEGIN;
+
+    if (unlikely(m_immediate.IsFull())) {
+      HRESULT hr = FlushImmediate();
+      if (unlikely(FAILED(hr))) {
+        m_immediate.Reset();
+        return hr;
+      }
+
+      m_immediate.Continue();
+    }
+
+    m_immediate.Add(&wVertexIndex);
+
     return D3D_OK;
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::End(DWORD dwFlags) {
     D3DDeviceLock lock = LockDevice();
 
-    HRESULT hr;
+    if (unlikely(!m_immediate.IsActive()))
+      return D3DERR_NOTINBEGIN;
 
-    switch (m_vertexStreamInfo.d3dvt) {
-      case D3DVT_VERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_vertexStream.data(),
-                           m_vertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_vertexStream.clear();
-        break;
-      case D3DVT_LVERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_lvertexStream.data(),
-                           m_lvertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_lvertexStream.clear();
-        break;
-      case D3DVT_TLVERTEX:
-        hr = DrawPrimitive(m_vertexStreamInfo.d3dpt, m_vertexStreamInfo.d3dvt, m_tlvertexStream.data(),
-                           m_tlvertexStream.size(), m_vertexStreamInfo.dwFlags);
-        m_tlvertexStream.clear();
-        break;
-      default:
-        Logger::warn(">>> D3D6Device::End: Invalid vertex type");
-        return DDERR_INVALIDPARAMS;
-    }
+    HRESULT hr = FlushImmediate();
 
-    if (unlikely(FAILED(hr)))
-      Logger::err(">>> D3D6Device::End: Failed call to DrawPrimitive");
+    m_immediate.Reset();
 
-    m_vertexStreamInfo = { };
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3D6Device::End: Failed to draw vertex stream");
 
     return hr;
   }
@@ -939,6 +951,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::SetRenderState(D3DRENDERSTATETYPE dwRenderStateType, DWORD dwRenderState) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
     d3d9::D3DRENDERSTATETYPE State9 = d3d9::D3DRENDERSTATETYPE(dwRenderStateType);
 
@@ -1425,6 +1439,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::SetLightState(D3DLIGHTSTATETYPE dwLightStateType, DWORD dwLightState) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     switch (dwLightStateType) {
@@ -1476,15 +1492,21 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::SetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->SetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::GetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->GetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->GetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::MultiplyTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->MultiplyTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->MultiplyTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::DrawPrimitive(D3DPRIMITIVETYPE primitive_type, DWORD vertex_type, void *vertices, DWORD vertex_count, DWORD flags) {
@@ -1500,29 +1522,44 @@ namespace dxvk {
 
     DDrawDirtySurfaceUpload();
 
-    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
-
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (vertex_type & D3DFVF_NORMAL) &&
                               m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
 
+    if (m_commonD3DDevice->ShouldBatch()) {
+      const D3DBatchState state = GetBatchState(primitive_type, vertex_type, flags, useLighting);
+
+      if (m_commonD3DDevice->BatchDraw(state, primitive_type, vertices, vertex_count, nullptr, 0)) {
+        UpdateSurfaceDirtyTracking(true, true, true);
+        return D3D_OK;
+      }
+    }
+
+    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
+
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(vertex_type, vertices, vertex_count, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(vertex_type);
-    HRESULT hr = device9->DrawPrimitiveUP(
+    hr = device9->DrawPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
-                      GetPrimitiveCount(primitive_type, vertex_count),
-                      vertices,
-                      GetFVFSize(vertex_type));
+                      baseVertex,
+                      GetPrimitiveCount(primitive_type, vertex_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D6Device::DrawPrimitive: Failed D3D9 call to DrawPrimitiveUP");
+      Logger::err("D3D6Device::DrawPrimitive: Failed D3D9 call to DrawPrimitive");
       return hr;
     }
 
@@ -1544,33 +1581,55 @@ namespace dxvk {
 
     DDrawDirtySurfaceUpload();
 
-    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
-
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (fvf & D3DFVF_NORMAL) &&
                               m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
 
+    if (m_commonD3DDevice->ShouldBatch()) {
+      const D3DBatchState state = GetBatchState(primitive_type, fvf, flags, useLighting);
+
+      if (m_commonD3DDevice->BatchDraw(state, primitive_type, vertices, vertex_count, indices, index_count)) {
+        UpdateSurfaceDirtyTracking(true, true, true);
+        return D3D_OK;
+      }
+    }
+
+    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
+
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(fvf, vertices, vertex_count, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawIndexedPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
+    UINT startIndex = 0;
+
+    hr = m_commonD3DDevice->SetStreamingIndices(indices, index_count, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawIndexedPrimitive: Failed to upload indices");
+      return hr;
+    }
+
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(fvf);
-    HRESULT hr = device9->DrawIndexedPrimitiveUP(
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
+                      baseVertex,
                       0,
                       vertex_count,
-                      GetPrimitiveCount(primitive_type, index_count),
-                      indices,
-                      d3d9::D3DFMT_INDEX16,
-                      vertices,
-                      GetFVFSize(fvf));
+                      startIndex,
+                      GetPrimitiveCount(primitive_type, index_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D6Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitiveUP");
+      Logger::err("D3D6Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitive");
       return hr;
     }
 
@@ -1591,7 +1650,7 @@ namespace dxvk {
       return DDERR_INVALIDPARAMS;
 
     d3d9::D3DVIEWPORT9 viewport9;
-    if (SUCCEEDED(m_commonD3DDevice->GetD3D9Device()->GetViewport(&viewport9))) {
+    if (SUCCEEDED(m_commonD3DDevice->GetViewport(&viewport9))) {
       clip_status->dwFlags = D3DCLIPSTATUS_EXTENTS2;
       clip_status->dwStatus = 0;
       clip_status->minx = viewport9.X;
@@ -1620,8 +1679,12 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    // Transform strided vertex data to a standard vertex buffer stream
-    PackedVertexBuffer pvb = TransformStridedtoUP(fvf, strided_data, vertex_count);
+    // Bind each strided component as a separate D3D9 stream
+    HRESULT hr = m_commonD3DDevice->SetStridedVertexData(fvf, strided_data, vertex_count);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawPrimitiveStrided: Failed to upload strided vertex data");
+      return hr;
+    }
 
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (fvf & D3DFVF_NORMAL) &&
@@ -1629,21 +1692,19 @@ namespace dxvk {
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(fvf);
-    HRESULT hr = device9->DrawPrimitiveUP(
+    hr = device9->DrawPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
-                      GetPrimitiveCount(primitive_type, vertex_count),
-                      pvb.vertexData.data(),
-                      pvb.stride);
+                      0,
+                      GetPrimitiveCount(primitive_type, vertex_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D6Device::DrawPrimitiveStrided: Failed D3D9 call to DrawPrimitiveUP");
+      Logger::err("D3D6Device::DrawPrimitiveStrided: Failed D3D9 call to DrawPrimitive");
       return hr;
     }
 
@@ -1663,12 +1724,29 @@ namespace dxvk {
     if (unlikely(strided_data == nullptr || indices == nullptr))
       return DDERR_INVALIDPARAMS;
 
+    if (unlikely(index_count > ddrawCaps::MaxIndexCount)) {
+      Logger::err("D3D6Device::DrawIndexedPrimitiveStrided: Exceeded size of largest index buffer");
+      return DDERR_UNSUPPORTED;
+    }
+
     DDrawDirtySurfaceUpload();
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    // Transform strided vertex data to a standard vertex buffer stream
-    PackedVertexBuffer pvb = TransformStridedtoUP(fvf, strided_data, vertex_count);
+    // Bind each strided component as a separate D3D9 stream
+    HRESULT hr = m_commonD3DDevice->SetStridedVertexData(fvf, strided_data, vertex_count);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawIndexedPrimitiveStrided: Failed to upload strided vertex data");
+      return hr;
+    }
+
+    UINT startIndex = 0;
+
+    hr = m_commonD3DDevice->SetStreamingIndices(indices, index_count, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawIndexedPrimitiveStrided: Failed to upload indices");
+      return hr;
+    }
 
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (fvf & D3DFVF_NORMAL) &&
@@ -1676,25 +1754,22 @@ namespace dxvk {
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(fvf);
-    HRESULT hr = device9->DrawIndexedPrimitiveUP(
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
                       0,
+                      0,
                       vertex_count,
-                      GetPrimitiveCount(primitive_type, index_count),
-                      indices,
-                      d3d9::D3DFMT_INDEX16,
-                      pvb.vertexData.data(),
-                      pvb.stride);
+                      startIndex,
+                      GetPrimitiveCount(primitive_type, index_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D6Device::DrawIndexedPrimitiveStrided: Failed D3D9 call to DrawIndexedPrimitiveUP");
+      Logger::err("D3D6Device::DrawIndexedPrimitiveStrided: Failed D3D9 call to DrawIndexedPrimitive");
       return hr;
     }
 
@@ -1736,10 +1811,10 @@ namespace dxvk {
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetFVF(vb6->GetFVF());
-    device9->SetStreamSource(0, vb6->GetD3D9VertexBuffer(), 0, vb6->GetStride());
+    m_commonD3DDevice->SetFVF(vb6->GetFVF());
+    m_commonD3DDevice->SetStreamSource(0, vb6->GetD3D9VertexBuffer(), 0, vb6->GetStride());
     HRESULT hr = device9->DrawPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
                       start_vertex,
@@ -1747,7 +1822,7 @@ namespace dxvk {
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
       Logger::err("D3D6Device::DrawPrimitiveVB: Failed D3D9 call to DrawPrimitive");
@@ -1791,43 +1866,35 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
+    UINT startIndex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingIndices(indices, index_count, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::DrawIndexedPrimitiveVB: Failed to upload indices");
+      return hr;
+    }
+
     const bool useLighting = !(flags & D3DDP_DONOTLIGHT) &&
                               (vb6->GetFVF() & D3DFVF_NORMAL) &&
                               m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
-    HandlePreDrawLegacyProjection(device9, flags);
-
-    uint8_t ibIndex = 0;
-    // Fit index buffer uploads into the smallest buffer size possible
-    while (index_count > ddrawCaps::IndexCount[ibIndex])
-      ibIndex++;
-
-    d3d9::IDirect3DIndexBuffer9* ib9 = m_ib9[ibIndex].ptr();
-
-    const size_t ibSize = index_count * sizeof(WORD);
-    void* pData = nullptr;
-
-    // Locking and unlocking are generally expected to work here
-    ib9->Lock(0, ibSize, &pData, D3DLOCK_DISCARD);
-    memcpy(pData, static_cast<void*>(indices), ibSize);
-    ib9->Unlock();
+    HandlePreDrawLegacyProjection(flags);
 
-    device9->SetIndices(ib9);
-    device9->SetFVF(vb6->GetFVF());
-    device9->SetStreamSource(0, vb6->GetD3D9VertexBuffer(), 0, vb6->GetStride());
-    HRESULT hr = device9->DrawIndexedPrimitive(
+    m_commonD3DDevice->SetFVF(vb6->GetFVF());
+    m_commonD3DDevice->SetStreamSource(0, vb6->GetD3D9VertexBuffer(), 0, vb6->GetStride());
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(primitive_type),
                       0,
                       0,
                       vb6->GetNumVertices(),
-                      0,
+                      startIndex,
                       GetPrimitiveCount(primitive_type, index_count));
 
     if (!useLighting)
       device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
-    HandlePostDrawLegacyProjection(device9);
+    HandlePostDrawLegacyProjection();
 
     if (unlikely(FAILED(hr))) {
       Logger::err("D3D6Device::DrawIndexedPrimitiveVB: Failed D3D9 call to DrawIndexedPrimitive");
@@ -1874,6 +1941,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D6Device::SetTexture(DWORD stage, IDirect3DTexture2 *texture) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(stage >= ddrawCaps::TextureStageCount))
       return DDERR_INVALIDPARAMS;
 
@@ -1998,6 +2067,8 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D6Device::SetTextureStageState(DWORD dwStage, D3DTEXTURESTAGESTATETYPE d3dTexStageStateType, DWORD dwState) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     // In the case of D3DTSS_ADDRESS, which is exclusive to D3D7
@@ -2145,6 +2216,61 @@ namespace dxvk {
     }
   }
 
+  HRESULT D3D6Device::FlushImmediate() {
+    RefreshLastUsedDevice();
+
+    // Upload dirty surfaces first, since that may flush other streamed draws
+    DDrawDirtySurfaceUpload();
+
+    D3DImmediateDraw draw;
+
+    HRESULT hr = m_immediate.Finish(&draw);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    const UINT primitiveCount = GetPrimitiveCount(draw.type, draw.indexed ? draw.indexCount : draw.vertexCount);
+    if (unlikely(!primitiveCount))
+      return D3D_OK;
+
+    d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
+
+    const bool useLighting = !(draw.flags & D3DDP_DONOTLIGHT) &&
+                              (draw.fvf & D3DFVF_NORMAL) &&
+                              m_commonD3DDevice->GetCurrentMaterialHandle() != 0;
+
+    if (!useLighting)
+      device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
+    HandlePreDrawLegacyProjection(draw.flags);
+
+    if (draw.indexed) {
+      hr = device9->DrawIndexedPrimitive(
+                        d3d9::D3DPRIMITIVETYPE(draw.type),
+                        draw.baseVertex,
+                        0,
+                        draw.vertexCount,
+                        draw.startIndex,
+                        primitiveCount);
+    } else {
+      hr = device9->DrawPrimitive(
+                        d3d9::D3DPRIMITIVETYPE(draw.type),
+                        draw.baseVertex,
+                        primitiveCount);
+    }
+
+    if (!useLighting)
+      device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
+    HandlePostDrawLegacyProjection();
+
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D6Device::FlushImmediate: Failed D3D9 draw call");
+      return hr;
+    }
+
+    UpdateSurfaceDirtyTracking(true, true, true);
+
+    return D3D_OK;
+  }
+
   inline HRESULT D3D6Device::SetTextureInternal(DDraw4Surface* surface, DWORD textureHandle) {
     HRESULT hr;
 
@@ -7,6 +7,7 @@
 #include "../ddraw_caps.h"
 
 #include "../d3d_common_device.h"
+#include "../d3d_immediate.h"
 
 #include "../d3d_multithread.h"
 
@@ -160,6 +161,8 @@ namespace dxvk {
 
     inline void DDrawDirtySurfaceUpload();
 
+    HRESULT FlushImmediate();
+
     inline HRESULT SetTextureInternal(DDraw4Surface* surface, DWORD textureHandle);
 
     inline void RefreshLastUsedDevice() {
@@ -167,21 +170,39 @@ namespace dxvk {
         m_commonIntf->SetCommonD3DDevice(m_commonD3DDevice.ptr());
     }
 
-    inline void HandlePreDrawLegacyProjection(d3d9::IDirect3DDevice9* device9, DWORD drawFlags) {
+    inline void HandlePreDrawLegacyProjection(DWORD drawFlags) {
       if (likely(m_currentViewport != nullptr)) {
         m_legacyProjection = m_currentViewport->GetCommonViewport()->GetLegacyProjectionMatrix(drawFlags);
 
         if (m_legacyProjection != nullptr) {
-          device9->GetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
-          device9->MultiplyTransform(d3d9::D3DTS_PROJECTION, m_legacyProjection);
+          m_commonD3DDevice->GetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
+          m_commonD3DDevice->MultiplyTransform(d3d9::D3DTS_PROJECTION, m_legacyProjection);
         }
       }
     }
 
-    inline void HandlePostDrawLegacyProjection(d3d9::IDirect3DDevice9* device9) {
+    inline void HandlePostDrawLegacyProjection() {
       if (m_legacyProjection != nullptr) {
-        device9->SetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
+        m_commonD3DDevice->SetTransform(d3d9::D3DTS_PROJECTION, &m_projectionMatrix);
+      }
+    }
+
+    inline D3DBatchState GetBatchState(D3DPRIMITIVETYPE primitiveType, DWORD fvf, DWORD drawFlags, bool useLighting) {
+      D3DBatchState state;
+      state.fvf             = fvf;
+      state.listType        = D3DBatcher::GetListType(primitiveType);
+      state.disableLighting = !useLighting;
+
+      if (likely(m_currentViewport != nullptr)) {
+        const D3DMATRIX* legacyProjection = m_currentViewport->GetCommonViewport()->GetLegacyProjectionMatrix(drawFlags);
+
+        if (legacyProjection != nullptr) {
+          state.useLegacyProjection = true;
+          state.legacyProjection    = *legacyProjection;
+        }
       }
+
+      return state;
     }
 
     bool                            m_alphaOpSet         = false;
@@ -208,16 +229,11 @@ namespace dxvk {
     D3DMATRIX                       m_projectionMatrix   = { };
     const D3DMATRIX*                m_legacyProjection   = nullptr;
 
-    VertexStreamInfo                m_vertexStreamInfo;
-    std::vector<D3DVERTEX>          m_vertexStream;
-    std::vector<D3DLVERTEX>         m_lvertexStream;
-    std::vector<D3DTLVERTEX>        m_tlvertexStream;
+    D3DImmediateStream              m_immediate;
 
     // D3D5Texture (aka IDirect3DTexture2) is shared between D3D5 and D3D6
     std::array<Com<D3D5Texture, false>, ddrawCaps::TextureStageCount> m_textures;
 
-    std::array<Com<d3d9::IDirect3DIndexBuffer9>, ddrawCaps::IndexBufferCount> m_ib9;
-
   };
 
 }
\ No newline at end of file
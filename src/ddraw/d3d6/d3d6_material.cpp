@@ -64,6 +64,7 @@ namespace dxvk {
       const D3DMATERIALHANDLE currentHandle = commonDevice->GetCurrentMaterialHandle();
       if (handle && currentHandle == handle) {
         //Logger::debug(str::format("D3D6Material::SetMaterial: Applying material nr. ", handle, " to D3D9"));
+        commonDevice->FlushBatchedDraws();
         commonDevice->GetD3D9Device()->SetMaterial(material9);
       }
     }
@@ -201,16 +201,16 @@ namespace dxvk {
       if (currentViewport != nullptr) {
         currentViewport9 = *currentViewport->GetCommonViewport()->GetD3D9Viewport();
       } else {
-        d3d9Device->GetViewport(&currentViewport9);
+        m_commonViewport->GetCommonD3DDevice()->GetViewport(&currentViewport9);
       }
-      d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     }
 
     HRESULT hr = m_commonViewport->TransformVertices(vertex_count, data, flags, offscreen);
 
     // Restore the previously active viewport
     if (!m_commonViewport->IsCurrentViewport()) {
-      d3d9Device->SetViewport(&currentViewport9);
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(&currentViewport9);
     }
 
     return hr;
@@ -315,6 +315,8 @@ namespace dxvk {
       }
     }
 
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     // Temporarily activate this viewport in order to clear it
@@ -325,9 +327,9 @@ namespace dxvk {
       if (currentViewport != nullptr) {
         currentViewport9 = *currentViewport->GetCommonViewport()->GetD3D9Viewport();
       } else {
-        d3d9Device->GetViewport(&currentViewport9);
+        m_commonViewport->GetCommonD3DDevice()->GetViewport(&currentViewport9);
       }
-      d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     }
 
     static constexpr D3DCOLOR defaultColor = D3DCOLOR_ARGB(0, 0, 0, 0);
@@ -341,7 +343,7 @@ namespace dxvk {
 
     // Restore the previously active viewport
     if (!isCurrentViewport) {
-      d3d9Device->SetViewport(&currentViewport9);
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(&currentViewport9);
     }
 
     // Can fail in D3D9 only in case of a missing depth stencil surface
@@ -375,6 +377,8 @@ namespace dxvk {
     lights.push_back(d3dLight);
     d3dLight->SetViewport6(this);
 
+    D3DCommonDevice::InvalidateLights();
+
     if (m_commonViewport->HasDevice() && m_commonViewport->IsCurrentViewport())
       ApplyAndActivateLight(d3dLight->GetIndex(), d3dLight);
 
@@ -397,11 +401,14 @@ namespace dxvk {
       if (m_commonViewport->HasDevice() && m_commonViewport->IsCurrentViewport() && d3dLight->IsActive()) {
         const DWORD light9Index = d3dLight->GetIndex();
         //Logger::debug(str::format("D3D6Viewport: Disabling light nr. ", light9Index));
+        m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
         d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
         d3d9Device->LightEnable(light9Index, FALSE);
       }
       lights.erase(it);
       d3dLight->SetViewport6(nullptr);
+
+      D3DCommonDevice::InvalidateLights();
     } else {
       Logger::warn("D3D6Viewport::DeleteLight: Light not found");
       return DDERR_INVALIDPARAMS;
@@ -577,6 +584,8 @@ namespace dxvk {
       }
     }
 
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     // Temporarily activate this viewport in order to clear it
@@ -587,16 +596,16 @@ namespace dxvk {
       if (currentViewport != nullptr) {
         currentViewport9 = *currentViewport->GetCommonViewport()->GetD3D9Viewport();
       }  else {
-        d3d9Device->GetViewport(&currentViewport9);
+        m_commonViewport->GetCommonD3DDevice()->GetViewport(&currentViewport9);
       }
-      d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     }
 
     HRESULT hr = d3d9Device->Clear(count, rects, flags, color, z, stencil);
 
     // Restore the previously active viewport
     if (!isCurrentViewport) {
-      d3d9Device->SetViewport(&currentViewport9);
+      m_commonViewport->GetCommonD3DDevice()->SetViewport(&currentViewport9);
     }
 
     // Can fail in D3D9 only in case of a missing depth stencil surface
@@ -625,7 +634,7 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
-    HRESULT hr = d3d9Device->SetViewport(m_commonViewport->GetD3D9Viewport());
+    HRESULT hr = m_commonViewport->GetCommonD3DDevice()->SetViewport(m_commonViewport->GetD3D9Viewport());
     if (unlikely(FAILED(hr))) {
       Logger::err("D3D6Viewport: Failed to set the D3D9 viewport");
       return hr;
@@ -652,6 +661,8 @@ namespace dxvk {
     if (!lights.size())
       return D3D_OK;
 
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     for (auto light: lights) {
@@ -666,6 +677,8 @@ namespace dxvk {
   }
 
   HRESULT D3D6Viewport::ApplyAndActivateLight(DWORD light9Index, D3DLight* light) {
+    m_commonViewport->GetCommonD3DDevice()->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* d3d9Device = m_commonViewport->GetCommonD3DDevice()->GetD3D9Device();
 
     HRESULT hr = d3d9Device->SetLight(light9Index, light->GetD3D9Light());
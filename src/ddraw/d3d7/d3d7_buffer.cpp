@@ -147,7 +147,8 @@ namespace dxvk {
 
     D3DDeviceLock lock = device7->LockDevice();
 
-    d3d9::IDirect3DDevice9* device9 = device7->GetCommonD3DDevice()->GetD3D9Device();
+    D3DCommonDevice* commonDevice = device7->GetCommonD3DDevice();
+    d3d9::IDirect3DDevice9* device9 = commonDevice->GetD3D9Device();
 
     const D3DOptions* d3dOptions = m_commonIntf->GetOptions();
 
@@ -188,16 +189,9 @@ namespace dxvk {
       pvData.doNotCopyData = dwFlags & D3DPV_DONOTCOPYDATA;
       pvData.doExtents = true;
       pvData.isLegacy = false;
+      pvData.workerPool = commonDevice->GetWorkerPool();
 
-      std::vector<d3d9::D3DLIGHT9> lights9;
-      if (doLighting) {
-        device7->GetD3D9Lights(&lights9);
-        pvData.lights = &lights9;
-      } else {
-        pvData.lights = nullptr;
-      }
-
-      ProcessVerticesSW(device9, m_commonIntf->GetOptions(), &pvData);
+      ProcessVerticesSW(commonDevice, m_commonIntf->GetOptions(), &pvData);
 
       m_vb9->Unlock();
       srcBuffer9->Unlock();
@@ -207,8 +201,8 @@ namespace dxvk {
       if (unlikely(dwVertexOp & D3DVOP_LIGHT))
         Logger::warn("D3D7VertexBuffer::ProcessVertices: Unsupported operation D3DVOP_LIGHT");
 
-      device9->SetFVF(srcBuffer7->GetFVF());
-      device9->SetStreamSource(0, srcBuffer7->GetD3D9VertexBuffer(), 0, srcBuffer7->GetStride());
+      commonDevice->SetFVF(srcBuffer7->GetFVF());
+      commonDevice->SetStreamSource(0, srcBuffer7->GetD3D9VertexBuffer(), 0, srcBuffer7->GetStride());
       HRESULT hr = device9->ProcessVertices(dwSrcIndex, dwDestIndex, dwCount, m_vb9.ptr(), nullptr, dwFlags);
       if (unlikely(FAILED(hr))) {
         Logger::err("D3D7VertexBuffer::ProcessVertices: Failed call to D3D9 ProcessVertices");
@@ -220,12 +214,16 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7VertexBuffer::ProcessVerticesStrided(DWORD dwVertexOp, DWORD dwDestIndex, DWORD dwCount, LPD3DDRAWPRIMITIVESTRIDEDDATA lpVertexArray, DWORD dwSrcIndex, LPDIRECT3DDEVICE7 lpD3DDevice, DWORD dwFlags) {
-    Logger::warn("!!! D3D7VertexBuffer::ProcessVerticesStrided: Stub");
-
     if (unlikely(!dwCount))
       return D3D_OK;
 
-    if (unlikely(lpD3DDevice == nullptr))
+    if (unlikely(lpD3DDevice == nullptr || lpVertexArray == nullptr))
+      return DDERR_INVALIDPARAMS;
+
+    if (unlikely(!(dwVertexOp & D3DVOP_TRANSFORM)))
+      return DDERR_INVALIDPARAMS;
+
+    if (unlikely(lpVertexArray->position.lpvData == nullptr))
       return DDERR_INVALIDPARAMS;
 
     D3D7Device* device7 = static_cast<D3D7Device*>(lpD3DDevice);
@@ -245,9 +243,75 @@ namespace dxvk {
 
     D3DDeviceLock lock = device7->LockDevice();
 
-    //d3d9::IDirect3DDevice9* device9 = device7->GetCommonD3DDevice()->GetD3D9Device();
+    D3DCommonDevice* commonDevice = device7->GetCommonD3DDevice();
+
+    // There is no source vertex format to go by, so the source is made up of
+    // untransformed positions, plus any other components which have a stream,
+    // with texture coordinates laid out as per the destination vertex format
+    DWORD inFVF = D3DFVF_XYZ;
+
+    if (lpVertexArray->normal.lpvData != nullptr)
+      inFVF |= D3DFVF_NORMAL;
+    if (lpVertexArray->diffuse.lpvData != nullptr)
+      inFVF |= D3DFVF_DIFFUSE;
+    if (lpVertexArray->specular.lpvData != nullptr)
+      inFVF |= D3DFVF_SPECULAR;
+
+    const DWORD outNumTextures = (m_desc.dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT;
+
+    DWORD inNumTextures = 0;
+    while (inNumTextures < outNumTextures && lpVertexArray->textureCoords[inNumTextures].lpvData != nullptr)
+      inNumTextures++;
+
+    // Texture coordinate format bits only cover the used coordinate sets
+    const DWORD texCoordFormatMask = inNumTextures ? ((1u << (inNumTextures * 2)) - 1u) << 16 : 0u;
+    inFVF |= (inNumTextures << D3DFVF_TEXCOUNT_SHIFT) | (m_desc.dwFVF & texCoordFormatMask);
+
+    // Apply the source index to all streams upfront
+    D3DDRAWPRIMITIVESTRIDEDDATA strided = *lpVertexArray;
+
+    auto offsetStream = [dwSrcIndex] (D3DDP_PTRSTRIDE& stream) {
+      if (stream.lpvData != nullptr)
+        stream.lpvData = static_cast<uint8_t*>(stream.lpvData) + dwSrcIndex * stream.dwStride;
+    };
+
+    offsetStream(strided.position);
+    offsetStream(strided.normal);
+    offsetStream(strided.diffuse);
+    offsetStream(strided.specular);
+    for (DWORD tex = 0; tex < inNumTextures; tex++)
+      offsetStream(strided.textureCoords[tex]);
+
+    uint8_t *outData = nullptr;
+
+    HRESULT hr = m_vb9->Lock(dwDestIndex * m_stride, dwCount * m_stride, reinterpret_cast<void**>(&outData), 0);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7VertexBuffer::ProcessVerticesStrided: Failed to lock destination buffer");
+      return D3DERR_VERTEXBUFFERLOCKED;
+    }
 
-    // TODO: lpVertexArray needs to be transformed into a non-strided vertex buffer stream
+    // D3D9 has no strided equivalent, so always process vertices on the CPU
+    ProcessVerticesData pvData;
+    pvData.inData = nullptr;
+    pvData.inFVF = inFVF;
+    pvData.inStride = 0;
+    pvData.outData = outData;
+    pvData.outFVF = m_desc.dwFVF;
+    pvData.outStride = m_stride;
+    pvData.vertexCount = dwCount;
+    pvData.correction = nullptr;
+    pvData.dsStatus = nullptr;
+    pvData.doLighting = dwVertexOp & D3DVOP_LIGHT;
+    pvData.doClipping = dwVertexOp & D3DVOP_CLIP;
+    pvData.doNotCopyData = dwFlags & D3DPV_DONOTCOPYDATA;
+    pvData.doExtents = true;
+    pvData.isLegacy = false;
+    pvData.workerPool = commonDevice->GetWorkerPool();
+    pvData.strided = &strided;
+
+    ProcessVerticesSW(commonDevice, m_commonIntf->GetOptions(), &pvData);
+
+    m_vb9->Unlock();
 
     return D3D_OK;
   }
@@ -5,6 +5,8 @@
 #include "d3d7_buffer.h"
 #include "d3d7_state_block.h"
 
+#include "../ddraw_palette.h"
+
 #include "../ddraw7/ddraw7_surface.h"
 
 namespace dxvk {
@@ -53,18 +55,6 @@ namespace dxvk {
       m_ds = m_rt->GetAttachedDepthStencil();
     }
 
-    // Common D3D9 index buffers
-    static constexpr DWORD Usage = D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY;
-
-    for (uint8_t ibIndex = 0; ibIndex < ddrawCaps::IndexBufferCount ; ibIndex++) {
-      const UINT ibSize = ddrawCaps::IndexCount[ibIndex] * sizeof(WORD);
-
-      HRESULT hr = device9->CreateIndexBuffer(ibSize, Usage, d3d9::D3DFMT_INDEX16,
-                                              d3d9::D3DPOOL_DEFAULT, &m_ib9[ibIndex], nullptr);
-      if (unlikely(FAILED(hr)))
-        throw DxvkError("D3D7Device: ERROR! Failed to initialize D3D9 index buffers.");
-    }
-
     // Get the bridge interface to D3D9
     if (unlikely(FAILED(device9->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&m_bridge))))) {
       throw DxvkError("D3D7Device: ERROR! Failed to get D3D9 Bridge. d3d9.dll might not be DXVK!");
@@ -232,6 +222,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::BeginScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(m_commonD3DDevice->IsInScene()))
@@ -249,6 +241,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::EndScene() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     RefreshLastUsedDevice();
 
     if (unlikely(!m_commonD3DDevice->IsInScene()))
@@ -282,6 +276,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::SetRenderTarget(IDirectDrawSurface7 *surface, DWORD flags) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(surface == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -310,6 +306,9 @@ namespace dxvk {
       return hr;
     }
 
+    // D3D9 resets the viewport to cover the new RT
+    m_commonD3DDevice->InvalidateViewport();
+
     m_rt = rt7;
     m_ds = m_rt->GetAttachedDepthStencil();
 
@@ -350,6 +349,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::Clear(DWORD count, D3DRECT *rects, DWORD flags, D3DCOLOR color, D3DVALUE z, DWORD stencil) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     // D3D7 and later fast skip
     if (unlikely(!count && rects))
       return D3D_OK;
@@ -394,15 +395,21 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->SetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->SetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::GetTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->GetTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->GetTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::MultiplyTransform(D3DTRANSFORMSTATETYPE state, D3DMATRIX *matrix) {
-    return m_commonD3DDevice->GetD3D9Device()->MultiplyTransform(ConvertTransformState(state), matrix);
+    D3DDeviceLock lock = LockDevice();
+
+    return m_commonD3DDevice->MultiplyTransform(ConvertTransformState(state), matrix);
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetViewport(D3DVIEWPORT7 *data) {
@@ -433,7 +440,7 @@ namespace dxvk {
       data->dvMaxZ = 1.0f;
     }
 
-    return m_commonD3DDevice->GetD3D9Device()->SetViewport(reinterpret_cast<d3d9::D3DVIEWPORT9*>(data));
+    return m_commonD3DDevice->SetViewport(reinterpret_cast<d3d9::D3DVIEWPORT9*>(data));
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::GetViewport(D3DVIEWPORT7 *data) {
@@ -442,10 +449,12 @@ namespace dxvk {
     if (unlikely(data == nullptr))
       return DDERR_INVALIDPARAMS;
 
-    return m_commonD3DDevice->GetD3D9Device()->GetViewport(reinterpret_cast<d3d9::D3DVIEWPORT9*>(data));
+    return m_commonD3DDevice->GetViewport(reinterpret_cast<d3d9::D3DVIEWPORT9*>(data));
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetMaterial(D3DMATERIAL7 *data) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(data == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -460,6 +469,8 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetLight(DWORD idx, D3DLIGHT7 *data) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(data == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -484,6 +495,8 @@ namespace dxvk {
 
     m_lights[idx] = *light9;
 
+    D3DCommonDevice::InvalidateLights();
+
     return D3D_OK;
   }
 
@@ -501,6 +514,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::SetRenderState(D3DRENDERSTATETYPE dwRenderStateType, DWORD dwRenderState) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::D3DRENDERSTATETYPE State9 = d3d9::D3DRENDERSTATETYPE(dwRenderStateType);
 
     switch (dwRenderStateType) {
@@ -796,6 +811,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::BeginStateBlock() {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(m_recorder != nullptr))
       return D3DERR_INBEGINSTATEBLOCK;
 
@@ -803,6 +820,8 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
+    m_commonD3DDevice->SetRecordingStateBlock(true);
+
     m_handle++;
     auto stateBlockIterPair = m_stateBlocks.emplace(std::piecewise_construct,
                                                     std::forward_as_tuple(m_handle),
@@ -816,6 +835,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::EndStateBlock(LPDWORD lpdwBlockHandle) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(lpdwBlockHandle == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -827,6 +848,8 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
+    m_commonD3DDevice->SetRecordingStateBlock(false);
+
     m_recorder->SetD3D9(std::move(pStateBlock));
 
     *lpdwBlockHandle = m_recorderHandle;
@@ -840,6 +863,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::ApplyStateBlock(DWORD dwBlockHandle) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     // Applications cannot apply a state block while another is being recorded
     if (unlikely(ShouldRecord()))
       return D3DERR_INBEGINSTATEBLOCK;
@@ -851,12 +876,22 @@ namespace dxvk {
       return D3DERR_INVALIDSTATEBLOCK;
     }
 
-    return stateBlockIter->second.Apply();
+    HRESULT hr = stateBlockIter->second.Apply();
+
+    // Transforms, viewport and vertex input may have been changed by the state block
+    m_commonD3DDevice->InvalidateVertexInput();
+    m_commonD3DDevice->InvalidateTransforms();
+    m_commonD3DDevice->InvalidateViewport();
+    D3DCommonDevice::InvalidateLights();
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::CaptureStateBlock(DWORD dwBlockHandle) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     // Applications cannot capture a state block while another is being recorded
     if (unlikely(ShouldRecord()))
       return D3DERR_INBEGINSTATEBLOCK;
@@ -899,6 +934,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::CreateStateBlock(D3DSTATEBLOCKTYPE d3dsbType, LPDWORD lpdwBlockHandle) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(lpdwBlockHandle == nullptr))
       return DDERR_INVALIDPARAMS;
 
@@ -967,17 +1004,34 @@ namespace dxvk {
 
     DDrawDirtySurfaceUpload();
 
+    if (m_commonD3DDevice->ShouldBatch()) {
+      D3DBatchState state;
+      state.fvf      = dwVertexTypeDesc;
+      state.listType = D3DBatcher::GetListType(d3dptPrimitiveType);
+
+      if (m_commonD3DDevice->BatchDraw(state, d3dptPrimitiveType, lpvVertices, dwVertexCount, nullptr, 0)) {
+        UpdateSurfaceDirtyTracking(true, true, true);
+        return D3D_OK;
+      }
+    }
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    device9->SetFVF(dwVertexTypeDesc);
-    HRESULT hr = device9->DrawPrimitiveUP(
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(dwVertexTypeDesc, lpvVertices, dwVertexCount, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
+    hr = device9->DrawPrimitive(
                      d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
-                     GetPrimitiveCount(d3dptPrimitiveType, dwVertexCount),
-                     lpvVertices,
-                     GetFVFSize(dwVertexTypeDesc));
+                     baseVertex,
+                     GetPrimitiveCount(d3dptPrimitiveType, dwVertexCount));
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D7Device::DrawPrimitive: Failed D3D9 call to DrawPrimitiveUP");
+      Logger::err("D3D7Device::DrawPrimitive: Failed D3D9 call to DrawPrimitive");
       return hr;
     }
 
@@ -999,21 +1053,45 @@ namespace dxvk {
 
     DDrawDirtySurfaceUpload();
 
+    if (m_commonD3DDevice->ShouldBatch()) {
+      D3DBatchState state;
+      state.fvf      = dwVertexTypeDesc;
+      state.listType = D3DBatcher::GetListType(d3dptPrimitiveType);
+
+      if (m_commonD3DDevice->BatchDraw(state, d3dptPrimitiveType, lpvVertices, dwVertexCount, lpwIndices, dwIndexCount)) {
+        UpdateSurfaceDirtyTracking(true, true, true);
+        return D3D_OK;
+      }
+    }
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    device9->SetFVF(dwVertexTypeDesc);
-    HRESULT hr = device9->DrawIndexedPrimitiveUP(
+    UINT baseVertex = 0;
+
+    HRESULT hr = m_commonD3DDevice->SetStreamingVertices(dwVertexTypeDesc, lpvVertices, dwVertexCount, &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawIndexedPrimitive: Failed to upload vertices");
+      return hr;
+    }
+
+    UINT startIndex = 0;
+
+    hr = m_commonD3DDevice->SetStreamingIndices(lpwIndices, dwIndexCount, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawIndexedPrimitive: Failed to upload indices");
+      return hr;
+    }
+
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
+                      baseVertex,
                       0,
                       dwVertexCount,
-                      GetPrimitiveCount(d3dptPrimitiveType, dwIndexCount),
-                      lpwIndices,
-                      d3d9::D3DFMT_INDEX16,
-                      lpvVertices,
-                      GetFVFSize(dwVertexTypeDesc));
+                      startIndex,
+                      GetPrimitiveCount(d3dptPrimitiveType, dwIndexCount));
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D7Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitiveUP");
+      Logger::err("D3D7Device::DrawIndexedPrimitive: Failed D3D9 call to DrawIndexedPrimitive");
       return hr;
     }
 
@@ -1034,7 +1112,7 @@ namespace dxvk {
       return DDERR_INVALIDPARAMS;
 
     d3d9::D3DVIEWPORT9 viewport9;
-    if (SUCCEEDED(m_commonD3DDevice->GetD3D9Device()->GetViewport(&viewport9))) {
+    if (SUCCEEDED(m_commonD3DDevice->GetViewport(&viewport9))) {
       clip_status->dwFlags = D3DCLIPSTATUS_EXTENTS2;
       clip_status->dwStatus = 0;
       clip_status->minx = viewport9.X;
@@ -1063,18 +1141,20 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    // Transform strided vertex data to a standard vertex buffer stream
-    PackedVertexBuffer pvb = TransformStridedtoUP(dwVertexTypeDesc, lpVertexArray, dwVertexCount);
+    // Bind each strided component as a separate D3D9 stream
+    HRESULT hr = m_commonD3DDevice->SetStridedVertexData(dwVertexTypeDesc, lpVertexArray, dwVertexCount);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawPrimitiveStrided: Failed to upload strided vertex data");
+      return hr;
+    }
 
-    device9->SetFVF(dwVertexTypeDesc);
-    HRESULT hr = device9->DrawPrimitiveUP(
+    hr = device9->DrawPrimitive(
                      d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
-                     GetPrimitiveCount(d3dptPrimitiveType, dwVertexCount),
-                     pvb.vertexData.data(),
-                     pvb.stride);
+                     0,
+                     GetPrimitiveCount(d3dptPrimitiveType, dwVertexCount));
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D7Device::DrawPrimitiveStrided: Failed D3D9 call to DrawPrimitiveUP");
+      Logger::err("D3D7Device::DrawPrimitiveStrided: Failed D3D9 call to DrawPrimitive");
       return hr;
     }
 
@@ -1094,26 +1174,40 @@ namespace dxvk {
     if (unlikely(lpVertexArray == nullptr || lpwIndices == nullptr))
       return DDERR_INVALIDPARAMS;
 
+    if (unlikely(dwIndexCount > ddrawCaps::MaxIndexCount)) {
+      Logger::err("D3D7Device::DrawIndexedPrimitiveStrided: Exceeded size of largest index buffer");
+      return DDERR_UNSUPPORTED;
+    }
+
     DDrawDirtySurfaceUpload();
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    // Transform strided vertex data to a standard vertex buffer stream
-    PackedVertexBuffer pvb = TransformStridedtoUP(dwVertexTypeDesc, lpVertexArray, dwVertexCount);
+    // Bind each strided component as a separate D3D9 stream
+    HRESULT hr = m_commonD3DDevice->SetStridedVertexData(dwVertexTypeDesc, lpVertexArray, dwVertexCount);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawIndexedPrimitiveStrided: Failed to upload strided vertex data");
+      return hr;
+    }
 
-    device9->SetFVF(dwVertexTypeDesc);
-    HRESULT hr = device9->DrawIndexedPrimitiveUP(
+    UINT startIndex = 0;
+
+    hr = m_commonD3DDevice->SetStreamingIndices(lpwIndices, dwIndexCount, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawIndexedPrimitiveStrided: Failed to upload indices");
+      return hr;
+    }
+
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
                       0,
+                      0,
                       dwVertexCount,
-                      GetPrimitiveCount(d3dptPrimitiveType, dwIndexCount),
-                      lpwIndices,
-                      d3d9::D3DFMT_INDEX16,
-                      pvb.vertexData.data(),
-                      pvb.stride);
+                      startIndex,
+                      GetPrimitiveCount(d3dptPrimitiveType, dwIndexCount));
 
     if (unlikely(FAILED(hr))) {
-      Logger::err("D3D7Device::DrawIndexedPrimitiveStrided: Failed D3D9 call to DrawIndexedPrimitiveUP");
+      Logger::err("D3D7Device::DrawIndexedPrimitiveStrided: Failed D3D9 call to DrawIndexedPrimitive");
       return hr;
     }
 
@@ -1149,8 +1243,8 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    device9->SetFVF(vb7->GetFVF());
-    device9->SetStreamSource(0, vb7->GetD3D9VertexBuffer(), 0, vb7->GetStride());
+    m_commonD3DDevice->SetFVF(vb7->GetFVF());
+    m_commonD3DDevice->SetStreamSource(0, vb7->GetD3D9VertexBuffer(), 0, vb7->GetStride());
     HRESULT hr = device9->DrawPrimitive(
                       d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
                       dwStartVertex,
@@ -1198,30 +1292,22 @@ namespace dxvk {
 
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
-    uint8_t ibIndex = 0;
-    // Fit index buffer uploads into the smallest buffer size possible
-    while (dwIndexCount > ddrawCaps::IndexCount[ibIndex])
-      ibIndex++;
+    UINT startIndex = 0;
 
-    d3d9::IDirect3DIndexBuffer9* ib9 = m_ib9[ibIndex].ptr();
-
-    const size_t ibSize = dwIndexCount * sizeof(WORD);
-    void* pData = nullptr;
-
-    // Locking and unlocking are generally expected to work here
-    ib9->Lock(0, ibSize, &pData, D3DLOCK_DISCARD);
-    memcpy(pData, static_cast<void*>(lpwIndices), ibSize);
-    ib9->Unlock();
+    HRESULT hr = m_commonD3DDevice->SetStreamingIndices(lpwIndices, dwIndexCount, &startIndex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3D7Device::DrawIndexedPrimitiveVB: Failed to upload indices");
+      return hr;
+    }
 
-    device9->SetIndices(ib9);
-    device9->SetFVF(vb7->GetFVF());
-    device9->SetStreamSource(0, vb7->GetD3D9VertexBuffer(), 0, vb7->GetStride());
-    HRESULT hr = device9->DrawIndexedPrimitive(
+    m_commonD3DDevice->SetFVF(vb7->GetFVF());
+    m_commonD3DDevice->SetStreamSource(0, vb7->GetD3D9VertexBuffer(), 0, vb7->GetStride());
+    hr = device9->DrawIndexedPrimitive(
                       d3d9::D3DPRIMITIVETYPE(d3dptPrimitiveType),
                       dwStartVertex,
                       0,
                       dwNumVertices,
-                      0,
+                      startIndex,
                       GetPrimitiveCount(d3dptPrimitiveType, dwIndexCount));
 
     if (unlikely(FAILED(hr))) {
@@ -1269,6 +1355,8 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE D3D7Device::SetTexture(DWORD stage, IDirectDrawSurface7 *surface) {
     D3DDeviceLock lock = LockDevice();
 
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (unlikely(stage >= ddrawCaps::TextureStageCount))
       return DDERR_INVALIDPARAMS;
 
@@ -1400,6 +1488,8 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetTextureStageState(DWORD dwStage, D3DTEXTURESTAGESTATETYPE d3dTexStageStateType, DWORD dwState) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     d3d9::IDirect3DDevice9* device9 = m_commonD3DDevice->GetD3D9Device();
 
     // In the case of D3DTSS_ADDRESS, which is exclusive to D3D7
@@ -1435,6 +1525,8 @@ namespace dxvk {
 
   // This is a precursor of our ol' D3D8 pal CopyRects
   HRESULT STDMETHODCALLTYPE D3D7Device::Load(IDirectDrawSurface7 *dst_surface, POINT *dst_point, IDirectDrawSurface7 *src_surface, RECT *src_rect, DWORD flags) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     if (dst_surface == nullptr || src_surface == nullptr)
       return DDERR_INVALIDPARAMS;
 
@@ -1446,20 +1538,33 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
-    const RECT* sourceFullSurfaceRect = nullptr;
-    ddraw7SurfaceSrc = static_cast<DDraw7Surface*>(src_surface);
-    ddraw7SurfaceSrc->DownloadSurfaceData();
-    sourceFullSurfaceRect = ddraw7SurfaceSrc->GetCommonSurface()->GetFullSurfaceRect();
-
     if (unlikely(!DDrawCommonInterface::IsWrappedSurface(dst_surface))) {
       Logger::err("D3D7Device::Load: Unwrapped surface destination");
       return DDERR_UNSUPPORTED;
     }
 
+    ddraw7SurfaceSrc = static_cast<DDraw7Surface*>(src_surface);
     ddraw7SurfaceDst = static_cast<DDraw7Surface*>(dst_surface);
+
+    // Copy directly between the D3D9 textures if the source is already on the GPU
+    if (ddraw7SurfaceSrc->GetCommonSurface()->IsInitialized()) {
+      RefreshLastUsedDevice();
+      if (SUCCEEDED(ddraw7SurfaceDst->GetCommonSurface()->LoadD3D9(ddraw7SurfaceSrc->GetCommonSurface(),
+                                                                   dst_point, src_rect, flags))) {
+        CopyLoadAttributes(ddraw7SurfaceDst, ddraw7SurfaceSrc);
+        return D3D_OK;
+      }
+    }
+
+    const RECT* sourceFullSurfaceRect = nullptr;
+    ddraw7SurfaceSrc->DownloadSurfaceData();
+    sourceFullSurfaceRect = ddraw7SurfaceSrc->GetCommonSurface()->GetFullSurfaceRect();
+
     if ((dst_point == nullptr || (dst_point->x == 0 && dst_point->y == 0)) &&
         ddraw7SurfaceDst->GetCommonSurface()->IsFullSurfaceLock(src_rect, sourceFullSurfaceRect)) {
       ddraw7SurfaceDst->GetCommonSurface()->UnDirtyD3D9Surface();
+      // Lower mips may not all get overwritten
+      ddraw7SurfaceDst->DownloadStaleMips();
     } else {
       ddraw7SurfaceDst->DownloadSurfaceData();
     }
@@ -1482,6 +1587,8 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::LightEnable(DWORD dwLightIndex, BOOL bEnable) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     HRESULT hr = m_commonD3DDevice->GetD3D9Device()->LightEnable(dwLightIndex, bEnable);
     if (unlikely(FAILED(hr)))
       return DDERR_INVALIDPARAMS;
@@ -1504,6 +1611,8 @@ namespace dxvk {
     // Store a default light if the light cache doesn't contain one
     m_lights.try_emplace(dwLightIndex, DefaultLight);
 
+    D3DCommonDevice::InvalidateLights();
+
     return D3D_OK;
   }
 
@@ -1519,6 +1628,8 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE D3D7Device::SetClipPlane(DWORD dwIndex, D3DVALUE *pPlaneEquation) {
+    m_commonD3DDevice->FlushBatchedDraws();
+
     return m_commonD3DDevice->GetD3D9Device()->SetClipPlane(dwIndex, pPlaneEquation);
   }
 
@@ -1637,4 +1748,31 @@ namespace dxvk {
     }
   }
 
+  // Load also carries over the palette and color keys, which the
+  // CPU path gets for free from the proxy, so mirror it here
+  inline void D3D7Device::CopyLoadAttributes(DDraw7Surface* dst, DDraw7Surface* src) {
+    DDrawPalette* srcPalette = src->GetCommonSurface()->GetPalette();
+    DDrawPalette* dstPalette = dst->GetCommonSurface()->GetPalette();
+
+    if (srcPalette != nullptr && dstPalette != nullptr) {
+      DWORD paletteCaps = 0;
+      srcPalette->GetCaps(&paletteCaps);
+
+      const DWORD entryCount = (paletteCaps & DDPCAPS_8BIT) ? 256
+                             : (paletteCaps & DDPCAPS_4BIT) ? 16
+                             : (paletteCaps & DDPCAPS_2BIT) ? 4 : 2;
+
+      std::array<PALETTEENTRY, 256> entries;
+      // Goes through the wrapper, so that the D3D9 side gets updated as well
+      if (SUCCEEDED(srcPalette->GetEntries(0, 0, entryCount, entries.data())))
+        dstPalette->SetEntries(0, 0, entryCount, entries.data());
+    }
+
+    for (DWORD colorKeyFlag = DDCKEY_DESTBLT; colorKeyFlag <= DDCKEY_SRCOVERLAY; colorKeyFlag <<= 1) {
+      DDCOLORKEY colorKey;
+      if (SUCCEEDED(src->GetColorKey(colorKeyFlag, &colorKey)))
+        dst->SetColorKey(colorKeyFlag, &colorKey);
+    }
+  }
+
 }
\ No newline at end of file
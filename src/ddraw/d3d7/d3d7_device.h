@@ -161,10 +161,13 @@ namespace dxvk {
       return m_ds.ptr();
     }
 
-    void GetD3D9Lights(std::vector<d3d9::D3DLIGHT9>* lights9) {
+    template <typename Fn>
+    void ForEachEnabledLight(const Fn& fn) const {
       for (const auto& [idx, light9] : m_lights) {
-        if (m_lightsStates[idx])
-          lights9->push_back(light9);
+        auto lightState = m_lightsStates.find(idx);
+
+        if (lightState != m_lightsStates.end() && lightState->second)
+          fn(light9);
       }
     }
 
@@ -172,6 +175,8 @@ namespace dxvk {
 
     inline void DDrawDirtySurfaceUpload();
 
+    inline void CopyLoadAttributes(DDraw7Surface* dst, DDraw7Surface* src);
+
     inline bool ShouldRecord() const { return m_recorder != nullptr; }
 
     inline void RefreshLastUsedDevice() {
@@ -202,8 +207,6 @@ namespace dxvk {
     DWORD                           m_handle                = 0;
     std::unordered_map<DWORD, D3D7StateBlock> m_stateBlocks;
 
-    std::array<Com<d3d9::IDirect3DIndexBuffer9>, ddrawCaps::IndexBufferCount> m_ib9;
-
   };
 
 }
\ No newline at end of file
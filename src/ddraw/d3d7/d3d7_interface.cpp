@@ -300,9 +300,8 @@ namespace dxvk {
     params.PresentationInterval       = vBlankStatus ? D3DPRESENT_INTERVAL_DEFAULT : D3DPRESENT_INTERVAL_IMMEDIATE;
 
     Com<d3d9::IDirect3DDevice9> device9;
-    hr = m_commonD3DIntf->GetD3D9Interface()->CreateDevice(
-      D3DADAPTER_DEFAULT,
-      d3d9::D3DDEVTYPE_HAL,
+    hr = m_commonD3DIntf->CreateD3D9Device(
+      m_commonIntf,
       hWnd,
       deviceCreationFlags9,
       &params,
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "ddraw_include.h"
+#include "ddraw_util.h"
+
+#include <cstring>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Batched draw state
+   *
+   * Everything which a batched draw depends on besides the D3D9
+   * device state, which can not change while a batch is pending.
+   */
+  struct D3DBatchState {
+    DWORD            fvf                 = 0;
+    D3DPRIMITIVETYPE listType            = D3DPT_TRIANGLELIST;
+    // D3D6 draws with lighting disabled for the draw only
+    bool             disableLighting     = false;
+    // D3D6 legacy projection matrix, applied for the draw only
+    bool             useLegacyProjection = false;
+    D3DMATRIX        legacyProjection    = { };
+
+    bool operator == (const D3DBatchState& other) const {
+      return fvf                 == other.fvf
+          && listType            == other.listType
+          && disableLighting     == other.disableLighting
+          && useLegacyProjection == other.useLegacyProjection
+          && (!useLegacyProjection || !std::memcmp(&legacyProjection, &other.legacyProjection, sizeof(D3DMATRIX)));
+    }
+  };
+
+  /**
+   * \brief Draw call batcher
+   *
+   * Merges consecutive small draws with the same state into a single
+   * indexed list draw. Vertices and indices are gathered on the CPU,
+   * and only get uploaded once the batch is flushed, so a single
+   * pending batch is enough to preserve the draw order.
+   */
+  class D3DBatcher {
+
+  public:
+
+    // Larger draws gain nothing from batching
+    static constexpr DWORD MaxDrawVertexCount = 1024;
+
+    // Batched vertices are addressed with 16-bit indices
+    static constexpr DWORD MaxBatchVertexCount = 0xFFFF;
+
+    static bool CanBatch(D3DPRIMITIVETYPE type, DWORD vertexCount) {
+      return vertexCount <= MaxDrawVertexCount
+          && (type == D3DPT_TRIANGLELIST
+           || type == D3DPT_TRIANGLESTRIP
+           || type == D3DPT_TRIANGLEFAN
+           || type == D3DPT_LINELIST);
+    }
+
+    static D3DPRIMITIVETYPE GetListType(D3DPRIMITIVETYPE type) {
+      return type == D3DPT_LINELIST ? D3DPT_LINELIST : D3DPT_TRIANGLELIST;
+    }
+
+    bool IsEmpty() const {
+      return m_indices.empty();
+    }
+
+    // Draws may only be added if this returns true, otherwise
+    // the pending batch needs to be flushed first
+    bool IsCompatible(const D3DBatchState& state, DWORD vertexCount) const {
+      return IsEmpty() || (m_state == state && m_vertexCount + vertexCount <= MaxBatchVertexCount);
+    }
+
+    void AddDraw(
+      const D3DBatchState&   state,
+            D3DPRIMITIVETYPE type,
+      const void*            vertices,
+            DWORD            vertexCount,
+      const WORD*            indices,
+            DWORD            indexCount) {
+      if (IsEmpty()) {
+        m_state       = state;
+        m_stride      = GetFVFSize(state.fvf);
+        m_vertexCount = 0;
+        m_vertices.clear();
+      }
+
+      const WORD base = WORD(m_vertexCount);
+      const size_t vertexOffset = m_vertices.size();
+
+      m_vertices.resize(vertexOffset + vertexCount * m_stride);
+      std::memcpy(m_vertices.data() + vertexOffset, vertices, vertexCount * m_stride);
+      m_vertexCount += vertexCount;
+
+      const DWORD count = indices != nullptr ? indexCount : vertexCount;
+
+      auto index = [=] (DWORD i) {
+        return WORD(base + (indices != nullptr ? indices[i] : WORD(i)));
+      };
+
+      switch (type) {
+        case D3DPT_TRIANGLELIST:
+          for (DWORD i = 0; i + 2 < count; i += 3)
+            PushTriangle(index(i), index(i + 1), index(i + 2));
+          break;
+
+        // Odd triangles get rotated rather than reversed, which
+        // keeps their first vertex for flat shading
+        case D3DPT_TRIANGLESTRIP:
+          for (DWORD i = 0; i + 2 < count; i++) {
+            if (i & 1)
+              PushTriangle(index(i), index(i + 2), index(i + 1));
+            else
+              PushTriangle(index(i), index(i + 1), index(i + 2));
+          }
+          break;
+
+        // Fans use the second vertex of each triangle for flat shading
+        case D3DPT_TRIANGLEFAN:
+          for (DWORD i = 1; i + 1 < count; i++)
+            PushTriangle(index(i), index(i + 1), index(0));
+          break;
+
+        case D3DPT_LINELIST:
+          for (DWORD i = 0; i + 1 < count; i += 2) {
+            m_indices.push_back(index(i));
+            m_indices.push_back(index(i + 1));
+          }
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    void Reset() {
+      m_indices.clear();
+      m_vertices.clear();
+      m_vertexCount = 0;
+    }
+
+    const D3DBatchState& GetState() const {
+      return m_state;
+    }
+
+    UINT GetStride() const {
+      return m_stride;
+    }
+
+    DWORD GetVertexCount() const {
+      return m_vertexCount;
+    }
+
+    const void* GetVertexData() const {
+      return m_vertices.data();
+    }
+
+    const std::vector<WORD>& GetIndices() const {
+      return m_indices;
+    }
+
+    UINT GetPrimitiveCount() const {
+      return m_state.listType == D3DPT_LINELIST
+        ? UINT(m_indices.size() / 2)
+        : UINT(m_indices.size() / 3);
+    }
+
+  private:
+
+    void PushTriangle(WORD a, WORD b, WORD c) {
+      m_indices.push_back(a);
+      m_indices.push_back(b);
+      m_indices.push_back(c);
+    }
+
+    D3DBatchState     m_state;
+    UINT              m_stride      = 0;
+    DWORD             m_vertexCount = 0;
+
+    std::vector<BYTE> m_vertices;
+    std::vector<WORD> m_indices;
+
+  };
+
+}
\ No newline at end of file
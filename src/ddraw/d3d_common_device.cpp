@@ -13,8 +13,17 @@
 #include "d3d5/d3d5_device.h"
 #include "d3d3/d3d3_device.h"
 
+#include "d3d_process_vertices.h"
+
+#include "../util/util_math.h"
+#include "../util/util_singleton.h"
+
 namespace dxvk {
 
+  static Singleton<D3DWorkerPool> g_workerPool;
+
+  std::atomic<uint64_t> D3DCommonDevice::s_lightsVersion = 0;
+
   D3DCommonDevice::D3DCommonDevice(
         DDrawCommonInterface* commonIntf,
         GUID deviceGUID,
@@ -24,11 +33,39 @@ namespace dxvk {
     , m_deviceGUID     ( deviceGUID )
     , m_params9        ( *pParams9 )
     , m_creationFlags9 ( creationFlags9 ) {
+    const D3DOptions* options = m_commonIntf->GetOptions();
+
+    if (options->cpuProcessVertices) {
+      const uint32_t threadCount = options->processVerticesThreads > 0
+        ? uint32_t(options->processVerticesThreads)
+        : std::min(dxvk::thread::hardware_concurrency(), 4u);
+
+      if (threadCount > 1)
+        m_workerPool = g_workerPool.acquire(threadCount);
+    }
+
+    if (options->batching)
+      m_batcher = new D3DBatcher();
   }
 
   D3DCommonDevice::~D3DCommonDevice() {
+    if (m_device9 != nullptr)
+      FlushQueuedBlts();
+
+    if (m_batcher != nullptr)
+      delete m_batcher;
+
+    if (m_workerPool != nullptr) {
+      m_workerPool = nullptr;
+      g_workerPool.release();
+    }
+
     if (m_commonIntf->GetCommonD3DDevice() == this)
       m_commonIntf->SetCommonD3DDevice(nullptr);
+
+    // Hand over the D3D9 device, along with all resources created on it, to the next D3D device
+    if (m_commonIntf->GetOptions()->deviceReuse && m_device9 != nullptr)
+      m_commonIntf->RetainD3D9Device(std::move(m_device9), m_params9.hDeviceWindow, m_creationFlags9);
   }
 
   D3DCommonInterface* D3DCommonDevice::GetCommonD3DInterface() const {
@@ -47,16 +84,39 @@ namespace dxvk {
   }
 
   HRESULT D3DCommonDevice::ResetD3D9Swapchain(d3d9::D3DPRESENT_PARAMETERS* params) {
-    if (m_device7 != nullptr) {
-      return m_device7->ResetD3D9Swapchain(params);
-    } else if (m_device6 != nullptr) {
-      return m_device6->ResetD3D9Swapchain(params);
+    if (m_device7 != nullptr || m_device6 != nullptr) {
+      // Don't rely on any mirrored state surviving a swapchain reset
+      InvalidateTransforms();
+      InvalidateViewport();
+
+      return m_device7 != nullptr ? m_device7->ResetD3D9Swapchain(params)
+                                  : m_device6->ResetD3D9Swapchain(params);
     }
     // D3D5/3 has no way of disabling/re-enabling VSync
 
     return DDERR_UNSUPPORTED;
   }
 
+  HRESULT D3DCommonDevice::SetPresentationInterval(DWORD presentationInterval) {
+    if (m_device7 == nullptr && m_device6 == nullptr)
+      return DDERR_UNSUPPORTED;
+
+    Com<IDxvkLegacyD3DDeviceBridge> bridge;
+    if (unlikely(FAILED(GetD3D9Device()->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&bridge))))) {
+      Logger::err("D3DCommonDevice::SetPresentationInterval: Failed to get D3D9 Bridge");
+      return DDERR_GENERIC;
+    }
+
+    HRESULT hr = bridge->SetPresentationInterval(presentationInterval);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // Keep later swapchain resets in line with the current interval
+    m_params9.PresentationInterval = presentationInterval;
+
+    return DD_OK;
+  }
+
   DDrawSurface* D3DCommonDevice::GetCurrentRenderTarget() const {
     return m_device5 != nullptr ? m_device5->GetRenderTarget() :
            m_device3 != nullptr ? m_device3->GetRenderTarget() : nullptr;
@@ -77,4 +137,1050 @@ namespace dxvk {
            m_device3 != nullptr ? m_device3->GetRenderTarget()->GetCommonSurface() == commonSurface : false;
   }
 
+  HRESULT D3DCommonDevice::SetTransform(d3d9::D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix) {
+    FlushBatchedDraws();
+
+    HRESULT hr = m_device9->SetTransform(state, matrix);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    D3DMATRIX* mirrored = GetMirroredTransform(state);
+
+    if (mirrored != nullptr && m_transformsValid) {
+      *mirrored = *matrix;
+      m_transformVersion++;
+
+      if (mirrored == &m_view)
+        m_viewVersion++;
+    }
+
+    return hr;
+  }
+
+  HRESULT D3DCommonDevice::GetTransform(d3d9::D3DTRANSFORMSTATETYPE state, D3DMATRIX* matrix) {
+    D3DMATRIX* mirrored = GetMirroredTransform(state);
+
+    // Texture transforms are rarely queried, so don't bother mirroring them
+    if (mirrored == nullptr)
+      return m_device9->GetTransform(state, matrix);
+
+    if (unlikely(matrix == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    HRESULT hr = SyncTransforms();
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    *matrix = *mirrored;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::MultiplyTransform(d3d9::D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix) {
+    FlushBatchedDraws();
+
+    HRESULT hr = m_device9->MultiplyTransform(state, matrix);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    D3DMATRIX* mirrored = GetMirroredTransform(state);
+
+    // Let D3D9 do the math and only read back the result
+    if (mirrored != nullptr && m_transformsValid) {
+      if (likely(SUCCEEDED(m_device9->GetTransform(state, mirrored)))) {
+        m_transformVersion++;
+
+        if (mirrored == &m_view)
+          m_viewVersion++;
+      } else {
+        InvalidateTransforms();
+      }
+    }
+
+    return hr;
+  }
+
+  HRESULT D3DCommonDevice::SetViewport(const d3d9::D3DVIEWPORT9* viewport) {
+    FlushBatchedDraws();
+
+    HRESULT hr = m_device9->SetViewport(viewport);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    m_viewport9     = *viewport;
+    m_viewportValid = true;
+
+    return hr;
+  }
+
+  HRESULT D3DCommonDevice::GetViewport(d3d9::D3DVIEWPORT9* viewport) {
+    if (unlikely(viewport == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    HRESULT hr = SyncViewport();
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    *viewport = m_viewport9;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::GetWorldViewMatrices(D3DMATRIX* worldView, D3DMATRIX* worldViewProjection) {
+    HRESULT hr = SyncTransforms();
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    if (m_worldViewVersion != m_transformVersion) {
+      m_worldView           = D3DMatrixMultiply4x4(m_world, m_view);
+      m_worldViewProjection = D3DMatrixMultiply4x4(m_worldView, m_projection);
+      m_worldViewVersion    = m_transformVersion;
+    }
+
+    if (worldView != nullptr)
+      *worldView = m_worldView;
+    if (worldViewProjection != nullptr)
+      *worldViewProjection = m_worldViewProjection;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::GetNormalMatrix(bool isLegacy, D3DMATRIX* normalMatrix) {
+    HRESULT hr = GetWorldViewMatrices(nullptr, nullptr);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // The matrix inversion is by far the most expensive part
+    if (m_normalVersion != m_transformVersion || m_normalIsLegacy != isLegacy) {
+      m_normalMatrix   = { };
+      ComputeNormalMatrix(m_normalMatrix, isLegacy, m_worldView);
+      m_normalVersion  = m_transformVersion;
+      m_normalIsLegacy = isLegacy;
+    }
+
+    *normalMatrix = m_normalMatrix;
+
+    return D3D_OK;
+  }
+
+  const std::vector<PVLIGHT>& D3DCommonDevice::GetProcessVerticesLights(D3DCommonViewport* viewport) {
+    const void* source = m_device7 != nullptr ? static_cast<const void*>(m_device7) : viewport;
+    const uint64_t lightsVersion = s_lightsVersion.load();
+
+    D3DMATRIX view;
+    if (unlikely(FAILED(GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), &view)))) {
+      Logger::err("D3DCommonDevice::GetProcessVerticesLights: Failed to get D3D9 view transform");
+      m_pvLights.clear();
+      m_pvLightsSource = nullptr;
+      return m_pvLights;
+    }
+
+    if (likely(source == m_pvLightsSource && lightsVersion == m_pvLightsVersion
+            && m_viewVersion == m_pvLightsViewVersion))
+      return m_pvLights;
+
+    // Clearing keeps the capacity around, so this only allocates
+    // when the number of enabled lights grows past its old peak
+    m_pvLights.clear();
+
+    PVLIGHT pvLight;
+
+    if (m_device7 != nullptr) {
+      m_device7->ForEachEnabledLight([&] (const d3d9::D3DLIGHT9& light9) {
+        if (ConvertLightToPVLight(view, light9, pvLight))
+          m_pvLights.push_back(pvLight);
+      });
+    } else if (viewport != nullptr) {
+      for (const Com<D3DLight>& light : viewport->GetLights()) {
+        if (light->IsActive() && ConvertLightToPVLight(view, *light->GetD3D9Light(), pvLight))
+          m_pvLights.push_back(pvLight);
+      }
+    }
+
+    m_pvLightsSource      = source;
+    m_pvLightsVersion     = lightsVersion;
+    m_pvLightsViewVersion = m_viewVersion;
+
+    return m_pvLights;
+  }
+
+  HRESULT D3DCommonDevice::SetFVF(DWORD fvf) {
+    FlushBatchedDraws();
+
+    if (likely(m_fvfValid && m_vertexDecl == nullptr && m_fvf == fvf && !m_recordingStateBlock))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->SetFVF(fvf);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    m_fvfValid   = true;
+    m_fvf        = fvf;
+    m_vertexDecl = nullptr;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SetVertexDeclaration(d3d9::IDirect3DVertexDeclaration9* decl) {
+    FlushBatchedDraws();
+
+    if (likely(m_fvfValid && m_vertexDecl == decl && !m_recordingStateBlock))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->SetVertexDeclaration(decl);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    m_fvfValid   = decl != nullptr;
+    m_fvf        = 0;
+    m_vertexDecl = decl;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SetStreamSource(UINT stream, d3d9::IDirect3DVertexBuffer9* vb, UINT offset, UINT stride) {
+    FlushBatchedDraws();
+
+    if (stream != 0)
+      return m_device9->SetStreamSource(stream, vb, offset, stride);
+
+    if (likely(m_stream0Valid && m_stream0VB == vb && m_stream0Offset == offset
+            && m_stream0Stride == stride && !m_recordingStateBlock))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->SetStreamSource(0, vb, offset, stride);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    m_stream0Valid  = true;
+    m_stream0VB     = vb;
+    m_stream0Offset = offset;
+    m_stream0Stride = stride;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SetIndices(d3d9::IDirect3DIndexBuffer9* ib) {
+    FlushBatchedDraws();
+
+    if (likely(m_indicesValid && m_indices == ib && !m_recordingStateBlock))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->SetIndices(ib);
+    if (unlikely(FAILED(hr) || m_recordingStateBlock))
+      return hr;
+
+    m_indicesValid = true;
+    m_indices      = ib;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SetStreamingVertices(DWORD fvf, const void* vertices, DWORD vertexCount, UINT* baseVertex) {
+    void* data = nullptr;
+
+    HRESULT hr = LockStreamingVertices(fvf, vertexCount, baseVertex, &data);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    memcpy(data, vertices, vertexCount * GetFVFSize(fvf));
+
+    return UnlockStreamingVertices(fvf, vertexCount);
+  }
+
+  HRESULT D3DCommonDevice::LockStreamingVertices(DWORD fvf, DWORD vertexCount, UINT* baseVertex, void** data) {
+    // Pending batched draws may wrap the buffer around once flushed
+    FlushBatchedDraws();
+
+    const UINT stride = GetFVFSize(fvf);
+    if (unlikely(!stride))
+      return DDERR_INVALIDPARAMS;
+
+    const UINT size = vertexCount * stride;
+
+    UINT offset = 0;
+
+    // Offsets are aligned to the stride, so that the stream binding
+    // can stay the same, with draws using a base vertex instead
+    HRESULT hr = LockStreamingVertexBuffer(size, stride, &offset, data);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    m_streamVBLocked = size;
+
+    *baseVertex = offset / stride;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::UnlockStreamingVertices(DWORD fvf, DWORD usedVertexCount) {
+    const UINT stride = GetFVFSize(fvf);
+
+    m_streamVB9->Unlock();
+
+    // Nothing else can have been written since locking
+    m_streamVBOffset -= m_streamVBLocked - std::min(usedVertexCount * stride, m_streamVBLocked);
+    m_streamVBLocked  = 0;
+
+    return BindStreamingVertices(fvf);
+  }
+
+  HRESULT D3DCommonDevice::BindStreamingVertices(DWORD fvf) {
+    if (unlikely(m_streamVB9 == nullptr))
+      return D3DERR_INVALIDCALL;
+
+    SetFVF(fvf);
+
+    return SetStreamSource(0, m_streamVB9.ptr(), 0, GetFVFSize(fvf));
+  }
+
+  HRESULT D3DCommonDevice::SetStridedVertexData(
+          DWORD fvf,
+    const D3DDRAWPRIMITIVESTRIDEDDATA* strided,
+          DWORD vertexCount) {
+    struct StridedComponent {
+      const void* data;
+      DWORD       stride;
+      UINT        size;
+    };
+
+    struct StridedStream {
+      uintptr_t   begin;
+      uintptr_t   end;
+      DWORD       stride;
+      UINT        offset;
+    };
+
+    // Offsets within a stream need to fit the layout encoding
+    static constexpr uintptr_t MaxStreamVertexSize = 1u << 12;
+
+    std::array<StridedComponent, StridedComponentCount> components = { };
+
+    components[0] = { strided->position.lpvData, strided->position.dwStride, UINT(GetFVFPositionSize(fvf)) };
+
+    if (fvf & D3DFVF_NORMAL)
+      components[1] = { strided->normal.lpvData, strided->normal.dwStride, 3 * sizeof(FLOAT) };
+    if (fvf & D3DFVF_DIFFUSE)
+      components[2] = { strided->diffuse.lpvData, strided->diffuse.dwStride, sizeof(D3DCOLOR) };
+    if (fvf & D3DFVF_SPECULAR)
+      components[3] = { strided->specular.lpvData, strided->specular.dwStride, sizeof(D3DCOLOR) };
+
+    const DWORD textureCount = std::min<DWORD>((fvf & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT, 8u);
+
+    for (DWORD t = 0; t < textureCount; t++) {
+      const D3DDP_PTRSTRIDE& texCoords = strided->textureCoords[t];
+      components[4 + t] = { texCoords.lpvData, texCoords.dwStride, UINT(GetFVFTexCoordSize(fvf, t)) };
+    }
+
+    std::array<StridedStream, StridedComponentCount> streams;
+    std::array<uint32_t, StridedComponentCount> componentStreams;
+    uint32_t streamCount = 0;
+
+    for (uint32_t i = 0; i < StridedComponentCount; i++) {
+      const StridedComponent& component = components[i];
+
+      if (component.data == nullptr || !component.size)
+        continue;
+
+      const uintptr_t begin = reinterpret_cast<uintptr_t>(component.data);
+      const uintptr_t end   = begin + component.size;
+
+      // Components interleaved within the same source vertex share a
+      // stream, so that their common span only gets uploaded once
+      uint32_t s = 0;
+
+      for (; s < streamCount; s++) {
+        StridedStream& stream = streams[s];
+
+        if (!stream.stride || stream.stride != component.stride)
+          continue;
+
+        const uintptr_t mergedBegin = std::min(stream.begin, begin);
+        const uintptr_t mergedEnd   = std::max(stream.end, end);
+
+        if (mergedEnd - mergedBegin <= std::min<uintptr_t>(stream.stride, MaxStreamVertexSize)) {
+          stream.begin = mergedBegin;
+          stream.end   = mergedEnd;
+          break;
+        }
+      }
+
+      if (s == streamCount)
+        streams[streamCount++] = { begin, end, component.stride, 0 };
+
+      componentStreams[i] = s;
+    }
+
+    if (unlikely(!streamCount))
+      return DDERR_INVALIDPARAMS;
+
+    D3DStridedLayout layout;
+    layout.fvf = fvf;
+
+    for (uint32_t i = 0; i < StridedComponentCount; i++) {
+      if (components[i].data == nullptr || !components[i].size)
+        continue;
+
+      const StridedStream& stream = streams[componentStreams[i]];
+      const uintptr_t offset = reinterpret_cast<uintptr_t>(components[i].data) - stream.begin;
+
+      layout.components[i] = uint16_t(((componentStreams[i] + 1) << 12) | offset);
+    }
+
+    // Each stream is a single contiguous copy of its source span
+    UINT totalSize = 0;
+
+    for (uint32_t s = 0; s < streamCount; s++) {
+      StridedStream& stream = streams[s];
+      stream.offset = totalSize;
+      totalSize += align(UINT((vertexCount - 1) * stream.stride + (stream.end - stream.begin)), 4u);
+    }
+
+    FlushBatchedDraws();
+
+    UINT  baseOffset = 0;
+    void* data       = nullptr;
+
+    HRESULT hr = LockStreamingVertexBuffer(totalSize, 4, &baseOffset, &data);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    for (uint32_t s = 0; s < streamCount; s++) {
+      const StridedStream& stream = streams[s];
+      const UINT size = (vertexCount - 1) * stream.stride + (stream.end - stream.begin);
+
+      memcpy(static_cast<uint8_t*>(data) + stream.offset, reinterpret_cast<const void*>(stream.begin), size);
+    }
+
+    m_streamVB9->Unlock();
+
+    d3d9::IDirect3DVertexDeclaration9* decl = GetStridedDeclaration(layout);
+    if (unlikely(decl == nullptr))
+      return DDERR_GENERIC;
+
+    SetVertexDeclaration(decl);
+
+    for (uint32_t s = 0; s < streamCount; s++)
+      SetStreamSource(s, m_streamVB9.ptr(), baseOffset + streams[s].offset, streams[s].stride);
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SetStreamingIndices(const WORD* indices, DWORD indexCount, UINT* startIndex) {
+    WORD* data = nullptr;
+
+    HRESULT hr = LockStreamingIndices(indexCount, startIndex, &data);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    memcpy(data, indices, indexCount * sizeof(WORD));
+
+    return UnlockStreamingIndices(indexCount);
+  }
+
+  HRESULT D3DCommonDevice::LockStreamingIndices(DWORD indexCount, UINT* startIndex, WORD** data) {
+    FlushBatchedDraws();
+
+    const UINT size = indexCount * sizeof(WORD);
+
+    UINT offset = 0;
+
+    HRESULT hr = LockStreamingIndexBuffer(size, &offset, reinterpret_cast<void**>(data));
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    m_streamIBLocked = size;
+
+    *startIndex = offset / sizeof(WORD);
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::UnlockStreamingIndices(DWORD usedIndexCount) {
+    m_streamIB9->Unlock();
+
+    m_streamIBOffset -= m_streamIBLocked - std::min<UINT>(usedIndexCount * sizeof(WORD), m_streamIBLocked);
+    m_streamIBLocked  = 0;
+
+    return SetIndices(m_streamIB9.ptr());
+  }
+
+  bool D3DCommonDevice::BatchDraw(
+    const D3DBatchState&   state,
+          D3DPRIMITIVETYPE type,
+    const void*            vertices,
+          DWORD            vertexCount,
+    const WORD*            indices,
+          DWORD            indexCount) {
+    // Batched draws may depend on the results of queued blits
+    FlushQueuedBlts();
+
+    if (!D3DBatcher::CanBatch(type, vertexCount) || unlikely(!GetFVFSize(state.fvf))) {
+      FlushBatchedDraws();
+      return false;
+    }
+
+    if (!m_batcher->IsCompatible(state, vertexCount))
+      SubmitBatchedDraws();
+
+    m_batcher->AddDraw(state, type, vertices, vertexCount, indices, indexCount);
+
+    return true;
+  }
+
+  HRESULT D3DCommonDevice::QueueBlt(
+          d3d9::IDirect3DSurface9* destSurface,
+    const RECT&                    destRect,
+          d3d9::IDirect3DSurface9* srcSurface,
+          d3d9::IDirect3DTexture9* srcTexture,
+    const RECT&                    srcRect,
+    const DDCOLORKEY*              colorKey) {
+    // Nothing may end up in a state block being recorded by the application
+    if (unlikely(m_recordingStateBlock))
+      return D3DERR_INVALIDCALL;
+
+    // Queued blits may depend on the results of previously batched draws
+    if (unlikely(m_batcher != nullptr && !m_batcher->IsEmpty()))
+      SubmitBatchedDraws();
+
+    const bool colorKeyed = colorKey != nullptr;
+
+    const bool isCompatible = m_bltDest9.ptr() == destSurface
+                           && m_bltColorKeyed  == colorKeyed
+                           && (!colorKeyed || (m_bltColorKey.dwColorSpaceLowValue  == colorKey->dwColorSpaceLowValue
+                                            && m_bltColorKey.dwColorSpaceHighValue == colorKey->dwColorSpaceHighValue))
+                           && m_bltSource9.ptr() == (srcTexture != nullptr ? srcTexture : m_bltTexture9.ptr())
+                           && m_bltVertices.size() < MaxQueuedBltVertexCount;
+    if (!isCompatible)
+      FlushQueuedBlts();
+
+    RECT texRect = srcRect;
+
+    // Copy the source rect to the next free spot in the atlas, which
+    // also keeps its contents as they are at the time of the blit
+    if (srcTexture == nullptr) {
+      const UINT width  = UINT(srcRect.right  - srcRect.left);
+      const UINT height = UINT(srcRect.bottom - srcRect.top);
+
+      d3d9::D3DSURFACE_DESC srcDesc9;
+      srcSurface->GetDesc(&srcDesc9);
+
+      d3d9::D3DSURFACE_DESC atlasDesc9 = { };
+      if (m_bltTexture9 != nullptr)
+        m_bltTexture9->GetLevelDesc(0, &atlasDesc9);
+
+      if (m_bltAtlasX + width > atlasDesc9.Width) {
+        m_bltAtlasX  = 0;
+        m_bltAtlasY += m_bltAtlasRowHeight;
+        m_bltAtlasRowHeight = 0;
+      }
+
+      if (atlasDesc9.Format != srcDesc9.Format || m_bltAtlasX + width > atlasDesc9.Width
+                                               || m_bltAtlasY + height > atlasDesc9.Height) {
+        FlushQueuedBlts();
+
+        srcTexture = GetBltScratchTexture(width, height, srcDesc9.Format);
+        if (unlikely(srcTexture == nullptr))
+          return D3DERR_INVALIDCALL;
+
+        m_bltAtlasX         = 0;
+        m_bltAtlasY         = 0;
+        m_bltAtlasRowHeight = 0;
+      } else {
+        srcTexture = m_bltTexture9.ptr();
+      }
+
+      texRect = { LONG(m_bltAtlasX), LONG(m_bltAtlasY),
+                  LONG(m_bltAtlasX + width), LONG(m_bltAtlasY + height) };
+
+      Com<d3d9::IDirect3DSurface9> atlas9;
+      srcTexture->GetSurfaceLevel(0, &atlas9);
+
+      HRESULT hr = m_device9->StretchRect(srcSurface, &srcRect, atlas9.ptr(), &texRect, d3d9::D3DTEXF_NONE);
+
+      // StretchRect won't work with SYSTEMMEM sources, but UpdateSurface will
+      if (FAILED(hr)) {
+        const POINT destPoint = { texRect.left, texRect.top };
+        hr = m_device9->UpdateSurface(srcSurface, &srcRect, atlas9.ptr(), &destPoint);
+      }
+
+      if (unlikely(FAILED(hr)))
+        return hr;
+
+      m_bltAtlasX        += width;
+      m_bltAtlasRowHeight = std::max(m_bltAtlasRowHeight, height);
+    }
+
+    if (m_bltVertices.empty()) {
+      m_bltDest9      = destSurface;
+      m_bltSource9    = srcTexture;
+      m_bltColorKeyed = colorKeyed;
+      m_bltColorKey   = colorKeyed ? *colorKey : DDCOLORKEY{ };
+    }
+
+    d3d9::D3DSURFACE_DESC texDesc9;
+    srcTexture->GetLevelDesc(0, &texDesc9);
+
+    const float u0 = float(texRect.left)   / float(texDesc9.Width);
+    const float v0 = float(texRect.top)    / float(texDesc9.Height);
+    const float u1 = float(texRect.right)  / float(texDesc9.Width);
+    const float v1 = float(texRect.bottom) / float(texDesc9.Height);
+
+    // Texels need to line up with pixel centers, which the
+    // alternate pixel center option already takes care of
+    const float offset = m_commonIntf->GetOptions()->alternatePixelCenter == AlternatePixelCenter::Enabled ? 0.0f : -0.5f;
+
+    const float x0 = float(destRect.left)   + offset;
+    const float y0 = float(destRect.top)    + offset;
+    const float x1 = float(destRect.right)  + offset;
+    const float y1 = float(destRect.bottom) + offset;
+
+    m_bltVertices.push_back({ x0, y0, 0.0f, 1.0f, u0, v0 });
+    m_bltVertices.push_back({ x1, y0, 0.0f, 1.0f, u1, v0 });
+    m_bltVertices.push_back({ x0, y1, 0.0f, 1.0f, u0, v1 });
+    m_bltVertices.push_back({ x0, y1, 0.0f, 1.0f, u0, v1 });
+    m_bltVertices.push_back({ x1, y0, 0.0f, 1.0f, u1, v0 });
+    m_bltVertices.push_back({ x1, y1, 0.0f, 1.0f, u1, v1 });
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SubmitQueuedBlts() {
+    struct BltRenderState {
+      d3d9::D3DRENDERSTATETYPE       type;
+      DWORD                          value;
+    };
+
+    struct BltTextureStageState {
+      DWORD                          stage;
+      d3d9::D3DTEXTURESTAGESTATETYPE type;
+      DWORD                          value;
+    };
+
+    struct BltSamplerState {
+      d3d9::D3DSAMPLERSTATETYPE      type;
+      DWORD                          value;
+    };
+
+    // Everything the quads depend on, all of which gets restored afterwards
+    static constexpr BltRenderState BltRenderStates[] = {
+      { d3d9::D3DRS_ZENABLE,          FALSE               },
+      { d3d9::D3DRS_STENCILENABLE,    FALSE               },
+      { d3d9::D3DRS_ALPHATESTENABLE,  FALSE               },
+      { d3d9::D3DRS_ALPHABLENDENABLE, FALSE               },
+      { d3d9::D3DRS_FOGENABLE,        FALSE               },
+      { d3d9::D3DRS_SPECULARENABLE,   FALSE               },
+      { d3d9::D3DRS_CULLMODE,         d3d9::D3DCULL_NONE  },
+      { d3d9::D3DRS_FILLMODE,         d3d9::D3DFILL_SOLID },
+    };
+
+    static constexpr BltTextureStageState BltTextureStageStates[] = {
+      { 0, d3d9::D3DTSS_COLOROP,               d3d9::D3DTOP_SELECTARG1 },
+      { 0, d3d9::D3DTSS_COLORARG1,             D3DTA_TEXTURE           },
+      { 0, d3d9::D3DTSS_ALPHAOP,               d3d9::D3DTOP_SELECTARG1 },
+      { 0, d3d9::D3DTSS_ALPHAARG1,             D3DTA_TEXTURE           },
+      { 0, d3d9::D3DTSS_TEXCOORDINDEX,         0                       },
+      { 0, d3d9::D3DTSS_TEXTURETRANSFORMFLAGS, d3d9::D3DTTFF_DISABLE   },
+      { 1, d3d9::D3DTSS_COLOROP,               d3d9::D3DTOP_DISABLE    },
+    };
+
+    // DDraw stretching is expected to use point sampling
+    static constexpr BltSamplerState BltSamplerStates[] = {
+      { d3d9::D3DSAMP_ADDRESSU,    d3d9::D3DTADDRESS_CLAMP },
+      { d3d9::D3DSAMP_ADDRESSV,    d3d9::D3DTADDRESS_CLAMP },
+      { d3d9::D3DSAMP_MAGFILTER,   d3d9::D3DTEXF_POINT     },
+      { d3d9::D3DSAMP_MINFILTER,   d3d9::D3DTEXF_POINT     },
+      { d3d9::D3DSAMP_MIPFILTER,   d3d9::D3DTEXF_NONE      },
+      { d3d9::D3DSAMP_MAXMIPLEVEL, 0                       },
+    };
+
+    // Take the vertices out of the queue, since the streaming
+    // and viewport calls below would otherwise flush it again
+    std::vector<D3DBltVertex> vertices;
+    vertices.swap(m_bltVertices);
+
+    Com<d3d9::IDirect3DSurface9> destSurface = std::move(m_bltDest9);
+    Com<d3d9::IDirect3DTexture9> srcTexture  = std::move(m_bltSource9);
+
+    // Either way, the atlas space used by the queue is done with
+    m_bltAtlasX         = 0;
+    m_bltAtlasY         = 0;
+    m_bltAtlasRowHeight = 0;
+
+    Com<IDxvkLegacyD3DDeviceBridge> bridge;
+    if (unlikely(FAILED(m_device9->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&bridge))))) {
+      Logger::err("D3DCommonDevice::SubmitQueuedBlts: Failed to get D3D9 Bridge");
+      vertices.clear();
+      m_bltVertices.swap(vertices);
+      return DDERR_GENERIC;
+    }
+
+    UINT baseVertex = 0;
+    HRESULT hr = SetStreamingVertices(D3DFVF_XYZRHW | D3DFVF_TEX1, vertices.data(), DWORD(vertices.size()), &baseVertex);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SubmitQueuedBlts: Failed to upload blit vertices");
+      vertices.clear();
+      m_bltVertices.swap(vertices);
+      return hr;
+    }
+
+    // D3D9 resets the viewport along with the render target
+    d3d9::D3DVIEWPORT9 viewport9;
+    GetViewport(&viewport9);
+
+    Com<d3d9::IDirect3DSurface9> renderTarget;
+    m_device9->GetRenderTarget(0, &renderTarget);
+    m_device9->SetRenderTarget(0, destSurface.ptr());
+
+    std::array<DWORD, std::size(BltRenderStates)>       renderStates;
+    std::array<DWORD, std::size(BltTextureStageStates)> textureStageStates;
+    std::array<DWORD, std::size(BltSamplerStates)>      samplerStates;
+
+    for (size_t i = 0; i < renderStates.size(); i++) {
+      m_device9->GetRenderState(BltRenderStates[i].type, &renderStates[i]);
+      m_device9->SetRenderState(BltRenderStates[i].type, BltRenderStates[i].value);
+    }
+
+    for (size_t i = 0; i < textureStageStates.size(); i++) {
+      const BltTextureStageState& tss = BltTextureStageStates[i];
+      m_device9->GetTextureStageState(tss.stage, tss.type, &textureStageStates[i]);
+      m_device9->SetTextureStageState(tss.stage, tss.type, tss.value);
+    }
+
+    for (size_t i = 0; i < samplerStates.size(); i++) {
+      m_device9->GetSamplerState(0, BltSamplerStates[i].type, &samplerStates[i]);
+      m_device9->SetSamplerState(0, BltSamplerStates[i].type, BltSamplerStates[i].value);
+    }
+
+    Com<d3d9::IDirect3DBaseTexture9> texture;
+    m_device9->GetTexture(0, &texture);
+    m_device9->SetTexture(0, srcTexture.ptr());
+
+    // The fixed function pixel shader discards texels within the key range
+    bool  colorKeyState = false;
+    DWORD colorKeyLow   = 0;
+    DWORD colorKeyHigh  = 0;
+    bridge->GetColorKeyState(&colorKeyState);
+    bridge->GetColorKey(&colorKeyLow, &colorKeyHigh);
+
+    bridge->SetColorKeyState(m_bltColorKeyed);
+    if (m_bltColorKeyed)
+      bridge->SetColorKey(m_bltColorKey.dwColorSpaceLowValue, m_bltColorKey.dwColorSpaceHighValue);
+
+    hr = m_device9->DrawPrimitive(d3d9::D3DPT_TRIANGLELIST, baseVertex, UINT(vertices.size() / 3));
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3DCommonDevice::SubmitQueuedBlts: Failed D3D9 call to DrawPrimitive");
+
+    bridge->SetColorKeyState(colorKeyState);
+    bridge->SetColorKey(colorKeyLow, colorKeyHigh);
+
+    m_device9->SetTexture(0, texture.ptr());
+
+    for (size_t i = 0; i < samplerStates.size(); i++)
+      m_device9->SetSamplerState(0, BltSamplerStates[i].type, samplerStates[i]);
+
+    for (size_t i = 0; i < textureStageStates.size(); i++)
+      m_device9->SetTextureStageState(BltTextureStageStates[i].stage, BltTextureStageStates[i].type, textureStageStates[i]);
+
+    for (size_t i = 0; i < renderStates.size(); i++)
+      m_device9->SetRenderState(BltRenderStates[i].type, renderStates[i]);
+
+    m_device9->SetRenderTarget(0, renderTarget.ptr());
+    SetViewport(&viewport9);
+
+    // Hand the storage back to the queue, keeping its capacity around
+    vertices.clear();
+    m_bltVertices.swap(vertices);
+
+    return hr;
+  }
+
+  d3d9::IDirect3DTexture9* D3DCommonDevice::GetBltScratchTexture(UINT width, UINT height, d3d9::D3DFORMAT format) {
+    // Large enough to hold plenty of typical sprites at once
+    width  = std::max(width,  MinBltAtlasSize);
+    height = std::max(height, MinBltAtlasSize);
+
+    if (m_bltTexture9 != nullptr) {
+      d3d9::D3DSURFACE_DESC desc9;
+      m_bltTexture9->GetLevelDesc(0, &desc9);
+
+      if (desc9.Format == format && desc9.Width >= width && desc9.Height >= height)
+        return m_bltTexture9.ptr();
+
+      // Only ever grow the texture, to avoid flip-flopping between sizes
+      if (desc9.Format == format) {
+        width  = std::max<UINT>(width,  desc9.Width);
+        height = std::max<UINT>(height, desc9.Height);
+      }
+
+      m_bltTexture9 = nullptr;
+    }
+
+    HRESULT hr = m_device9->CreateTexture(width, height, 1, D3DUSAGE_RENDERTARGET,
+                                          format, d3d9::D3DPOOL_DEFAULT, &m_bltTexture9, nullptr);
+    if (unlikely(FAILED(hr))) {
+      Logger::warn("D3DCommonDevice::GetBltScratchTexture: Failed to create scratch texture");
+      return nullptr;
+    }
+
+    return m_bltTexture9.ptr();
+  }
+
+  HRESULT D3DCommonDevice::SubmitBatchedDraws() {
+    const D3DBatchState state = m_batcher->GetState();
+
+    const UINT  stride         = m_batcher->GetStride();
+    const DWORD vertexCount    = m_batcher->GetVertexCount();
+    const UINT  primitiveCount = m_batcher->GetPrimitiveCount();
+    const std::vector<WORD>& indices = m_batcher->GetIndices();
+
+    UINT  vertexOffset = 0;
+    UINT  indexOffset  = 0;
+    void* data         = nullptr;
+
+    HRESULT hr = LockStreamingVertexBuffer(vertexCount * stride, stride, &vertexOffset, &data);
+    if (likely(SUCCEEDED(hr))) {
+      memcpy(data, m_batcher->GetVertexData(), vertexCount * stride);
+      m_streamVB9->Unlock();
+
+      hr = LockStreamingIndexBuffer(UINT(indices.size() * sizeof(WORD)), &indexOffset, &data);
+      if (likely(SUCCEEDED(hr))) {
+        memcpy(data, indices.data(), indices.size() * sizeof(WORD));
+        m_streamIB9->Unlock();
+      }
+    }
+
+    // The batch needs to be empty before touching any state,
+    // since state changes will otherwise try to flush it again
+    m_batcher->Reset();
+
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SubmitBatchedDraws: Failed to upload batched draws");
+      return hr;
+    }
+
+    SetFVF(state.fvf);
+    SetStreamSource(0, m_streamVB9.ptr(), 0, stride);
+    SetIndices(m_streamIB9.ptr());
+
+    D3DMATRIX projection;
+
+    if (state.disableLighting)
+      m_device9->SetRenderState(d3d9::D3DRS_LIGHTING, FALSE);
+
+    if (state.useLegacyProjection) {
+      GetTransform(d3d9::D3DTS_PROJECTION, &projection);
+      MultiplyTransform(d3d9::D3DTS_PROJECTION, &state.legacyProjection);
+    }
+
+    hr = m_device9->DrawIndexedPrimitive(
+                      d3d9::D3DPRIMITIVETYPE(state.listType),
+                      vertexOffset / stride,
+                      0,
+                      vertexCount,
+                      indexOffset / sizeof(WORD),
+                      primitiveCount);
+
+    if (state.disableLighting)
+      m_device9->SetRenderState(d3d9::D3DRS_LIGHTING, TRUE);
+
+    if (state.useLegacyProjection)
+      SetTransform(d3d9::D3DTS_PROJECTION, &projection);
+
+    if (unlikely(FAILED(hr)))
+      Logger::err("D3DCommonDevice::SubmitBatchedDraws: Failed D3D9 call to DrawIndexedPrimitive");
+
+    return hr;
+  }
+
+  HRESULT D3DCommonDevice::LockStreamingIndexBuffer(UINT size, UINT* offset, void** data) {
+    DWORD lockFlags = D3DLOCK_NOOVERWRITE;
+
+    if (unlikely(size > m_streamIBSize)) {
+      UINT newSize = std::max(m_streamIBSize, ddrawCaps::StreamingIndexBufferSize);
+      while (newSize < size)
+        newSize *= 2;
+
+      m_streamIB9      = nullptr;
+      m_streamIBSize   = 0;
+      m_streamIBOffset = 0;
+
+      HRESULT hr = m_device9->CreateIndexBuffer(newSize, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,
+                                                d3d9::D3DFMT_INDEX16, d3d9::D3DPOOL_DEFAULT, &m_streamIB9, nullptr);
+      if (unlikely(FAILED(hr))) {
+        Logger::err("D3DCommonDevice::LockStreamingIndexBuffer: Failed to create D3D9 index buffer");
+        return hr;
+      }
+
+      m_streamIBSize = newSize;
+      lockFlags      = D3DLOCK_DISCARD;
+    } else if (m_streamIBOffset + size > m_streamIBSize) {
+      // Only discard once the whole buffer has been used up
+      m_streamIBOffset = 0;
+      lockFlags        = D3DLOCK_DISCARD;
+    }
+
+    HRESULT hr = m_streamIB9->Lock(m_streamIBOffset, size, data, lockFlags);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::LockStreamingIndexBuffer: Failed to lock D3D9 index buffer");
+      return hr;
+    }
+
+    *offset = m_streamIBOffset;
+    m_streamIBOffset += size;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::LockStreamingVertexBuffer(UINT size, UINT alignment, UINT* offset, void** data) {
+    DWORD lockFlags = D3DLOCK_NOOVERWRITE;
+
+    // Alignment is not necessarily a power of two, as vertex strides are used
+    UINT alignedOffset = ((m_streamVBOffset + alignment - 1) / alignment) * alignment;
+
+    if (unlikely(size > m_streamVBSize)) {
+      UINT newSize = std::max(m_streamVBSize, ddrawCaps::StreamingVertexBufferSize);
+      while (newSize < size)
+        newSize *= 2;
+
+      m_streamVB9      = nullptr;
+      m_streamVBSize   = 0;
+      m_streamVBOffset = 0;
+
+      HRESULT hr = m_device9->CreateVertexBuffer(newSize, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, 0,
+                                                 d3d9::D3DPOOL_DEFAULT, &m_streamVB9, nullptr);
+      if (unlikely(FAILED(hr))) {
+        Logger::err("D3DCommonDevice::LockStreamingVertexBuffer: Failed to create D3D9 vertex buffer");
+        return hr;
+      }
+
+      m_streamVBSize = newSize;
+      alignedOffset  = 0;
+      lockFlags      = D3DLOCK_DISCARD;
+    } else if (alignedOffset + size > m_streamVBSize) {
+      // Only discard once the whole buffer has been used up
+      alignedOffset = 0;
+      lockFlags     = D3DLOCK_DISCARD;
+    }
+
+    if (lockFlags == D3DLOCK_DISCARD)
+      m_streamVBDiscards++;
+
+    HRESULT hr = m_streamVB9->Lock(alignedOffset, size, data, lockFlags);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::LockStreamingVertexBuffer: Failed to lock D3D9 vertex buffer");
+      return hr;
+    }
+
+    *offset = alignedOffset;
+    m_streamVBOffset = alignedOffset + size;
+
+    return D3D_OK;
+  }
+
+  d3d9::IDirect3DVertexDeclaration9* D3DCommonDevice::GetStridedDeclaration(const D3DStridedLayout& layout) {
+    auto entry = m_stridedDecls.find(layout);
+    if (likely(entry != m_stridedDecls.end()))
+      return entry->second.ptr();
+
+    std::array<d3d9::D3DVERTEXELEMENT9, StridedComponentCount + 2> elements;
+    uint32_t elementCount = 0;
+
+    auto addElement = [&] (uint32_t component, WORD offset, BYTE type, BYTE usage, BYTE usageIndex) {
+      const uint16_t encoded = layout.components[component];
+
+      if (encoded) {
+        elements[elementCount++] = { WORD((encoded >> 12) - 1), WORD((encoded & 0xFFF) + offset),
+                                     type, d3d9::D3DDECLMETHOD_DEFAULT, usage, usageIndex };
+      }
+    };
+
+    const DWORD position = layout.fvf & D3DFVF_POSITION_MASK;
+
+    if (position == D3DFVF_XYZRHW) {
+      addElement(0, 0, d3d9::D3DDECLTYPE_FLOAT4, d3d9::D3DDECLUSAGE_POSITIONT, 0);
+    } else {
+      addElement(0, 0, d3d9::D3DDECLTYPE_FLOAT3, d3d9::D3DDECLUSAGE_POSITION, 0);
+
+      // Blend weights are part of the position component
+      if (position >= D3DFVF_XYZB1 && position <= D3DFVF_XYZB5) {
+        const DWORD weights = std::min<DWORD>((position - D3DFVF_XYZB1) / 2 + 1, 4u);
+        addElement(0, 3 * sizeof(FLOAT), d3d9::D3DDECLTYPE_FLOAT1 + weights - 1, d3d9::D3DDECLUSAGE_BLENDWEIGHT, 0);
+      }
+    }
+
+    addElement(1, 0, d3d9::D3DDECLTYPE_FLOAT3,   d3d9::D3DDECLUSAGE_NORMAL, 0);
+    addElement(2, 0, d3d9::D3DDECLTYPE_D3DCOLOR, d3d9::D3DDECLUSAGE_COLOR,  0);
+    addElement(3, 0, d3d9::D3DDECLTYPE_D3DCOLOR, d3d9::D3DDECLUSAGE_COLOR,  1);
+
+    for (uint32_t t = 0; t < 8; t++) {
+      const UINT floatCount = GetFVFTexCoordSize(layout.fvf, t) / sizeof(FLOAT);
+      addElement(4 + t, 0, d3d9::D3DDECLTYPE_FLOAT1 + floatCount - 1, d3d9::D3DDECLUSAGE_TEXCOORD, t);
+    }
+
+    elements[elementCount++] = { 0xFF, 0, d3d9::D3DDECLTYPE_UNUSED, 0, 0, 0 };
+
+    Com<d3d9::IDirect3DVertexDeclaration9> decl;
+    HRESULT hr = m_device9->CreateVertexDeclaration(elements.data(), &decl);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::GetStridedDeclaration: Failed to create D3D9 vertex declaration");
+      return nullptr;
+    }
+
+    return m_stridedDecls.emplace(layout, std::move(decl)).first->second.ptr();
+  }
+
+  HRESULT D3DCommonDevice::SyncTransforms() {
+    if (likely(m_transformsValid))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), &m_world);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SyncTransforms: Failed to get D3D9 world transform");
+      return hr;
+    }
+    hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), &m_view);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SyncTransforms: Failed to get D3D9 view transform");
+      return hr;
+    }
+    hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), &m_projection);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SyncTransforms: Failed to get D3D9 projection transform");
+      return hr;
+    }
+
+    m_transformsValid = true;
+    m_transformVersion++;
+    m_viewVersion++;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DCommonDevice::SyncViewport() {
+    if (likely(m_viewportValid))
+      return D3D_OK;
+
+    HRESULT hr = m_device9->GetViewport(&m_viewport9);
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DCommonDevice::SyncViewport: Failed to get D3D9 viewport");
+      return hr;
+    }
+
+    m_viewportValid = true;
+
+    return D3D_OK;
+  }
+
+  D3DMATRIX* D3DCommonDevice::GetMirroredTransform(d3d9::D3DTRANSFORMSTATETYPE state) {
+    if (state == ConvertTransformState(D3DTRANSFORMSTATE_WORLD))
+      return &m_world;
+    if (state == ConvertTransformState(D3DTRANSFORMSTATE_VIEW))
+      return &m_view;
+    if (state == ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION))
+      return &m_projection;
+
+    return nullptr;
+  }
+
 }
\ No newline at end of file
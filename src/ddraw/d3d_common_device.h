@@ -2,11 +2,22 @@
 
 #include "ddraw_include.h"
 
+#include "d3d_batch.h"
+#include "d3d_worker_pool.h"
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
 namespace dxvk {
 
+  struct PVLIGHT;
+
   class DDrawCommonSurface;
   class DDrawCommonInterface;
   class D3DCommonInterface;
+  class D3DCommonViewport;
 
   class DDraw7Surface;
   class DDraw4Surface;
@@ -17,6 +28,40 @@ namespace dxvk {
   class D3D5Device;
   class D3D3Device;
 
+  // Position, normal, diffuse, specular and 8 texture coordinate sets
+  static constexpr uint32_t StridedComponentCount = 12;
+
+  /**
+   * \brief Strided vertex layout
+   *
+   * Identifies the D3D9 vertex declaration of a strided draw. Each
+   * present component is encoded as its stream index + 1 in the top
+   * 4 bits, and its offset within that stream in the low 12 bits.
+   */
+  struct D3DStridedLayout {
+    DWORD fvf = 0;
+    std::array<uint16_t, StridedComponentCount> components = { };
+
+    bool operator == (const D3DStridedLayout& other) const {
+      return fvf == other.fvf && components == other.components;
+    }
+  };
+
+  struct D3DStridedLayoutHash {
+    size_t operator () (const D3DStridedLayout& layout) const {
+      size_t hash = layout.fvf;
+      for (uint16_t component : layout.components)
+        hash = hash * 31 + component;
+      return hash;
+    }
+  };
+
+  // D3DFVF_XYZRHW | D3DFVF_TEX1
+  struct D3DBltVertex {
+    float x, y, z, rhw;
+    float u, v;
+  };
+
   class D3DCommonDevice : public ComObjectClamp<IUnknown> {
 
   public:
@@ -38,6 +83,9 @@ namespace dxvk {
 
     HRESULT ResetD3D9Swapchain(d3d9::D3DPRESENT_PARAMETERS* params);
 
+    // Switches between VSync and immediate presentation, without a swapchain reset
+    HRESULT SetPresentationInterval(DWORD presentationInterval);
+
     DDrawSurface* GetCurrentRenderTarget() const;
 
     DDraw4Surface* GetCurrentRenderTarget4() const;
@@ -146,7 +194,31 @@ namespace dxvk {
     }
 
     void SetD3D9Device(Com<d3d9::IDirect3DDevice9>&& device9) {
+      // Pending draws can not outlive the previous D3D9 device
+      if (m_batcher != nullptr)
+        m_batcher->Reset();
+
       m_device9 = device9;
+
+      // Streaming resources belong to the previous D3D9 device
+      m_streamVB9      = nullptr;
+      m_streamVBSize   = 0;
+      m_streamVBOffset = 0;
+      m_streamVBDiscards++;
+      m_streamIB9      = nullptr;
+      m_streamIBSize   = 0;
+      m_streamIBOffset = 0;
+      m_stridedDecls.clear();
+
+      // Queued blits as well
+      m_bltVertices.clear();
+      m_bltDest9       = nullptr;
+      m_bltSource9     = nullptr;
+      m_bltTexture9    = nullptr;
+
+      InvalidateVertexInput();
+      InvalidateTransforms();
+      InvalidateViewport();
     }
 
     d3d9::IDirect3DDevice9* GetD3D9Device() const {
@@ -193,8 +265,190 @@ namespace dxvk {
       return m_origin;
     }
 
+    D3DWorkerPool* GetWorkerPool() const {
+      return m_workerPool.ptr();
+    }
+
+    HRESULT SetTransform(d3d9::D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix);
+
+    HRESULT GetTransform(d3d9::D3DTRANSFORMSTATETYPE state, D3DMATRIX* matrix);
+
+    HRESULT MultiplyTransform(d3d9::D3DTRANSFORMSTATETYPE state, const D3DMATRIX* matrix);
+
+    HRESULT SetViewport(const d3d9::D3DVIEWPORT9* viewport);
+
+    HRESULT GetViewport(d3d9::D3DVIEWPORT9* viewport);
+
+    HRESULT GetWorldViewMatrices(D3DMATRIX* worldView, D3DMATRIX* worldViewProjection);
+
+    HRESULT GetNormalMatrix(bool isLegacy, D3DMATRIX* normalMatrix);
+
+    // Bumped whenever the world, view or projection transforms change
+    uint64_t GetTransformVersion() const {
+      return m_transformVersion;
+    }
+
+    // D3D9 only records state changes while a state block is being
+    // recorded, so the mirrored state must be left untouched
+    void SetRecordingStateBlock(bool recording) {
+      m_recordingStateBlock = recording;
+    }
+
+    // Queues a blit of the source rect onto the destination rect of the render
+    // target surface, optionally discarding texels within the color key range.
+    // Sources without a texture get copied to a scratch atlas right away. All
+    // consecutive blits sharing the same target, texture and color key get
+    // drawn together, as a single textured quad list.
+    HRESULT QueueBlt(
+            d3d9::IDirect3DSurface9* destSurface,
+      const RECT&                    destRect,
+            d3d9::IDirect3DSurface9* srcSurface,
+            d3d9::IDirect3DTexture9* srcTexture,
+      const RECT&                    srcRect,
+      const DDCOLORKEY*              colorKey);
+
+    // Needs to be called before anything else which depends on the
+    // results of queued blits, which FlushBatchedDraws also covers
+    void FlushQueuedBlts() {
+      if (unlikely(!m_bltVertices.empty()))
+        SubmitQueuedBlts();
+    }
+
+    // Returns the enabled lights of the D3D7 device, or of the given
+    // viewport for earlier versions, digested for software vertex
+    // processing. Only gets rebuilt on light or view transform changes.
+    const std::vector<PVLIGHT>& GetProcessVerticesLights(D3DCommonViewport* viewport);
+
+    // Needs to be called on any change to the set of lights or their
+    // properties, for any device, since lights may be shared
+    static void InvalidateLights() {
+      s_lightsVersion++;
+    }
+
+    // Needs to be called whenever D3D9 transforms change behind
+    // our back, such as when applying state blocks
+    void InvalidateTransforms() {
+      m_transformsValid = false;
+      m_transformVersion++;
+      m_viewVersion++;
+    }
+
+    // D3D9 resets the viewport when setting a render target
+    void InvalidateViewport() {
+      m_viewportValid = false;
+    }
+
+    // Needs to be called whenever D3D9 vertex input state changes
+    // behind our back, such as when applying state blocks
+    void InvalidateVertexInput() {
+      m_fvfValid     = false;
+      m_stream0Valid = false;
+      m_indicesValid = false;
+    }
+
+    // The following skip any D3D9 calls which would not change
+    // the current vertex input state, outside of state block
+    // recording. All D3D9 vertex input changes need to go
+    // through these, or the mirrored state needs invalidation.
+    HRESULT SetFVF(DWORD fvf);
+
+    HRESULT SetVertexDeclaration(d3d9::IDirect3DVertexDeclaration9* decl);
+
+    HRESULT SetStreamSource(UINT stream, d3d9::IDirect3DVertexBuffer9* vb, UINT offset, UINT stride);
+
+    HRESULT SetIndices(d3d9::IDirect3DIndexBuffer9* ib);
+
+    // Uploads vertices to the streaming vertex buffer and binds it along
+    // with the FVF. Draws need to start at the returned base vertex, which
+    // lets consecutive draws share the same binding.
+    HRESULT SetStreamingVertices(DWORD fvf, const void* vertices, DWORD vertexCount, UINT* baseVertex);
+
+    // Reserves space for vertices in the streaming vertex buffer, to be
+    // written to directly. Only one reservation may be pending at a time.
+    HRESULT LockStreamingVertices(DWORD fvf, DWORD vertexCount, UINT* baseVertex, void** data);
+
+    // Ends the pending reservation, giving back any unused space, and
+    // binds the streaming vertex buffer along with the FVF
+    HRESULT UnlockStreamingVertices(DWORD fvf, DWORD usedVertexCount);
+
+    // Binds the streaming vertex buffer along with the FVF, for
+    // drawing vertices which have been uploaded to it earlier
+    HRESULT BindStreamingVertices(DWORD fvf);
+
+    // Bumped whenever the streaming vertex buffer gets discarded, after
+    // which any vertices uploaded to it earlier are no longer valid
+    uint64_t GetStreamingVertexDiscards() const {
+      return m_streamVBDiscards;
+    }
+
+    // Uploads strided vertex data with one D3D9 stream per component,
+    // or per group of interleaved components, and binds a matching
+    // vertex declaration. Vertices start at index 0 of the streams.
+    HRESULT SetStridedVertexData(
+            DWORD fvf,
+      const D3DDRAWPRIMITIVESTRIDEDDATA* strided,
+            DWORD vertexCount);
+
+    // Uploads indices to the streaming index buffer and binds it. Draws
+    // need to start at the returned index, since the buffer is a ring.
+    HRESULT SetStreamingIndices(const WORD* indices, DWORD indexCount, UINT* startIndex);
+
+    // Same as the above, for the streaming index buffer
+    HRESULT LockStreamingIndices(DWORD indexCount, UINT* startIndex, WORD** data);
+
+    HRESULT UnlockStreamingIndices(DWORD usedIndexCount);
+
+    bool ShouldBatch() const {
+      return m_batcher != nullptr;
+    }
+
+    // Adds a draw to the pending batch, flushing it first if the draw
+    // can not be merged. Returns false if the draw can not be batched
+    // at all, in which case it needs to be submitted as usual.
+    bool BatchDraw(
+      const D3DBatchState&   state,
+            D3DPRIMITIVETYPE type,
+      const void*            vertices,
+            DWORD            vertexCount,
+      const WORD*            indices,
+            DWORD            indexCount);
+
+    // Needs to be called before any state change, or before anything
+    // else which depends on the results of previous draws
+    void FlushBatchedDraws() {
+      if (unlikely(m_batcher != nullptr && !m_batcher->IsEmpty()))
+        SubmitBatchedDraws();
+
+      FlushQueuedBlts();
+    }
+
   private:
 
+    // Six vertices per queued blit
+    static constexpr size_t MaxQueuedBltVertexCount = 6 * 1024;
+
+    static constexpr UINT   MinBltAtlasSize         = 1024;
+
+    HRESULT SubmitBatchedDraws();
+
+    HRESULT SubmitQueuedBlts();
+
+    // Returns a render target texture of at least the given size, used to
+    // stage blit sources which can't be sampled from directly
+    d3d9::IDirect3DTexture9* GetBltScratchTexture(UINT width, UINT height, d3d9::D3DFORMAT format);
+
+    HRESULT LockStreamingIndexBuffer(UINT size, UINT* offset, void** data);
+
+    HRESULT LockStreamingVertexBuffer(UINT size, UINT alignment, UINT* offset, void** data);
+
+    d3d9::IDirect3DVertexDeclaration9* GetStridedDeclaration(const D3DStridedLayout& layout);
+
+    HRESULT SyncTransforms();
+
+    HRESULT SyncViewport();
+
+    D3DMATRIX* GetMirroredTransform(d3d9::D3DTRANSFORMSTATETYPE state);
+
     bool                        m_inScene             = false;
 
     DDrawCommonInterface*       m_commonIntf          = nullptr;
@@ -229,6 +483,89 @@ namespace dxvk {
     // that gets created through a CreateDevice call
     IUnknown*                   m_origin              = nullptr;
 
+    // Shared across all devices, used for CPU vertex processing
+    Rc<D3DWorkerPool>           m_workerPool;
+
+    D3DBatcher*                 m_batcher             = nullptr;
+
+    // Mirror of the D3D9 world, view and projection transforms and
+    // of the D3D9 viewport, shared by all D3D device versions
+    bool                        m_recordingStateBlock = false;
+    bool                        m_transformsValid     = false;
+    bool                        m_viewportValid       = false;
+
+    D3DMATRIX                   m_world               = { };
+    D3DMATRIX                   m_view                = { };
+    D3DMATRIX                   m_projection          = { };
+    d3d9::D3DVIEWPORT9          m_viewport9           = { };
+
+    // Composite matrices, recomputed lazily on transform changes
+    uint64_t                    m_transformVersion    = 0;
+    uint64_t                    m_worldViewVersion    = ~0ull;
+    uint64_t                    m_normalVersion       = ~0ull;
+    bool                        m_normalIsLegacy      = false;
+
+    D3DMATRIX                   m_worldView           = { };
+    D3DMATRIX                   m_worldViewProjection = { };
+    D3DMATRIX                   m_normalMatrix        = { };
+
+    // Lights are kept in view space, so only view changes matter
+    uint64_t                    m_viewVersion         = 0;
+
+    // Cached software vertex processing lights
+    const void*                 m_pvLightsSource      = nullptr;
+    uint64_t                    m_pvLightsVersion     = ~0ull;
+    uint64_t                    m_pvLightsViewVersion = ~0ull;
+    std::vector<PVLIGHT>        m_pvLights;
+
+    // Mirror of the D3D9 vertex input state. Bound objects are kept
+    // alive by D3D9 itself, so raw pointers are fine to compare.
+    bool                        m_fvfValid            = false;
+    bool                        m_stream0Valid        = false;
+    bool                        m_indicesValid        = false;
+
+    DWORD                       m_fvf                 = 0;
+    d3d9::IDirect3DVertexDeclaration9* m_vertexDecl   = nullptr;
+    d3d9::IDirect3DVertexBuffer9* m_stream0VB         = nullptr;
+    UINT                        m_stream0Offset       = 0;
+    UINT                        m_stream0Stride       = 0;
+    d3d9::IDirect3DIndexBuffer9* m_indices            = nullptr;
+
+    // Streaming vertex buffer, written with NOOVERWRITE
+    // and only discarded once it wraps around
+    Com<d3d9::IDirect3DVertexBuffer9> m_streamVB9;
+    UINT                        m_streamVBSize        = 0;
+    UINT                        m_streamVBOffset      = 0;
+    UINT                        m_streamVBLocked      = 0;
+    uint64_t                    m_streamVBDiscards    = 0;
+
+    // Streaming index buffer, following the same scheme
+    Com<d3d9::IDirect3DIndexBuffer9> m_streamIB9;
+    UINT                        m_streamIBSize        = 0;
+    UINT                        m_streamIBOffset      = 0;
+    UINT                        m_streamIBLocked      = 0;
+
+    std::unordered_map<
+      D3DStridedLayout,
+      Com<d3d9::IDirect3DVertexDeclaration9>,
+      D3DStridedLayoutHash>     m_stridedDecls;
+
+    // Queued blits, as pre-transformed and textured triangle list
+    // vertices, along with the state which all of them share
+    std::vector<D3DBltVertex>   m_bltVertices;
+    Com<d3d9::IDirect3DSurface9> m_bltDest9;
+    Com<d3d9::IDirect3DTexture9> m_bltSource9;
+    bool                        m_bltColorKeyed       = false;
+    DDCOLORKEY                  m_bltColorKey         = { };
+
+    // Scratch atlas for sources without a texture, filled row by row
+    Com<d3d9::IDirect3DTexture9> m_bltTexture9;
+    UINT                        m_bltAtlasX           = 0;
+    UINT                        m_bltAtlasY           = 0;
+    UINT                        m_bltAtlasRowHeight   = 0;
+
+    static std::atomic<uint64_t> s_lightsVersion;
+
   };
 
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include "d3d_common_material.h"
 
+#include "ddraw_common_interface.h"
+
+#include "../d3d9/d3d9_bridge.h"
+
 namespace dxvk {
 
   std::atomic<D3DMATERIALHANDLE> D3DCommonInterface::s_materialHandle = 0;
@@ -57,4 +61,50 @@ namespace dxvk {
     return d3d9::D3DMULTISAMPLE_NONE;
   }
 
+  HRESULT D3DCommonInterface::CreateD3D9Device(
+          DDrawCommonInterface*         commonIntf,
+          HWND                          hWnd,
+          DWORD                         creationFlags9,
+          d3d9::D3DPRESENT_PARAMETERS*  params,
+          d3d9::IDirect3DDevice9**      ppDevice9) {
+    Com<d3d9::IDirect3DDevice9> device9 = commonIntf->AdoptD3D9Device(hWnd, creationFlags9);
+
+    if (device9 != nullptr) {
+      // A reset restores the default device state and recreates the swapchain,
+      // while D3D7 compatibility lets all other resources survive it
+      HRESULT hr = device9->Reset(params);
+
+      Com<IDxvkLegacyD3DDeviceBridge> bridge;
+      if (likely(SUCCEEDED(hr)))
+        hr = device9->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&bridge));
+
+      if (likely(SUCCEEDED(hr))) {
+        // Not covered by the reset, so bring all bridge state back to
+        // the defaults of a new device, which the D3D device then updates
+        bridge->SetColorKeyState(false);
+        bridge->SetColorKey(0, 0);
+        bridge->SetLegacyLightsState(false);
+        bridge->SetAlternatePixelCenter(false);
+
+        Logger::info("D3DCommonInterface::CreateD3D9Device: Reusing the D3D9 device of a released D3D device");
+        *ppDevice9 = device9.ref();
+        return D3D_OK;
+      }
+
+      Logger::warn("D3DCommonInterface::CreateD3D9Device: Failed to reset the retained D3D9 device");
+    }
+
+    // Release a retained device before creating its replacement
+    device9 = nullptr;
+
+    return m_d3d9Intf->CreateDevice(
+      D3DADAPTER_DEFAULT,
+      d3d9::D3DDEVTYPE_HAL,
+      hWnd,
+      creationFlags9,
+      params,
+      ppDevice9
+    );
+  }
+
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 namespace dxvk {
 
   class D3DCommonMaterial;
+  class DDrawCommonInterface;
 
   class D3D7Interface;
   class D3D6Interface;
@@ -34,6 +35,13 @@ namespace dxvk {
 
     d3d9::D3DMULTISAMPLE_TYPE GetMultiSampleType(d3d9::D3DFORMAT backBufferFormat) const;
 
+    HRESULT CreateD3D9Device(
+            DDrawCommonInterface*         commonIntf,
+            HWND                          hWnd,
+            DWORD                         creationFlags9,
+            d3d9::D3DPRESENT_PARAMETERS*  params,
+            d3d9::IDirect3DDevice9**      ppDevice9);
+
     static D3DMATERIALHANDLE GetNextMaterialHandle() {
       return ++s_materialHandle;
     }
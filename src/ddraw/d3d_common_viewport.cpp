@@ -17,6 +17,8 @@ namespace dxvk {
   }
 
   D3DCommonViewport::~D3DCommonViewport() {
+    // Cached lights are keyed by viewport address
+    D3DCommonDevice::InvalidateLights();
   }
 
   D3D6Viewport* D3DCommonViewport::GetCurrentD3D6Viewport() {
@@ -138,21 +140,21 @@ namespace dxvk {
     if (m_device3 != nullptr)
       lock3 = m_device3->LockDevice();
 
-    d3d9::IDirect3DDevice9* m_device9 = GetCommonD3DDevice()->GetD3D9Device();
+    D3DCommonDevice* commonDevice = GetCommonD3DDevice();
 
     D3DMATRIX world9, view9, projection9;
     HRESULT hr;
-    hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), &world9);
+    hr = commonDevice->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), &world9);
     if (FAILED(hr)) {
       Logger::err("D3DCommonViewport::TransformVertices: failed to get D3D9 world transform");
       return DDERR_GENERIC;
     }
-    hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), &view9);
+    hr = commonDevice->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), &view9);
     if (FAILED(hr)) {
       Logger::err("D3DCommonViewport::TransformVertices: failed to get D3D9 view transform");
       return DDERR_GENERIC;
     }
-    hr = m_device9->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), &projection9);
+    hr = commonDevice->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), &projection9);
     if (FAILED(hr)) {
       Logger::err("D3DCommonViewport::TransformVertices: failed to get D3D9 projection transform");
       return DDERR_GENERIC;
@@ -0,0 +1,145 @@
+#include "d3d_immediate.h"
+
+#include "d3d_common_device.h"
+
+namespace dxvk {
+
+  HRESULT D3DImmediateStream::Begin(
+          D3DCommonDevice* device,
+          D3DPRIMITIVETYPE type,
+          DWORD            fvf,
+          DWORD            flags) {
+    const UINT stride = GetFVFSize(fvf);
+    if (unlikely(!stride || stride > MaxVertexSize))
+      return DDERR_INVALIDPARAMS;
+
+    Reset();
+
+    m_device      = device;
+    m_type        = type;
+    m_fvf         = fvf;
+    m_flags       = flags;
+    m_indexed     = false;
+    m_elementSize = stride;
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DImmediateStream::BeginIndexed(
+          D3DCommonDevice* device,
+          D3DPRIMITIVETYPE type,
+          DWORD            fvf,
+    const void*            vertices,
+          DWORD            vertexCount,
+          DWORD            flags) {
+    if (unlikely(vertices == nullptr || !vertexCount || !GetFVFSize(fvf)))
+      return DDERR_INVALIDPARAMS;
+
+    Reset();
+
+    // The vertices are known upfront, so only indices get gathered
+    m_device      = device;
+    m_type        = type;
+    m_fvf         = fvf;
+    m_flags       = flags;
+    m_indexed     = true;
+    m_vertices    = vertices;
+    m_vertexCount = vertexCount;
+    m_elementSize = sizeof(WORD);
+
+    return D3D_OK;
+  }
+
+  HRESULT D3DImmediateStream::Finish(D3DImmediateDraw* draw) {
+    if (unlikely(m_device == nullptr))
+      return DDERR_GENERIC;
+
+    draw->type    = m_type;
+    draw->fvf     = m_fvf;
+    draw->flags   = m_flags;
+    draw->indexed = m_indexed;
+
+    if (unlikely(!m_count))
+      return D3D_OK;
+
+    HRESULT hr;
+
+    if (m_indexed) {
+      hr = m_device->SetStreamingIndices(reinterpret_cast<const WORD*>(m_data.data()), m_count, &draw->startIndex);
+      if (unlikely(FAILED(hr))) {
+        Logger::err("D3DImmediateStream: Failed to upload indices");
+        return hr;
+      }
+
+      const uint64_t discards = m_device->GetStreamingVertexDiscards();
+
+      if (!m_verticesUploaded || m_vertexDiscards != discards) {
+        hr = m_device->SetStreamingVertices(m_fvf, m_vertices, m_vertexCount, &m_baseVertex);
+        m_verticesUploaded = SUCCEEDED(hr);
+        m_vertexDiscards   = m_device->GetStreamingVertexDiscards();
+      } else {
+        hr = m_device->BindStreamingVertices(m_fvf);
+      }
+
+      draw->baseVertex  = m_baseVertex;
+      draw->vertexCount = m_vertexCount;
+      draw->indexCount  = m_count;
+    } else {
+      hr = m_device->SetStreamingVertices(m_fvf, m_data.data(), m_count, &draw->baseVertex);
+
+      draw->vertexCount = m_count;
+    }
+
+    if (unlikely(FAILED(hr))) {
+      Logger::err("D3DImmediateStream: Failed to upload vertices");
+      return hr;
+    }
+
+    return D3D_OK;
+  }
+
+  void D3DImmediateStream::Continue() {
+    static_assert(ddrawCaps::ImmediateChunkSize % 6 == 0);
+
+    const DWORD count = m_count;
+
+    m_count = 0;
+
+    // Carried elements only ever move towards the start of the chunk
+    auto carry = [this] (DWORD index) {
+      std::memmove(m_data.data() + m_count * m_elementSize,
+                   m_data.data() + index   * m_elementSize, m_elementSize);
+      m_count++;
+    };
+
+    // Lists never get split up, since the chunk size is a multiple
+    // of 6. It's also even, which keeps the winding order of strips.
+    switch (m_type) {
+      case D3DPT_LINESTRIP:
+        carry(count - 1);
+        break;
+
+      case D3DPT_TRIANGLESTRIP:
+        carry(count - 2);
+        carry(count - 1);
+        break;
+
+      case D3DPT_TRIANGLEFAN:
+        carry(0);
+        carry(count - 1);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  void D3DImmediateStream::Reset() {
+    m_device           = nullptr;
+    m_vertices         = nullptr;
+    m_verticesUploaded = false;
+    m_count            = 0;
+    m_indexed          = false;
+  }
+
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "ddraw_include.h"
+#include "ddraw_caps.h"
+
+#include <array>
+#include <cstring>
+
+namespace dxvk {
+
+  class D3DCommonDevice;
+
+  struct D3DImmediateDraw {
+    D3DPRIMITIVETYPE type        = D3DPT_TRIANGLELIST;
+    DWORD            fvf         = 0;
+    DWORD            flags       = 0;
+    bool             indexed     = false;
+    UINT             baseVertex  = 0;
+    DWORD            vertexCount = 0;
+    UINT             startIndex  = 0;
+    DWORD            indexCount  = 0;
+  };
+
+  /**
+   * \brief Immediate mode stream
+   *
+   * Backs Begin/Vertex/End and BeginIndexed/Index/End. Vertices, or indices
+   * for indexed streams, get gathered in fixed size chunks. Once a chunk fills
+   * up, it gets uploaded to the streaming buffers of the common device in one
+   * go and drawn, and the primitive continues in a new chunk, starting with
+   * any vertices that the next primitives still share with the drawn ones.
+   * Nothing stays locked in between API calls of the application.
+   */
+  class D3DImmediateStream {
+
+  public:
+
+    // Large enough for all legacy vertex types
+    static constexpr UINT MaxVertexSize = sizeof(D3DTLVERTEX);
+
+    bool IsActive() const {
+      return m_device != nullptr;
+    }
+
+    bool IsIndexed() const {
+      return m_indexed;
+    }
+
+    bool IsFull() const {
+      return m_count == ddrawCaps::ImmediateChunkSize;
+    }
+
+    HRESULT Begin(
+            D3DCommonDevice* device,
+            D3DPRIMITIVETYPE type,
+            DWORD            fvf,
+            DWORD            flags);
+
+    HRESULT BeginIndexed(
+            D3DCommonDevice* device,
+            D3DPRIMITIVETYPE type,
+            DWORD            fvf,
+      const void*            vertices,
+            DWORD            vertexCount,
+            DWORD            flags);
+
+    // Adds a vertex, or an index for indexed streams. The
+    // stream must not be full, see Finish and Continue.
+    void Add(const void* element) {
+      std::memcpy(m_data.data() + m_count * m_elementSize, element, m_elementSize);
+      m_count++;
+    }
+
+    // Uploads the current chunk and returns the draw covering it
+    HRESULT Finish(D3DImmediateDraw* draw);
+
+    // Starts a new chunk after a full one has been drawn
+    void Continue();
+
+    void Reset();
+
+  private:
+
+    D3DCommonDevice*      m_device      = nullptr;
+
+    D3DPRIMITIVETYPE      m_type        = D3DPT_TRIANGLELIST;
+    DWORD                 m_fvf         = 0;
+    DWORD                 m_flags       = 0;
+    bool                  m_indexed     = false;
+
+    // Vertices of indexed streams only need to be uploaded again
+    // once the streaming vertex buffer has been discarded
+    const void*           m_vertices         = nullptr;
+    DWORD                 m_vertexCount      = 0;
+    UINT                  m_baseVertex       = 0;
+    bool                  m_verticesUploaded = false;
+    uint64_t              m_vertexDiscards   = 0;
+
+    UINT                  m_elementSize = 0;
+    DWORD                 m_count       = 0;
+
+    std::array<BYTE, ddrawCaps::ImmediateChunkSize * MaxVertexSize> m_data = { };
+
+  };
+
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "d3d_light.h"
 
+#include "d3d_common_device.h"
+
 #include "d3d3/d3d3_viewport.h"
 #include "d3d5/d3d5_viewport.h"
 #include "d3d6/d3d6_viewport.h"
@@ -99,6 +101,8 @@ namespace dxvk {
     // D3DLIGHT structure lights are, apparently, considered to be active by default
     m_isActive            = isD3DLight2 ? (m_flags & D3DLIGHT_ACTIVE) : true;
 
+    D3DCommonDevice::InvalidateLights();
+
     // Update the D3D9 light directly if it's actively being used
     if (m_viewport6 != nullptr && m_viewport6->GetCommonViewport()->IsCurrentViewport())
       m_viewport6->ApplyAndActivateLight(this->GetIndex(), this);
@@ -0,0 +1,793 @@
+#include "d3d_process_vertices.h"
+
+#include <cstring>
+
+namespace dxvk {
+
+  static inline DWORD ComputeClipCode(const D3DVECTOR4& h) {
+    DWORD clipCode = 0;
+
+    if (h.x < -h.w)
+      clipCode |= D3DCLIP_LEFT;
+    if (h.x > h.w)
+      clipCode |= D3DCLIP_RIGHT;
+    if (h.y > h.w)
+      clipCode |= D3DCLIP_TOP;
+    if (h.y < -h.w)
+      clipCode |= D3DCLIP_BOTTOM;
+    if (h.z < 0.0f)
+      clipCode |= D3DCLIP_FRONT;
+    if (h.z > h.w)
+      clipCode |= D3DCLIP_BACK;
+
+    return clipCode;
+  }
+
+  static inline D3DCOLORVALUE LoadColor(const float (&color)[4][PVBatchSize], uint32_t lane) {
+    return D3DCOLORVALUE{ color[0][lane], color[1][lane], color[2][lane], color[3][lane] };
+  }
+
+  static inline void StoreColor(float (&color)[4][PVBatchSize], uint32_t lane, const D3DCOLORVALUE& value) {
+    color[0][lane] = value.r;
+    color[1][lane] = value.g;
+    color[2][lane] = value.b;
+    color[3][lane] = value.a;
+  }
+
+  void ProcessVerticesBatchScalar(const ProcessVerticesState& state, ProcessVerticesBatch& batch) {
+    for (uint32_t i = 0; i < PVBatchSize; i++) {
+      const D3DVECTOR4 inPosition = {batch.x[i], batch.y[i], batch.z[i], 1.0f};
+
+      // Transform vertices
+      if (likely(state.doTransform)) {
+        const D3DVECTOR4 h = D3DVec4Transform(state.wvp, inPosition);
+
+        // Hidden & Dangerous (D3D6) relies on division by zero and NAN/INF output
+        const float rhw = 1.0f / h.w;
+        batch.outX[i]   = state.viewportX + state.viewportHalfWidth  * (h.x * rhw + 1.0f);
+        batch.outY[i]   = state.viewportY + state.viewportHalfHeight * (1.0f - h.y * rhw);
+        batch.outZ[i]   = state.viewportMinZ + h.z * rhw * state.viewportZDelta;
+        batch.outRHW[i] = rhw;
+
+        // Alternate pixel center workaround for the Resident Evil quad alignment problem
+        if (unlikely(state.doPixelCenterOffset)) {
+          batch.outX[i] -= 0.5f;
+          batch.outY[i] -= 0.5f;
+        }
+
+        batch.clipCode[i] = ComputeClipCode(h);
+      }
+
+      D3DCOLORVALUE diffuse  = {0.0f, 0.0f, 0.0f, 0.0f};
+      D3DCOLORVALUE specular = {0.0f, 0.0f, 0.0f, 0.0f};
+
+      D3DVECTOR4 WVPosition = D3DVec4Transform(state.wv, inPosition);
+      const D3DVECTOR WVPosition3 = {WVPosition.x, WVPosition.y, WVPosition.z};
+      const float positionScale = 1.0f / WVPosition.w;
+      WVPosition.x *= positionScale;
+      WVPosition.y *= positionScale;
+      WVPosition.z *= positionScale;
+
+      const D3DCOLORVALUE materialDiffuse  = LoadColor(batch.materialDiffuse,  i);
+      const D3DCOLORVALUE materialSpecular = LoadColor(batch.materialSpecular, i);
+
+      if (state.doLighting) {
+        const D3DVECTOR NVWPosition = D3DVec3Normalize(WVPosition3);
+        D3DVECTOR normals = { };
+        if (state.hasNormals) {
+          normals = D3DVec3Transform(state.normalMatrix, D3DVECTOR{batch.nx[i], batch.ny[i], batch.nz[i]});
+          if (state.isEnabledNormalizeNormals)
+            normals = D3DVec3Normalize(normals);
+        }
+
+        D3DCOLORVALUE ambient = state.ambient;
+
+        for (size_t l = 0; l < state.lightCount; l++) {
+          const PVLIGHT& light = state.lights[l];
+
+          D3DVECTOR hitDirection;
+          float attenuation;
+          const D3DLIGHTTYPE lightType = D3DLIGHTTYPE(light.Type);
+          switch (lightType) {
+            case D3DLIGHT_DIRECTIONAL: {
+              hitDirection = light.LightDirection;
+              attenuation = 1.0f;
+              break;
+            }
+            case D3DLIGHT_POINT:
+            case D3DLIGHT_SPOT: {
+              hitDirection = D3DVECTOR{light.LightPosition.x - WVPosition.x, light.LightPosition.y - WVPosition.y,
+                                       light.LightPosition.z - WVPosition.z};
+              Vector4 destination(1.0f, 0.0f, D3DVec3Dot(&hitDirection, &hitDirection), 0.0f);
+              destination.y = std::sqrtf(destination.z);
+              if (state.isLegacy) {
+                destination.y = (light.Range - destination.y) / light.Range;
+                if (destination.y <= 0.0f)
+                  continue;
+                destination.z = destination.y * destination.y;
+              } else {
+                if (destination.y > light.Range)
+                  continue;
+              }
+
+              hitDirection = D3DVec3Normalize(hitDirection);
+              attenuation = destination.x * light.Attenuation0 + destination.y *
+                            light.Attenuation1 + destination.z * light.Attenuation2;
+
+              if (!state.isLegacy)
+                attenuation = 1.0f / attenuation;
+
+              if (lightType == D3DLIGHT_SPOT) {
+                const D3DVECTOR revHit = {-hitDirection.x, -hitDirection.y, -hitDirection.z};
+                const float rho = D3DVec3Dot(&revHit, &light.LightDirection);
+                if (rho <= light.cosHalfPhi)
+                  attenuation = 0.0f;
+                else if (rho <= light.cosHalfTheta)
+                  attenuation *= powf((rho - light.cosHalfPhi) / (light.cosHalfTheta - light.cosHalfPhi), light.Falloff);
+              }
+              break;
+            }
+            default:
+              Logger::warn(str::format("ProcessVerticesSW: Invalid light type: ", lightType));
+              continue;
+          }
+
+          ColorVMultiplyAdd(ambient, light.Ambient, attenuation);
+          if (state.hasNormals)
+            ApplyLight(&light, state.isEnabledLocalViewer, diffuse, specular, &normals,
+                       &hitDirection, &NVWPosition, attenuation, state.materialPower, state.isLegacy);
+        }
+
+        const D3DCOLORVALUE materialAmbient  = LoadColor(batch.materialAmbient,  i);
+        const D3DCOLORVALUE materialEmissive = LoadColor(batch.materialEmissive, i);
+
+        diffuse.r = D3DMad2AddScalar(ambient.r, materialAmbient.r, diffuse.r, materialDiffuse.r, materialEmissive.r);
+        diffuse.g = D3DMad2AddScalar(ambient.g, materialAmbient.g, diffuse.g, materialDiffuse.g, materialEmissive.g);
+        diffuse.b = D3DMad2AddScalar(ambient.b, materialAmbient.b, diffuse.b, materialDiffuse.b, materialEmissive.b);
+        diffuse.a = materialDiffuse.a;
+
+        D3DColorMulRGBSetAlpha(specular, materialSpecular, state.isLegacy);
+      } else {
+        diffuse  = materialDiffuse;
+        specular = materialSpecular;
+      }
+
+      if (state.doFog)
+        ApplyFog(&specular.a, state.fogVertexMode, state.fogDensity, state.fogStart,
+                 state.fogEnd, state.isEnabledFogRange, WVPosition3);
+
+      D3DColorClamp(diffuse);
+      D3DColorClamp(specular);
+
+      StoreColor(batch.diffuse,  i, diffuse);
+      StoreColor(batch.specular, i, specular);
+    }
+  }
+
+#ifdef DXVK_SWVP_SSE2
+  // All of the below helpers follow the order of operations
+  // of their scalar SSE2 counterparts, lane by lane
+
+  static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+
+  static inline __m128 Negate(__m128 v) {
+    return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+  }
+
+  // Matches D3DVec3Dot
+  static inline __m128 Dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(az, bz)), _mm_mul_ps(ay, by));
+  }
+
+  // Matches D3DVec3Normalize
+  static inline void Normalize3(__m128& x, __m128& y, __m128& z) {
+    const __m128 sum = Dot3(x, y, z, x, y, z);
+
+    __m128 inv = _mm_rsqrt_ps(sum);
+    inv = _mm_mul_ps(inv, _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(sum, inv), inv)));
+    inv = _mm_mul_ps(inv, _mm_set1_ps(0.5f));
+
+    x = _mm_mul_ps(x, inv);
+    y = _mm_mul_ps(y, inv);
+    z = _mm_mul_ps(z, inv);
+  }
+
+  // Matches D3DVec4Transform, with w being 1.0f
+  static inline __m128 TransformPosition(__m128 x, __m128 y, __m128 z, float m1, float m2, float m3, float m4) {
+    __m128 r = _mm_mul_ps(x, _mm_set1_ps(m1));
+    r = _mm_add_ps(r, _mm_mul_ps(y, _mm_set1_ps(m2)));
+    r = _mm_add_ps(r, _mm_mul_ps(z, _mm_set1_ps(m3)));
+    r = _mm_add_ps(r, _mm_set1_ps(m4));
+    return r;
+  }
+
+  // Matches D3DVec3Transform
+  static inline __m128 TransformNormal(__m128 x, __m128 y, __m128 z, float m1, float m2, float m3) {
+    __m128 r = _mm_mul_ps(x, _mm_set1_ps(m1));
+    r = _mm_add_ps(r, _mm_mul_ps(y, _mm_set1_ps(m2)));
+    r = _mm_add_ps(r, _mm_mul_ps(z, _mm_set1_ps(m3)));
+    return r;
+  }
+
+  // Matches std::clamp(v, 0.0f, 1.0f), including NaN handling
+  static inline __m128 Saturate(__m128 v) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    return Select(_mm_cmplt_ps(v, zero), zero, Select(_mm_cmplt_ps(one, v), one, v));
+  }
+
+  void ProcessVerticesBatchSSE2(const ProcessVerticesState& state, ProcessVerticesBatch& batch) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+
+    const __m128 x = _mm_loadu_ps(batch.x);
+    const __m128 y = _mm_loadu_ps(batch.y);
+    const __m128 z = _mm_loadu_ps(batch.z);
+
+    // Transform vertices
+    if (likely(state.doTransform)) {
+      const D3DMATRIX& m = state.wvp;
+
+      const __m128 hx = TransformPosition(x, y, z, m._11, m._21, m._31, m._41);
+      const __m128 hy = TransformPosition(x, y, z, m._12, m._22, m._32, m._42);
+      const __m128 hz = TransformPosition(x, y, z, m._13, m._23, m._33, m._43);
+      const __m128 hw = TransformPosition(x, y, z, m._14, m._24, m._34, m._44);
+
+      // Hidden & Dangerous (D3D6) relies on division by zero and NAN/INF output
+      const __m128 rhw = _mm_div_ps(one, hw);
+
+      __m128 outX = _mm_add_ps(_mm_set1_ps(state.viewportX),
+                    _mm_mul_ps(_mm_set1_ps(state.viewportHalfWidth), _mm_add_ps(_mm_mul_ps(hx, rhw), one)));
+      __m128 outY = _mm_add_ps(_mm_set1_ps(state.viewportY),
+                    _mm_mul_ps(_mm_set1_ps(state.viewportHalfHeight), _mm_sub_ps(one, _mm_mul_ps(hy, rhw))));
+      __m128 outZ = _mm_add_ps(_mm_set1_ps(state.viewportMinZ),
+                    _mm_mul_ps(_mm_mul_ps(hz, rhw), _mm_set1_ps(state.viewportZDelta)));
+
+      // Alternate pixel center workaround for the Resident Evil quad alignment problem
+      if (unlikely(state.doPixelCenterOffset)) {
+        outX = _mm_sub_ps(outX, _mm_set1_ps(0.5f));
+        outY = _mm_sub_ps(outY, _mm_set1_ps(0.5f));
+      }
+
+      _mm_storeu_ps(batch.outX,   outX);
+      _mm_storeu_ps(batch.outY,   outY);
+      _mm_storeu_ps(batch.outZ,   outZ);
+      _mm_storeu_ps(batch.outRHW, rhw);
+
+      const __m128 negW = Negate(hw);
+
+      const int clipLeft   = _mm_movemask_ps(_mm_cmplt_ps(hx, negW));
+      const int clipRight  = _mm_movemask_ps(_mm_cmpgt_ps(hx, hw));
+      const int clipTop    = _mm_movemask_ps(_mm_cmpgt_ps(hy, hw));
+      const int clipBottom = _mm_movemask_ps(_mm_cmplt_ps(hy, negW));
+      const int clipFront  = _mm_movemask_ps(_mm_cmplt_ps(hz, zero));
+      const int clipBack   = _mm_movemask_ps(_mm_cmpgt_ps(hz, hw));
+
+      for (uint32_t i = 0; i < PVBatchSize; i++) {
+        batch.clipCode[i] = (((clipLeft   >> i) & 1) ? D3DCLIP_LEFT   : 0)
+                          | (((clipRight  >> i) & 1) ? D3DCLIP_RIGHT  : 0)
+                          | (((clipTop    >> i) & 1) ? D3DCLIP_TOP    : 0)
+                          | (((clipBottom >> i) & 1) ? D3DCLIP_BOTTOM : 0)
+                          | (((clipFront  >> i) & 1) ? D3DCLIP_FRONT  : 0)
+                          | (((clipBack   >> i) & 1) ? D3DCLIP_BACK   : 0);
+      }
+    }
+
+    // View space position, before and after the w divide
+    const D3DMATRIX& wv = state.wv;
+
+    const __m128 wx = TransformPosition(x, y, z, wv._11, wv._21, wv._31, wv._41);
+    const __m128 wy = TransformPosition(x, y, z, wv._12, wv._22, wv._32, wv._42);
+    const __m128 wz = TransformPosition(x, y, z, wv._13, wv._23, wv._33, wv._43);
+    const __m128 ww = TransformPosition(x, y, z, wv._14, wv._24, wv._34, wv._44);
+
+    const __m128 positionScale = _mm_div_ps(one, ww);
+    const __m128 sx = _mm_mul_ps(wx, positionScale);
+    const __m128 sy = _mm_mul_ps(wy, positionScale);
+    const __m128 sz = _mm_mul_ps(wz, positionScale);
+
+    __m128 materialDiffuse[4];
+    __m128 materialSpecular[4];
+
+    for (uint32_t c = 0; c < 4; c++) {
+      materialDiffuse[c]  = _mm_loadu_ps(batch.materialDiffuse[c]);
+      materialSpecular[c] = _mm_loadu_ps(batch.materialSpecular[c]);
+    }
+
+    __m128 diffuse[4];
+    __m128 specular[4];
+
+    if (state.doLighting) {
+      __m128 nvx = wx;
+      __m128 nvy = wy;
+      __m128 nvz = wz;
+      Normalize3(nvx, nvy, nvz);
+
+      __m128 nx = zero;
+      __m128 ny = zero;
+      __m128 nz = zero;
+
+      if (state.hasNormals) {
+        const D3DMATRIX& n = state.normalMatrix;
+
+        const __m128 inNx = _mm_loadu_ps(batch.nx);
+        const __m128 inNy = _mm_loadu_ps(batch.ny);
+        const __m128 inNz = _mm_loadu_ps(batch.nz);
+
+        nx = TransformNormal(inNx, inNy, inNz, n._11, n._21, n._31);
+        ny = TransformNormal(inNx, inNy, inNz, n._12, n._22, n._32);
+        nz = TransformNormal(inNx, inNy, inNz, n._13, n._23, n._33);
+
+        if (state.isEnabledNormalizeNormals)
+          Normalize3(nx, ny, nz);
+      }
+
+      const bool hasSpecular = !state.isLegacy || state.materialPower > 0.0f;
+
+      __m128 ambient[3] = {
+        _mm_set1_ps(state.ambient.r),
+        _mm_set1_ps(state.ambient.g),
+        _mm_set1_ps(state.ambient.b),
+      };
+
+      for (uint32_t c = 0; c < 3; c++) {
+        diffuse[c]  = zero;
+        specular[c] = zero;
+      }
+
+      for (size_t l = 0; l < state.lightCount; l++) {
+        const PVLIGHT& light = state.lights[l];
+
+        __m128 hitX, hitY, hitZ;
+        __m128 attenuation;
+        __m128 active = _mm_cmpeq_ps(zero, zero);
+
+        const D3DLIGHTTYPE lightType = D3DLIGHTTYPE(light.Type);
+        switch (lightType) {
+          case D3DLIGHT_DIRECTIONAL: {
+            hitX = _mm_set1_ps(light.LightDirection.x);
+            hitY = _mm_set1_ps(light.LightDirection.y);
+            hitZ = _mm_set1_ps(light.LightDirection.z);
+            attenuation = one;
+            break;
+          }
+          case D3DLIGHT_POINT:
+          case D3DLIGHT_SPOT: {
+            hitX = _mm_sub_ps(_mm_set1_ps(light.LightPosition.x), sx);
+            hitY = _mm_sub_ps(_mm_set1_ps(light.LightPosition.y), sy);
+            hitZ = _mm_sub_ps(_mm_set1_ps(light.LightPosition.z), sz);
+
+            const __m128 range = _mm_set1_ps(light.Range);
+
+            __m128 distanceSq = Dot3(hitX, hitY, hitZ, hitX, hitY, hitZ);
+            __m128 distance   = _mm_sqrt_ps(distanceSq);
+
+            if (state.isLegacy) {
+              distance   = _mm_div_ps(_mm_sub_ps(range, distance), range);
+              active     = _mm_cmpnle_ps(distance, zero);
+              distanceSq = _mm_mul_ps(distance, distance);
+            } else {
+              active     = _mm_cmpngt_ps(distance, range);
+            }
+
+            if (!_mm_movemask_ps(active))
+              continue;
+
+            Normalize3(hitX, hitY, hitZ);
+
+            attenuation = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light.Attenuation0),
+                          _mm_mul_ps(distance, _mm_set1_ps(light.Attenuation1))),
+                          _mm_mul_ps(distanceSq, _mm_set1_ps(light.Attenuation2)));
+
+            if (!state.isLegacy)
+              attenuation = _mm_div_ps(one, attenuation);
+
+            // The spot cone falloff is rare enough to not bother going wide
+            if (lightType == D3DLIGHT_SPOT) {
+              alignas(16) float rho[PVBatchSize];
+              alignas(16) float spotAttenuation[PVBatchSize];
+
+              _mm_store_ps(rho, Dot3(Negate(hitX), Negate(hitY), Negate(hitZ),
+                                     _mm_set1_ps(light.LightDirection.x),
+                                     _mm_set1_ps(light.LightDirection.y),
+                                     _mm_set1_ps(light.LightDirection.z)));
+              _mm_store_ps(spotAttenuation, attenuation);
+
+              for (uint32_t i = 0; i < PVBatchSize; i++) {
+                if (rho[i] <= light.cosHalfPhi)
+                  spotAttenuation[i] = 0.0f;
+                else if (rho[i] <= light.cosHalfTheta)
+                  spotAttenuation[i] *= powf((rho[i] - light.cosHalfPhi) / (light.cosHalfTheta - light.cosHalfPhi), light.Falloff);
+              }
+
+              attenuation = _mm_load_ps(spotAttenuation);
+            }
+            break;
+          }
+          default:
+            Logger::warn(str::format("ProcessVerticesSW: Invalid light type: ", lightType));
+            continue;
+        }
+
+        ambient[0] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Ambient.r), attenuation), ambient[0]), ambient[0]);
+        ambient[1] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Ambient.g), attenuation), ambient[1]), ambient[1]);
+        ambient[2] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Ambient.b), attenuation), ambient[2]), ambient[2]);
+
+        if (!state.hasNormals)
+          continue;
+
+        // Matches ApplyLight
+        const __m128 directionDot = Saturate(Dot3(hitX, hitY, hitZ, nx, ny, nz));
+        const __m128 diffuseScale = _mm_mul_ps(directionDot, attenuation);
+
+        diffuse[0] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Diffuse.r), diffuseScale), diffuse[0]), diffuse[0]);
+        diffuse[1] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Diffuse.g), diffuseScale), diffuse[1]), diffuse[1]);
+        diffuse[2] = Select(active, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Diffuse.b), diffuseScale), diffuse[2]), diffuse[2]);
+
+        if (!hasSpecular)
+          continue;
+
+        __m128 midX = hitX;
+        __m128 midY = hitY;
+        __m128 midZ = hitZ;
+        if (state.isEnabledLocalViewer) {
+          midX = _mm_sub_ps(midX, nvx);
+          midY = _mm_sub_ps(midY, nvy);
+          midZ = _mm_sub_ps(midZ, nvz);
+        } else {
+          midZ = _mm_sub_ps(midZ, one);
+        }
+
+        Normalize3(midX, midY, midZ);
+        const __m128 directionTransformedDot = Dot3(nx, ny, nz, midX, midY, midZ);
+
+        const __m128 specularMask = _mm_and_ps(active, _mm_and_ps(_mm_cmpgt_ps(directionTransformedDot, zero),
+                                                                  _mm_cmpgt_ps(directionDot, zero)));
+        const int specularLanes = _mm_movemask_ps(specularMask);
+
+        if (!specularLanes)
+          continue;
+
+        alignas(16) float specularBase[PVBatchSize];
+        alignas(16) float specularScale[PVBatchSize];
+
+        _mm_store_ps(specularBase, directionTransformedDot);
+        _mm_store_ps(specularScale, attenuation);
+
+        for (uint32_t i = 0; i < PVBatchSize; i++) {
+          specularScale[i] = ((specularLanes >> i) & 1)
+            ? powf(specularBase[i], state.materialPower) * specularScale[i]
+            : 0.0f;
+        }
+
+        const __m128 specularFactor = _mm_load_ps(specularScale);
+
+        specular[0] = Select(specularMask, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Specular.r), specularFactor), specular[0]), specular[0]);
+        specular[1] = Select(specularMask, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Specular.g), specularFactor), specular[1]), specular[1]);
+        specular[2] = Select(specularMask, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.Specular.b), specularFactor), specular[2]), specular[2]);
+      }
+
+      for (uint32_t c = 0; c < 3; c++) {
+        const __m128 materialAmbient  = _mm_loadu_ps(batch.materialAmbient[c]);
+        const __m128 materialEmissive = _mm_loadu_ps(batch.materialEmissive[c]);
+
+        // Matches D3DMad2AddScalar
+        diffuse[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ambient[c], materialAmbient),
+                                           _mm_mul_ps(diffuse[c], materialDiffuse[c])), materialEmissive);
+        specular[c] = _mm_mul_ps(specular[c], materialSpecular[c]);
+      }
+
+      diffuse[3]  = materialDiffuse[3];
+      specular[3] = state.isLegacy ? zero : materialSpecular[3];
+    } else {
+      for (uint32_t c = 0; c < 4; c++) {
+        diffuse[c]  = materialDiffuse[c];
+        specular[c] = materialSpecular[c];
+      }
+    }
+
+    // Matches ApplyFog
+    if (state.doFog) {
+      const __m128 coord = state.isEnabledFogRange
+        ? _mm_sqrt_ps(Dot3(wx, wy, wz, wx, wy, wz))
+        : _mm_andnot_ps(_mm_set1_ps(-0.0f), wz);
+
+      switch (state.fogVertexMode) {
+        // (end - coord) / (end - start)
+        case D3DFOG_LINEAR: {
+          const __m128 fogFactor = _mm_sub_ps(_mm_set1_ps(state.fogEnd), coord);
+          specular[3] = _mm_div_ps(fogFactor, _mm_set1_ps(state.fogEnd - state.fogStart));
+          break;
+        }
+        // 1 / (e^[coord * density])
+        case D3DFOG_EXP:
+        // 1 / (e^[coord * density])^2
+        case D3DFOG_EXP2: {
+          alignas(16) float fogFactor[PVBatchSize];
+          _mm_store_ps(fogFactor, _mm_mul_ps(coord, _mm_set1_ps(state.fogDensity)));
+
+          for (uint32_t i = 0; i < PVBatchSize; i++) {
+            fogFactor[i] = state.fogVertexMode == D3DFOG_EXP
+              ? expf(-1.0f * fogFactor[i])
+              : expf(-1.0f * fogFactor[i] * fogFactor[i]);
+          }
+
+          specular[3] = _mm_load_ps(fogFactor);
+          break;
+        }
+        default:
+          break;
+      }
+    }
+
+    // Matches D3DColorClamp
+    for (uint32_t c = 0; c < 4; c++) {
+      diffuse[c]  = _mm_max_ps(_mm_min_ps(diffuse[c],  one), zero);
+      specular[c] = _mm_max_ps(_mm_min_ps(specular[c], one), zero);
+
+      _mm_storeu_ps(batch.diffuse[c],  diffuse[c]);
+      _mm_storeu_ps(batch.specular[c], specular[c]);
+    }
+  }
+#endif
+
+  template <DWORD InFVF, DWORD OutFVF>
+  static void ProcessVerticesRange(
+          const ProcessVerticesData*  pvData,
+          const ProcessVerticesState& state,
+                uint32_t              first,
+                uint32_t              count,
+                ProcessVerticesStatus& status) {
+    // Strides are compile time constants for known FVFs as well
+    constexpr size_t StaticInStride  = GetFVFSize(InFVF);
+    constexpr size_t StaticOutStride = GetFVFSize(OutFVF);
+
+    const size_t inStride  = InFVF  != 0 ? StaticInStride  : pvData->inStride;
+    const size_t outStride = OutFVF != 0 ? StaticOutStride : pvData->outStride;
+
+    // Unused lanes of the last batch get processed as well,
+    // so make sure they always hold some defined values
+    ProcessVerticesBatch batch = { };
+
+    for (uint32_t base = first; base < first + count; base += PVBatchSize) {
+      const uint32_t batchCount = std::min<uint32_t>(PVBatchSize, first + count - base);
+
+      PositionArray inPosition[PVBatchSize] = { };
+      D3DVECTOR* inNormals[PVBatchSize]     = { };
+      D3DCOLOR* inDiffuse[PVBatchSize]      = { };
+      D3DCOLOR* inSpecular[PVBatchSize]     = { };
+      TexCoordArray inTexCoords[PVBatchSize];
+
+      for (uint32_t i = 0; i < batchCount; i++) {
+        inTexCoords[i] = { };
+
+        // Strided sources never match any of the specialized variants
+        if (InFVF == 0 && unlikely(pvData->strided != nullptr)) {
+          ProcessVerticesInputStrided(pvData->doNotCopyData, pvData->inFVF, *pvData->strided, base + i,
+                                      inPosition[i], &inNormals[i], inTexCoords[i], &inDiffuse[i], &inSpecular[i]);
+        } else {
+          uint8_t* inPtr = pvData->inData + (base + i) * inStride;
+
+          ProcessVerticesInput<InFVF>(pvData->doNotCopyData, pvData->inFVF, inPtr, inPosition[i],
+                                      &inNormals[i], inTexCoords[i], &inDiffuse[i], &inSpecular[i]);
+        }
+
+        batch.x[i] = inPosition[i][0];
+        batch.y[i] = inPosition[i][1];
+        batch.z[i] = inPosition[i][2];
+
+        if (inNormals[i] != nullptr) {
+          batch.nx[i] = inNormals[i]->x;
+          batch.ny[i] = inNormals[i]->y;
+          batch.nz[i] = inNormals[i]->z;
+        }
+
+        StoreColor(batch.materialDiffuse,  i, ColorFromMaterialSource(inDiffuse[i], inSpecular[i], state.sourceDiffuse,  state.materialDiffuse));
+        StoreColor(batch.materialSpecular, i, ColorFromMaterialSource(inDiffuse[i], inSpecular[i], state.sourceSpecular, state.materialSpecular));
+
+        if (state.doLighting) {
+          StoreColor(batch.materialAmbient,  i, ColorFromMaterialSource(inDiffuse[i], inSpecular[i], state.sourceAmbient,  state.materialAmbient));
+          StoreColor(batch.materialEmissive, i, ColorFromMaterialSource(inDiffuse[i], inSpecular[i], state.sourceEmissive, state.materialEmissive));
+        }
+      }
+
+      state.processBatch(state, batch);
+
+      for (uint32_t i = 0; i < batchCount; i++) {
+        uint8_t* outPtr = pvData->outData + (base + i) * outStride;
+
+        PositionArray outPosition = inPosition[i];
+        if (likely(state.doTransform)) {
+          outPosition[0] = batch.outX[i];
+          outPosition[1] = batch.outY[i];
+          outPosition[2] = batch.outZ[i];
+
+          // Native supposedly always write rhw without checking output, be more sane until that become a real problem
+          if (likely((OutFVF != 0 ? OutFVF : pvData->outFVF) & D3DFVF_XYZRHW))
+            outPosition[3] = batch.outRHW[i];
+
+          status.clipUnion        |= batch.clipCode[i];
+          status.clipIntersection &= batch.clipCode[i];
+
+          status.extentMinX = std::min(status.extentMinX, outPosition[0]);
+          status.extentMinY = std::min(status.extentMinY, outPosition[1]);
+          status.extentMaxX = std::max(status.extentMaxX, outPosition[0]);
+          status.extentMaxY = std::max(status.extentMaxY, outPosition[1]);
+        }
+
+        const D3DCOLOR outDiffuse  = ColorVToColor(LoadColor(batch.diffuse,  i));
+        const D3DCOLOR outSpecular = ColorVToColor(LoadColor(batch.specular, i));
+
+        ProcessVerticesOutput<OutFVF>(pvData->outFVF, outPtr, outPosition,
+                                      (!pvData->doNotCopyData ? inNormals[i] : nullptr),
+                                      (!pvData->doNotCopyData ? &inTexCoords[i] : nullptr),
+                                      (!pvData->doNotCopyData ? &outDiffuse : nullptr),
+                                      (!pvData->doNotCopyData ? &outSpecular : nullptr));
+      }
+    }
+  }
+
+  struct ProcessVerticesRangeEntry {
+    DWORD                  inFVF;
+    DWORD                  outFVF;
+    ProcessVerticesRangeFn fn;
+  };
+
+  template <DWORD InFVF, DWORD OutFVF>
+  static constexpr ProcessVerticesRangeEntry MakeRangeEntry() {
+    return { InFVF, OutFVF, &ProcessVerticesRange<InFVF, OutFVF> };
+  }
+
+  // The most common input and output FVF combinations, as used by
+  // D3D3 execute buffers and by D3D6/7 games with ProcessVertices
+  static const std::array<ProcessVerticesRangeEntry, 7> s_processVerticesRangeFns = {{
+    MakeRangeEntry<D3DFVF_VERTEX,  D3DFVF_TLVERTEX>(),
+    MakeRangeEntry<D3DFVF_LVERTEX, D3DFVF_TLVERTEX>(),
+    MakeRangeEntry<D3DFVF_XYZ | D3DFVF_NORMAL,                     D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_SPECULAR>(),
+    MakeRangeEntry<D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1,       D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1>(),
+    MakeRangeEntry<D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1,      D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1>(),
+    MakeRangeEntry<D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_SPECULAR | D3DFVF_TEX1,
+                                                                   D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_SPECULAR | D3DFVF_TEX1>(),
+    MakeRangeEntry<D3DFVF_XYZ | D3DFVF_TEX1,                       D3DFVF_XYZRHW | D3DFVF_TEX1>(),
+  }};
+
+  ProcessVerticesRangeFn GetProcessVerticesRangeFn(DWORD inFVF, size_t inStride, DWORD outFVF, size_t outStride) {
+    for (const ProcessVerticesRangeEntry& entry : s_processVerticesRangeFns) {
+      if (entry.inFVF == inFVF && entry.outFVF == outFVF
+       && GetFVFSize(inFVF) == inStride && GetFVFSize(outFVF) == outStride)
+        return entry.fn;
+    }
+
+    return &ProcessVerticesRange<0, 0>;
+  }
+
+#ifdef DXVK_SWVP_SSE2
+  // Runs both kernels over the same random batches, with random state covering
+  // all of their code paths, and checks that their outputs are bit-exact
+  static bool ValidateProcessVerticesBatchSSE2() {
+    static constexpr uint32_t IterationCount = 256;
+
+    uint32_t seed = 0x9E3779B9u;
+    auto random = [&seed] (float min, float max) {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      return min + (max - min) * float(seed >> 8) * (1.0f / float(1u << 24));
+    };
+
+    auto randomMatrix = [&random] (D3DMATRIX& m) {
+      float* f = &m._11;
+      for (uint32_t i = 0; i < 16; i++)
+        f[i] = random(-1.0f, 1.0f);
+      // Keeps w well away from zero
+      m._44 = 4.0f;
+    };
+
+    auto randomColor = [&random] () {
+      return D3DCOLORVALUE{ random(0.0f, 1.0f), random(0.0f, 1.0f), random(0.0f, 1.0f), random(0.0f, 1.0f) };
+    };
+
+    static constexpr D3DFOGMODE FogModes[] = { D3DFOG_NONE, D3DFOG_EXP, D3DFOG_EXP2, D3DFOG_LINEAR };
+
+    std::array<PVLIGHT, 3> lights = { };
+
+    for (uint32_t iteration = 0; iteration < IterationCount; iteration++) {
+      const uint32_t flags = uint32_t(random(0.0f, 1024.0f));
+
+      ProcessVerticesState state = { };
+      randomMatrix(state.wvp);
+      randomMatrix(state.wv);
+      randomMatrix(state.normalMatrix);
+      state.viewportX                 = random(0.0f, 64.0f);
+      state.viewportY                 = random(0.0f, 64.0f);
+      state.viewportHalfWidth         = random(160.0f, 640.0f);
+      state.viewportHalfHeight        = random(120.0f, 480.0f);
+      state.viewportMinZ              = random(0.0f, 0.5f);
+      state.viewportZDelta            = random(0.5f, 1.0f);
+      state.doTransform               = flags & (1u << 0);
+      state.doLighting                = flags & (1u << 1);
+      state.doFog                     = flags & (1u << 2);
+      state.doPixelCenterOffset       = flags & (1u << 3);
+      state.hasNormals                = flags & (1u << 4);
+      state.isLegacy                  = flags & (1u << 5);
+      state.isEnabledFogRange         = flags & (1u << 6);
+      state.isEnabledNormalizeNormals = flags & (1u << 7);
+      state.isEnabledLocalViewer      = flags & (1u << 8);
+      state.fogVertexMode             = FogModes[iteration % std::size(FogModes)];
+      state.fogStart                  = random(0.0f, 2.0f);
+      state.fogEnd                    = state.fogStart + random(1.0f, 8.0f);
+      state.fogDensity                = random(0.0f, 1.0f);
+      state.materialPower             = (flags & (1u << 9)) ? random(1.0f, 32.0f) : 0.0f;
+      state.ambient                   = randomColor();
+
+      for (uint32_t l = 0; l < lights.size(); l++) {
+        PVLIGHT& light = lights[l];
+        light.Type           = l == 0 ? D3DLIGHT_DIRECTIONAL : l == 1 ? D3DLIGHT_POINT : D3DLIGHT_SPOT;
+        light.Diffuse        = randomColor();
+        light.Specular       = randomColor();
+        light.Ambient        = randomColor();
+        light.Range          = random(1.0f, 8.0f);
+        light.Falloff        = random(0.5f, 2.0f);
+        light.Attenuation0   = random(0.5f, 1.0f);
+        light.Attenuation1   = random(0.0f, 0.5f);
+        light.Attenuation2   = random(0.0f, 0.5f);
+        light.LightDirection = D3DVec3Normalize({ random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f) });
+        light.LightPosition  = { random(-4.0f, 4.0f), random(-4.0f, 4.0f), random(-4.0f, 4.0f) };
+        light.cosHalfPhi     = random(0.0f, 0.5f);
+        light.cosHalfTheta   = random(0.5f, 1.0f);
+      }
+
+      state.lights     = lights.data();
+      state.lightCount = lights.size();
+
+      ProcessVerticesBatch scalarBatch = { };
+
+      for (uint32_t i = 0; i < PVBatchSize; i++) {
+        scalarBatch.x[i]  = random(-2.0f, 2.0f);
+        scalarBatch.y[i]  = random(-2.0f, 2.0f);
+        scalarBatch.z[i]  = random(-2.0f, 2.0f);
+        scalarBatch.nx[i] = random(-1.0f, 1.0f);
+        scalarBatch.ny[i] = random(-1.0f, 1.0f);
+        scalarBatch.nz[i] = random(-1.0f, 1.0f);
+
+        for (uint32_t c = 0; c < 4; c++) {
+          scalarBatch.materialDiffuse[c][i]  = random(0.0f, 1.0f);
+          scalarBatch.materialSpecular[c][i] = random(0.0f, 1.0f);
+          scalarBatch.materialAmbient[c][i]  = random(0.0f, 1.0f);
+          scalarBatch.materialEmissive[c][i] = random(0.0f, 1.0f);
+        }
+      }
+
+      ProcessVerticesBatch simdBatch = scalarBatch;
+
+      ProcessVerticesBatchScalar(state, scalarBatch);
+      ProcessVerticesBatchSSE2(state, simdBatch);
+
+      if (unlikely(std::memcmp(&scalarBatch, &simdBatch, sizeof(ProcessVerticesBatch)) != 0)) {
+        Logger::err(str::format("ProcessVertices: SSE2 kernel output differs from the scalar kernel, state flags: 0x",
+                                std::hex, flags));
+        return false;
+      }
+    }
+
+    return true;
+  }
+#endif
+
+  ProcessVerticesBatchFn GetProcessVerticesBatchFn(const D3DOptions* options) {
+#ifdef DXVK_SWVP_SSE2
+    if (likely(options->simdProcessVertices)) {
+      // Only gets checked once, with the scalar kernel used on any mismatch
+      static const bool s_isSSE2Exact = ValidateProcessVerticesBatchSSE2();
+
+      if (likely(s_isSSE2Exact))
+        return &ProcessVerticesBatchSSE2;
+    }
+#endif
+
+    return &ProcessVerticesBatchScalar;
+  }
+
+}
@@ -4,9 +4,12 @@
 #include "ddraw_options.h"
 #include "ddraw_caps.h"
 
+#include "d3d_common_device.h"
 #include "d3d_common_viewport.h"
+#include "d3d_worker_pool.h"
 
 #include <algorithm>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -27,7 +30,10 @@ namespace dxvk {
     uint8_t* outData;
     const D3DMATRIX* correction;
     D3DSTATUS* dsStatus;
-    std::vector<d3d9::D3DLIGHT9>* lights;
+    D3DCommonViewport* viewport = nullptr;
+    D3DWorkerPool* workerPool = nullptr;
+    // Replaces inData and inStride for strided sources
+    const D3DDRAWPRIMITIVESTRIDEDDATA* strided = nullptr;
   };
 
   struct PVLIGHT {
@@ -53,6 +59,129 @@ namespace dxvk {
   using PositionArray = std::array<FLOAT, 8>;
   using TexCoordArray = std::array<std::array<FLOAT, 4>, ddrawCaps::MaxSimultaneousTextures>;
 
+  // Vertices are processed in batches, with their data laid out as SoA
+  static constexpr uint32_t PVBatchSize = 4;
+
+  // Smallest vertex count worth splitting up across worker threads
+  static constexpr uint32_t PVParallelThreshold = 4096;
+
+  struct ProcessVerticesState;
+  struct ProcessVerticesBatch;
+
+  using ProcessVerticesBatchFn = void (*)(const ProcessVerticesState& state, ProcessVerticesBatch& batch);
+
+  struct ProcessVerticesState {
+    D3DMATRIX wvp;
+    D3DMATRIX wv;
+    D3DMATRIX normalMatrix;
+    float viewportX;
+    float viewportY;
+    float viewportHalfWidth;
+    float viewportHalfHeight;
+    float viewportMinZ;
+    float viewportZDelta;
+    bool doTransform;
+    bool doLighting;
+    bool doFog;
+    bool doPixelCenterOffset;
+    bool hasNormals;
+    bool isLegacy;
+    bool isEnabledFogRange;
+    bool isEnabledNormalizeNormals;
+    bool isEnabledLocalViewer;
+    D3DFOGMODE fogVertexMode;
+    float fogStart;
+    float fogEnd;
+    float fogDensity;
+    float materialPower;
+    D3DCOLORVALUE ambient;
+    DWORD sourceDiffuse;
+    DWORD sourceSpecular;
+    DWORD sourceAmbient;
+    DWORD sourceEmissive;
+    D3DCOLORVALUE materialDiffuse;
+    D3DCOLORVALUE materialSpecular;
+    D3DCOLORVALUE materialAmbient;
+    D3DCOLORVALUE materialEmissive;
+    const PVLIGHT* lights;
+    size_t lightCount;
+    ProcessVerticesBatchFn processBatch;
+  };
+
+  struct ProcessVerticesBatch {
+    // Input position and normals
+    float x[PVBatchSize];
+    float y[PVBatchSize];
+    float z[PVBatchSize];
+    float nx[PVBatchSize];
+    float ny[PVBatchSize];
+    float nz[PVBatchSize];
+    // Input material colors, as resolved from their sources
+    float materialDiffuse[4][PVBatchSize];
+    float materialSpecular[4][PVBatchSize];
+    float materialAmbient[4][PVBatchSize];
+    float materialEmissive[4][PVBatchSize];
+    // Output position, colors and clip codes
+    float outX[PVBatchSize];
+    float outY[PVBatchSize];
+    float outZ[PVBatchSize];
+    float outRHW[PVBatchSize];
+    float diffuse[4][PVBatchSize];
+    float specular[4][PVBatchSize];
+    DWORD clipCode[PVBatchSize];
+  };
+
+  // Clip status and extents, as accumulated over a range of vertices
+  struct ProcessVerticesStatus {
+    DWORD clipUnion        = 0;
+    DWORD clipIntersection = D3DCLIP_LEFT | D3DCLIP_RIGHT | D3DCLIP_TOP | D3DCLIP_BOTTOM | D3DCLIP_FRONT | D3DCLIP_BACK;
+    float extentMinX       =  std::numeric_limits<float>::infinity();
+    float extentMinY       =  std::numeric_limits<float>::infinity();
+    float extentMaxX       = -std::numeric_limits<float>::infinity();
+    float extentMaxY       = -std::numeric_limits<float>::infinity();
+
+    void Merge(const ProcessVerticesStatus& other) {
+      clipUnion        |= other.clipUnion;
+      clipIntersection &= other.clipIntersection;
+      extentMinX        = std::min(extentMinX, other.extentMinX);
+      extentMinY        = std::min(extentMinY, other.extentMinY);
+      extentMaxX        = std::max(extentMaxX, other.extentMaxX);
+      extentMaxY        = std::max(extentMaxY, other.extentMaxY);
+    }
+  };
+
+  using ProcessVerticesRangeFn = void (*)(const ProcessVerticesData* pvData, const ProcessVerticesState& state,
+                                          uint32_t first, uint32_t count, ProcessVerticesStatus& status);
+
+  /**
+   * \brief Processes a batch one vertex at a time
+   *
+   * Serves as a reference for the SIMD kernel, and as a
+   * fallback on platforms without SSE2 support.
+   */
+  void ProcessVerticesBatchScalar(const ProcessVerticesState& state, ProcessVerticesBatch& batch);
+
+#ifdef DXVK_SWVP_SSE2
+  /**
+   * \brief Processes all vertices of a batch in parallel
+   *
+   * Follows the exact order of operations of the scalar
+   * kernel, so that both kernels produce the same output.
+   */
+  void ProcessVerticesBatchSSE2(const ProcessVerticesState& state, ProcessVerticesBatch& batch);
+#endif
+
+  ProcessVerticesBatchFn GetProcessVerticesBatchFn(const D3DOptions* options);
+
+  /**
+   * \brief Picks the range function for the given vertex formats
+   *
+   * Common FVF combinations have specialized functions, with all their
+   * strides and offsets known at compile time. Anything else goes
+   * through the generic function, which parses the FVFs per vertex.
+   */
+  ProcessVerticesRangeFn GetProcessVerticesRangeFn(DWORD inFVF, size_t inStride, DWORD outFVF, size_t outStride);
+
 #ifdef DXVK_SWVP_SSE2
   struct alignas(16) SIMDRow {
     __m128 lo; // Elements 0, 1, 2, 3
@@ -580,6 +709,44 @@ namespace dxvk {
     normal_matrix._33 = mv._33;
   }
 
+  // Converts a light to view space, returns false for unsupported light types
+  inline bool ConvertLightToPVLight(const D3DMATRIX& view, const d3d9::D3DLIGHT9& light, PVLIGHT& l) {
+    l = { };
+
+    l.Type     = D3DLIGHTTYPE(light.Type);
+    l.Ambient  = light.Ambient;
+    l.Diffuse  = light.Diffuse;
+    l.Specular = light.Specular;
+
+    switch (l.Type) {
+      case D3DLIGHT_DIRECTIONAL:
+        l.LightDirection = D3DVec3Normalize(D3DVec4to3Transform(view, {-light.Direction.x, -light.Direction.y, -light.Direction.z, 0.0f}));
+        break;
+      case D3DLIGHT_POINT:
+        l.LightPosition = D3DVec4to3Transform(view, {light.Position.x, light.Position.y, light.Position.z, 1.0f});
+        l.Attenuation0 = light.Attenuation0;
+        l.Attenuation1 = light.Attenuation1;
+        l.Attenuation2 = light.Attenuation2;
+        l.Range = light.Range;
+        break;
+      case D3DLIGHT_SPOT:
+        l.LightDirection = D3DVec3Normalize(D3DVec4to3Transform(view, {light.Direction.x, light.Direction.y, light.Direction.z, 0.0f}));
+        l.LightPosition = D3DVec4to3Transform(view, {light.Position.x, light.Position.y, light.Position.z, 1.0f});
+        l.cosHalfPhi = cosf(light.Phi / 2.0f);
+        l.cosHalfTheta = cosf(light.Theta / 2.0f);
+        l.Attenuation0 = light.Attenuation0;
+        l.Attenuation1 = light.Attenuation1;
+        l.Attenuation2 = light.Attenuation2;
+        l.Range = light.Range;
+        l.Falloff = light.Falloff;
+        break;
+      default:
+        return false;
+    }
+
+    return true;
+  }
+
   // D3DCOLOR is DWORD packed ARGB, uint8_t per component
   // D3DCOLORVALUE is RGBA struct with float per component normalized to 0.0f - 1.0f
   inline D3DCOLOR ColorVToColor(const D3DCOLORVALUE& c) {
@@ -708,9 +875,14 @@ namespace dxvk {
     }
   }
 
+  template <DWORD StaticFVF = 0>
   inline void ProcessVerticesInput(
         bool doNotCopyData, DWORD dwFVF, uint8_t *ptr, PositionArray& position, D3DVECTOR** normals,
         TexCoordArray& texCoords, D3DCOLOR** diffuse, D3DCOLOR** specular) {
+    // All FVF checks get folded at compile time for known FVFs
+    if constexpr (StaticFVF != 0)
+      dwFVF = StaticFVF;
+
     if (uint8_t type = (dwFVF & D3DFVF_POSITION_MASK)) {
       switch (type) {
         case D3DFVF_XYZ:
@@ -790,9 +962,42 @@ namespace dxvk {
     }
   }
 
+  // Same as ProcessVerticesInput, but gathers each vertex
+  // component from its own stream, as per the given FVF
+  inline void ProcessVerticesInputStrided(
+        bool doNotCopyData, DWORD dwFVF, const D3DDRAWPRIMITIVESTRIDEDDATA& strided, uint32_t index,
+        PositionArray& position, D3DVECTOR** normals, TexCoordArray& texCoords, D3DCOLOR** diffuse, D3DCOLOR** specular) {
+    auto element = [index] (const D3DDP_PTRSTRIDE& stream) {
+      return static_cast<uint8_t*>(stream.lpvData) + index * stream.dwStride;
+    };
+
+    memcpy(position.data(), element(strided.position), GetFVFPositionSize(dwFVF));
+
+    if (dwFVF & D3DFVF_NORMAL)
+      *normals = reinterpret_cast<D3DVECTOR*>(element(strided.normal));
+
+    if (dwFVF & D3DFVF_DIFFUSE)
+      *diffuse = reinterpret_cast<D3DCOLOR*>(element(strided.diffuse));
+
+    if (dwFVF & D3DFVF_SPECULAR)
+      *specular = reinterpret_cast<D3DCOLOR*>(element(strided.specular));
+
+    if (unlikely(doNotCopyData))
+      return;
+
+    const DWORD dwNumTextures = (dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT;
+    for (DWORD tex = 0; tex < dwNumTextures; tex++)
+      memcpy(texCoords[tex].data(), element(strided.textureCoords[tex]), GetFVFTexCoordSize(dwFVF, tex));
+  }
+
+  template <DWORD StaticFVF = 0>
   inline void ProcessVerticesOutput(
         DWORD dwFVF, uint8_t* ptr, const PositionArray& position, const D3DVECTOR* normals,
         TexCoordArray* texCoords, const D3DCOLOR* diffuse, const D3DCOLOR* specular) {
+    // All FVF checks get folded at compile time for known FVFs
+    if constexpr (StaticFVF != 0)
+      dwFVF = StaticFVF;
+
     if (uint8_t type = (dwFVF & D3DFVF_POSITION_MASK)) {
       switch (type) {
         case D3DFVF_XYZ:
@@ -876,33 +1081,27 @@ namespace dxvk {
   }
 
   inline void ProcessVerticesSW(
-        d3d9::IDirect3DDevice9* d3d9Device, const D3DOptions* options, ProcessVerticesData* pvData) {
+        D3DCommonDevice* commonDevice, const D3DOptions* options, ProcessVerticesData* pvData) {
     if (unlikely(pvData == nullptr)) {
       Logger::err("ProcessVerticesSW: Missing processing data");
       return;
     }
 
+    d3d9::IDirect3DDevice9* d3d9Device = commonDevice->GetD3D9Device();
+
     d3d9::D3DVIEWPORT9 viewport9;
-    D3DMATRIX world9, view9, projection9;
+    D3DMATRIX wv, wvp;
 
-    HRESULT hr = d3d9Device->GetViewport(&viewport9);
+    // Transforms and viewport are mirrored by the common device, along
+    // with the composite matrices, so these don't cross into D3D9
+    HRESULT hr = commonDevice->GetViewport(&viewport9);
     if (unlikely(FAILED(hr))) {
       Logger::err("ProcessVerticesSW: Failed to get D3D9 viewport");
       return;
     }
-    hr = d3d9Device->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_WORLD), &world9);
+    hr = commonDevice->GetWorldViewMatrices(&wv, &wvp);
     if (unlikely(FAILED(hr))) {
-      Logger::err("ProcessVerticesSW: Failed to get D3D9 world transform");
-      return;
-    }
-    hr = d3d9Device->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_VIEW), &view9);
-    if (unlikely(FAILED(hr))) {
-      Logger::err("ProcessVerticesSW: Failed to get D3D9 view transform");
-      return;
-    }
-    hr = d3d9Device->GetTransform(ConvertTransformState(D3DTRANSFORMSTATE_PROJECTION), &projection9);
-    if (unlikely(FAILED(hr))) {
-      Logger::err("ProcessVerticesSW: Failed to get D3D9 projection transform");
+      Logger::err("ProcessVerticesSW: Failed to get D3D9 world/view/projection transforms");
       return;
     }
 
@@ -913,24 +1112,23 @@ namespace dxvk {
     const DWORD viewport9Right      = viewport9.X + viewport9.Width;
     const DWORD viewport9Bottom     = viewport9.Y + viewport9.Height;
 
-    if (pvData->doClipping) {
-      if (pvData->dsStatus != nullptr && (pvData->dsStatus->dwFlags & D3DSETSTATUS_STATUS)) {
-        pvData->dsStatus->dwFlags = 0;
-        pvData->dsStatus->dwStatus = 0;
-        if (pvData->doExtents) {
-          pvData->dsStatus->dwFlags |= D3DSETSTATUS_EXTENTS;
-          pvData->dsStatus->drExtent.x1 = viewport9.X;
-          pvData->dsStatus->drExtent.y1 = viewport9.Y;
-          pvData->dsStatus->drExtent.x2 = viewport9Right;
-          pvData->dsStatus->drExtent.y2 = viewport9Bottom;
-        }
+    const bool doStatus = pvData->doClipping && pvData->dsStatus != nullptr
+                       && (pvData->dsStatus->dwFlags & D3DSETSTATUS_STATUS);
+
+    if (doStatus) {
+      pvData->dsStatus->dwFlags = 0;
+      pvData->dsStatus->dwStatus = 0;
+      if (pvData->doExtents) {
+        pvData->dsStatus->dwFlags |= D3DSETSTATUS_EXTENTS;
+        pvData->dsStatus->drExtent.x1 = viewport9.X;
+        pvData->dsStatus->drExtent.y1 = viewport9.Y;
+        pvData->dsStatus->drExtent.x2 = viewport9Right;
+        pvData->dsStatus->drExtent.y2 = viewport9Bottom;
       }
     }
 
-    const bool needsCorrection = pvData->isLegacy && pvData->correction != nullptr;
-    const D3DMATRIX wv         = D3DMatrixMultiply4x4(world9, view9);
-    const D3DMATRIX wvp        = !needsCorrection ? D3DMatrixMultiply4x4(wv, projection9)
-                                                  : D3DMatrixMultiply4x4(D3DMatrixMultiply4x4(wv, projection9), *pvData->correction);
+    if (pvData->isLegacy && pvData->correction != nullptr)
+      wvp = D3DMatrixMultiply4x4(wvp, *pvData->correction);
 
     D3DFOGMODE fogVertexMode;
     float fogStart, fogEnd, fogDensity;
@@ -968,189 +1166,116 @@ namespace dxvk {
     DWORD sourceDiffuse, sourceSpecular, sourceAmbient, sourceEmissive;
     MaterialColorSource(d3d9Device, pvData->inFVF, &sourceDiffuse, &sourceSpecular, &sourceAmbient, &sourceEmissive, useLighting);
 
-    std::vector<PVLIGHT> lights;
+    // Lights are cached by the common device, already converted to view space
+    const PVLIGHT* lights = nullptr;
+    size_t lightCount = 0;
+
     if (useLighting && (pvData->outFVF & (D3DFVF_DIFFUSE | D3DFVF_SPECULAR))) {
-      for (const d3d9::D3DLIGHT9& light : *pvData->lights) {
-        PVLIGHT* l = new PVLIGHT;
-
-        l->Type     = D3DLIGHTTYPE(light.Type);
-        l->Ambient  = light.Ambient;
-        l->Diffuse  = light.Diffuse;
-        l->Specular = light.Specular;
-
-        switch (l->Type) {
-            case D3DLIGHT_DIRECTIONAL:
-              l->LightDirection = D3DVec3Normalize(D3DVec4to3Transform(view9, {-light.Direction.x, -light.Direction.y, -light.Direction.z, 0.0f}));
-              break;
-            case D3DLIGHT_POINT:
-              l->LightPosition = D3DVec4to3Transform(view9, {light.Position.x, light.Position.y, light.Position.z, 1.0f});
-              l->Attenuation0 = light.Attenuation0;
-              l->Attenuation1 = light.Attenuation1;
-              l->Attenuation2 = light.Attenuation2;
-              l->Range = light.Range;
-              break;
-            case D3DLIGHT_SPOT:
-              l->LightDirection = D3DVec3Normalize(D3DVec4to3Transform(view9, {light.Direction.x, light.Direction.y, light.Direction.z, 0.0f}));
-              l->LightPosition = D3DVec4to3Transform(view9, {light.Position.x, light.Position.y, light.Position.z, 1.0f});
-              l->cosHalfPhi = cosf(light.Phi / 2.0f);
-              l->cosHalfTheta = cosf(light.Theta / 2.0f);
-              l->Attenuation0 = light.Attenuation0;
-              l->Attenuation1 = light.Attenuation1;
-              l->Attenuation2 = light.Attenuation2;
-              l->Range = light.Range;
-              l->Falloff = light.Falloff;
-              break;
-            default:
-              continue;
-        }
-        lights.push_back(*l);
-      }
+      const std::vector<PVLIGHT>& pvLights = commonDevice->GetProcessVerticesLights(pvData->viewport);
+      lights     = pvLights.data();
+      lightCount = pvLights.size();
     }
 
-    for (uint16_t t = 0; t < pvData->vertexCount; t++) {
-      uint8_t* inPtr = pvData->inData + t * pvData->inStride;
-      uint8_t* outPtr = pvData->outData + t * pvData->outStride;
-
-      PositionArray inPosition = { };
-      D3DVECTOR* inNormals = nullptr;
-      D3DCOLOR* inDiffuse  = nullptr;
-      D3DCOLOR* inSpecular = nullptr;
-      TexCoordArray inTexCoords = { };
-
-      ProcessVerticesInput(pvData->doNotCopyData, pvData->inFVF, inPtr, inPosition,
-                           &inNormals, inTexCoords, &inDiffuse, &inSpecular);
-
-      // Transform vertices
-      PositionArray outPosition;
-      memcpy(outPosition.data(), inPosition.data(), sizeof(PositionArray));
-      if (likely(!(pvData->inFVF & D3DFVF_XYZRHW))) {
-        D3DVECTOR4 h = D3DVec4Transform(wvp, D3DVECTOR4{inPosition[0], inPosition[1], inPosition[2], 1.0f});
-
-        // Hidden & Dangerous (D3D6) relies on division by zero and NAN/INF output
-        const float rhw = 1.0f / h.w;
-        outPosition[0] = viewport9.X + viewport9HalfWidth  * (h.x * rhw + 1.0f);
-        outPosition[1] = viewport9.Y + viewport9HalfHeight * (1.0f - h.y * rhw);
-        outPosition[2] = viewport9.MinZ + h.z * rhw * viewport9ZDelta;
-
-        // Native supposedly always write rhw without checking output, be more sane until that become a real problem
-        if (likely(pvData->outFVF & D3DFVF_XYZRHW))
-          outPosition[3] = rhw;
-
-        // Alternate pixel center workaround for the Resident Evil quad alignment problem
-        if (unlikely(options->alternatePixelCenter == AlternatePixelCenter::Legacy)) {
-          outPosition[0] -= 0.5f;
-          outPosition[1] -= 0.5f;
-        }
-      }
-
-      D3DCOLORVALUE diffuse  = {0.0f, 0.0f, 0.0f, 0.0f};
-      D3DCOLORVALUE specular = {0.0f, 0.0f, 0.0f, 0.0f};
-
-      D3DVECTOR4 WVPosition = D3DVec4Transform(wv, D3DVECTOR4{inPosition[0], inPosition[1], inPosition[2], 1.0f});
-      const D3DVECTOR WVPosition3 = {WVPosition.x, WVPosition.y, WVPosition.z};
-      const float positionScale = 1.0f / WVPosition.w;
-      WVPosition.x *= positionScale;
-      WVPosition.y *= positionScale;
-      WVPosition.z *= positionScale;
-
-      D3DCOLORVALUE materialDiffuse  = ColorFromMaterialSource(inDiffuse, inSpecular, sourceDiffuse,  material9.Diffuse);
-      D3DCOLORVALUE materialSpecular = ColorFromMaterialSource(inDiffuse, inSpecular, sourceSpecular, material9.Specular);
-
-      if (useLighting && (pvData->outFVF & (D3DFVF_DIFFUSE | D3DFVF_SPECULAR))) {
-        const D3DVECTOR NVWPosition = D3DVec3Normalize(WVPosition3);
-        D3DVECTOR normals;
-        if (inNormals != nullptr) {
-          D3DMATRIX normalMatrix{};
-          ComputeNormalMatrix(normalMatrix, pvData->isLegacy, wv);
-          normals = D3DVec3Transform(normalMatrix, *inNormals);
-          if (isEnabledNormalizeNormals)
-            normals = D3DVec3Normalize(normals);
-        }
-
-        D3DCOLORVALUE ambient = ambientStateColorValue;
-
-        for (const PVLIGHT& light : lights) {
-          D3DVECTOR hitDirection;
-          float attenuation;
-          const D3DLIGHTTYPE lightType = D3DLIGHTTYPE(light.Type);
-          switch (lightType) {
-            case D3DLIGHT_DIRECTIONAL: {
-              hitDirection = light.LightDirection;
-              attenuation = 1.0f;
-              break;
-            }
-            case D3DLIGHT_POINT:
-            case D3DLIGHT_SPOT: {
-              hitDirection = D3DVECTOR{light.LightPosition.x - WVPosition.x, light.LightPosition.y - WVPosition.y,
-                                       light.LightPosition.z - WVPosition.z};
-              Vector4 destination(1.0f, 0.0f, D3DVec3Dot(&hitDirection, &hitDirection), 0.0f);
-              destination.y = std::sqrtf(destination.z);
-              if (pvData->isLegacy) {
-                destination.y = (light.Range - destination.y) / light.Range;
-                if (destination.y <= 0.0f)
-                  continue;
-                destination.z = destination.y * destination.y;
-              } else {
-                if (destination.y > light.Range)
-                  continue;
-              }
-
-              hitDirection = D3DVec3Normalize(hitDirection);
-              attenuation = destination.x * light.Attenuation0 + destination.y *
-                            light.Attenuation1 + destination.z * light.Attenuation2;
-
-              if (!pvData->isLegacy)
-                attenuation = 1.0f / attenuation;
-
-              if (lightType == D3DLIGHT_SPOT) {
-                const D3DVECTOR revHit = {-hitDirection.x, -hitDirection.y, -hitDirection.z};
-                const float rho = D3DVec3Dot(&revHit, &light.LightDirection);
-                if (rho <= light.cosHalfPhi)
-                  attenuation = 0.0f;
-                else if (rho <= light.cosHalfTheta)
-                  attenuation *= powf((rho - light.cosHalfPhi) / (light.cosHalfTheta - light.cosHalfPhi), light.Falloff);
-              }
-              break;
-            }
-            default:
-              Logger::warn(str::format("ProcessVerticesSW: Invalid light type: ", lightType));
-              continue;
-          }
-
-          ColorVMultiplyAdd(ambient, light.Ambient, attenuation);
-          if (inNormals != nullptr)
-            ApplyLight(&light, isEnabledLocalViewer, diffuse, specular, &normals,
-                     &hitDirection, &NVWPosition, attenuation, materialPower, pvData->isLegacy);
-        }
+    ProcessVerticesState state;
+    state.wvp                       = wvp;
+    state.wv                        = wv;
+    state.viewportX                 = static_cast<float>(viewport9.X);
+    state.viewportY                 = static_cast<float>(viewport9.Y);
+    state.viewportHalfWidth         = viewport9HalfWidth;
+    state.viewportHalfHeight        = viewport9HalfHeight;
+    state.viewportMinZ              = viewport9.MinZ;
+    state.viewportZDelta            = viewport9ZDelta;
+    state.doTransform               = !(pvData->inFVF & D3DFVF_XYZRHW);
+    state.doLighting                = useLighting && (pvData->outFVF & (D3DFVF_DIFFUSE | D3DFVF_SPECULAR));
+    state.doFog                     = isEnabledFog;
+    state.doPixelCenterOffset       = options->alternatePixelCenter == AlternatePixelCenter::Legacy;
+    state.hasNormals                = pvData->inFVF & D3DFVF_NORMAL;
+    state.isLegacy                  = pvData->isLegacy;
+    state.isEnabledFogRange         = isEnabledFog && isEnabledFogRange;
+    state.isEnabledNormalizeNormals = state.doLighting && isEnabledNormalizeNormals;
+    state.isEnabledLocalViewer      = state.doLighting && isEnabledLocalViewer;
+    state.fogVertexMode             = fogVertexMode;
+    state.fogStart                  = isEnabledFog ? fogStart   : 0.0f;
+    state.fogEnd                    = isEnabledFog ? fogEnd     : 0.0f;
+    state.fogDensity                = isEnabledFog ? fogDensity : 0.0f;
+    state.materialPower             = materialPower;
+    state.ambient                   = ambientStateColorValue;
+    state.sourceDiffuse             = sourceDiffuse;
+    state.sourceSpecular            = sourceSpecular;
+    state.sourceAmbient             = sourceAmbient;
+    state.sourceEmissive            = sourceEmissive;
+    state.materialDiffuse           = material9.Diffuse;
+    state.materialSpecular          = material9.Specular;
+    state.materialAmbient           = material9.Ambient;
+    state.materialEmissive          = material9.Emissive;
+    state.lights                    = lights;
+    state.lightCount                = lightCount;
+    state.processBatch              = GetProcessVerticesBatchFn(options);
+
+    // The normal matrix is the same for all vertices
+    state.normalMatrix = { };
+    if (state.doLighting && state.hasNormals)
+      commonDevice->GetNormalMatrix(pvData->isLegacy, &state.normalMatrix);
+
+    const ProcessVerticesRangeFn processRange = GetProcessVerticesRangeFn(
+      pvData->inFVF, pvData->inStride, pvData->outFVF, pvData->outStride);
+
+    ProcessVerticesStatus status;
+
+    if (pvData->workerPool != nullptr && pvData->vertexCount >= PVParallelThreshold) {
+      // Chunks start on cache line boundaries of the output data, so that no
+      // two threads ever write to the same line, and hold whole batches. The
+      // output can start at any vertex of a locked buffer, so the boundaries
+      // need to be found from its absolute address. Should no vertex ever
+      // start on a line boundary, neighbouring chunks share one line.
+      const uint32_t lineVertices = 64u / std::gcd<uint32_t>(pvData->outStride, 64u);
+      const uint32_t granularity  = std::lcm<uint32_t>(lineVertices, PVBatchSize);
+
+      const uintptr_t outAddress = reinterpret_cast<uintptr_t>(pvData->outData);
+
+      uint32_t firstLineVertex = 0;
+      while (firstLineVertex < lineVertices && (outAddress + firstLineVertex * pvData->outStride) % 64u)
+        firstLineVertex++;
+
+      if (firstLineVertex == lineVertices)
+        firstLineVertex = 0;
+
+      // The first chunk also takes any vertices before the first line boundary
+      const uint32_t chunkTarget = pvData->workerPool->GetThreadCount() * 4u;
+      const uint32_t chunkSize   = align(pvData->vertexCount / chunkTarget + 1u, granularity);
+      const uint32_t chunkCount  = (pvData->vertexCount - firstLineVertex + chunkSize - 1u) / chunkSize;
+
+      std::vector<ProcessVerticesStatus> chunkStatus(chunkCount);
+
+      pvData->workerPool->Run(chunkCount, [&] (uint32_t chunk) {
+        const uint32_t first = chunk ? firstLineVertex + chunk * chunkSize : 0u;
+        const uint32_t end   = std::min<uint32_t>(firstLineVertex + (chunk + 1u) * chunkSize, pvData->vertexCount);
+        const uint32_t count = end - first;
+
+        processRange(pvData, state, first, count, chunkStatus[chunk]);
+      });
+
+      // Merge in chunk order, the result does not depend on scheduling
+      for (const ProcessVerticesStatus& chunk : chunkStatus)
+        status.Merge(chunk);
+    } else {
+      processRange(pvData, state, 0, pvData->vertexCount, status);
+    }
 
-        D3DCOLORVALUE materialAmbient  = ColorFromMaterialSource(inDiffuse, inSpecular, sourceAmbient, material9.Ambient);
-        D3DCOLORVALUE materialEmissive = ColorFromMaterialSource(inDiffuse, inSpecular, sourceEmissive, material9.Emissive);
+    if (doStatus) {
+      // Vertices which are already transformed don't take part in clipping
+      if (!state.doTransform || !pvData->vertexCount)
+        status.clipIntersection = 0;
 
-        diffuse.r = D3DMad2AddScalar(ambient.r, materialAmbient.r, diffuse.r, materialDiffuse.r, materialEmissive.r);
-        diffuse.g = D3DMad2AddScalar(ambient.g, materialAmbient.g, diffuse.g, materialDiffuse.g, materialEmissive.g);
-        diffuse.b = D3DMad2AddScalar(ambient.b, materialAmbient.b, diffuse.b, materialDiffuse.b, materialEmissive.b);
-        diffuse.a = materialDiffuse.a;
+      pvData->dsStatus->dwStatus |= status.clipUnion | (status.clipIntersection << 12);
 
-        D3DColorMulRGBSetAlpha(specular, materialSpecular, pvData->isLegacy);
-      } else {
-        diffuse  = materialDiffuse;
-        specular = materialSpecular;
+      // Extents are the bounding rectangle of all transformed vertices, within the viewport
+      if (pvData->doExtents && status.extentMinX <= status.extentMaxX && status.extentMinY <= status.extentMaxY) {
+        pvData->dsStatus->drExtent.x1 = static_cast<LONG>(std::clamp(std::floor(status.extentMinX), state.viewportX, static_cast<float>(viewport9Right)));
+        pvData->dsStatus->drExtent.y1 = static_cast<LONG>(std::clamp(std::floor(status.extentMinY), state.viewportY, static_cast<float>(viewport9Bottom)));
+        pvData->dsStatus->drExtent.x2 = static_cast<LONG>(std::clamp(std::ceil(status.extentMaxX),  state.viewportX, static_cast<float>(viewport9Right)));
+        pvData->dsStatus->drExtent.y2 = static_cast<LONG>(std::clamp(std::ceil(status.extentMaxY),  state.viewportY, static_cast<float>(viewport9Bottom)));
       }
-
-      if (isEnabledFog)
-        ApplyFog(&specular.a, fogVertexMode, fogDensity, fogStart, fogEnd, isEnabledFogRange, WVPosition3);
-
-      D3DColorClamp(diffuse);
-      D3DColorClamp(specular);
-
-      const D3DCOLOR outDiffuse  = ColorVToColor(diffuse);
-      const D3DCOLOR outSpecular = ColorVToColor(specular);
-
-      ProcessVerticesOutput(pvData->outFVF, outPtr, outPosition,
-                            (!pvData->doNotCopyData ? inNormals : nullptr),
-                            (!pvData->doNotCopyData ? &inTexCoords : nullptr),
-                            (!pvData->doNotCopyData ? &outDiffuse : nullptr),
-                            (!pvData->doNotCopyData ? &outSpecular : nullptr));
     }
   }
 
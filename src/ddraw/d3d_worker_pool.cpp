@@ -0,0 +1,88 @@
+#include "d3d_worker_pool.h"
+
+#include "../util/util_env.h"
+
+namespace dxvk {
+
+  D3DWorkerPool::D3DWorkerPool(uint32_t threadCount) {
+    for (uint32_t i = 1; i < threadCount; i++)
+      m_workers.emplace_back([this] { RunWorker(); });
+
+    Logger::info(str::format("D3DWorkerPool: Using ", threadCount, " threads for vertex processing"));
+  }
+
+  D3DWorkerPool::~D3DWorkerPool() {
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+
+    m_jobCond.notify_all();
+
+    for (dxvk::thread& worker : m_workers)
+      worker.join();
+  }
+
+  void D3DWorkerPool::Run(uint32_t jobCount, const Job& job) {
+    std::lock_guard<dxvk::mutex> runLock(m_runMutex);
+
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_job      = &job;
+      m_jobCount = jobCount;
+      m_nextJob.store(0u);
+      m_generation++;
+    }
+
+    m_jobCond.notify_all();
+
+    ExecuteJobs(job, jobCount);
+
+    // All job indices have been claimed at this point, but some
+    // workers may still be busy, and the job must outlive them
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, [this] { return !m_activeWorkers; });
+    m_job = nullptr;
+  }
+
+  void D3DWorkerPool::ExecuteJobs(const Job& job, uint32_t jobCount) {
+    uint32_t index;
+
+    while ((index = m_nextJob.fetch_add(1u)) < jobCount)
+      job(index);
+  }
+
+  void D3DWorkerPool::RunWorker() {
+    env::setThreadName("d7vk-worker");
+
+    uint64_t generation = 0;
+
+    while (true) {
+      const Job* job;
+      uint32_t jobCount;
+
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        m_jobCond.wait(lock, [this, generation] {
+          return m_stopped || (m_job != nullptr && m_generation != generation);
+        });
+
+        if (m_stopped)
+          return;
+
+        generation = m_generation;
+        job        = m_job;
+        jobCount   = m_jobCount;
+
+        m_activeWorkers++;
+      }
+
+      ExecuteJobs(*job, jobCount);
+
+      { std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+        if (!(--m_activeWorkers))
+          m_doneCond.notify_one();
+      }
+    }
+  }
+
+}
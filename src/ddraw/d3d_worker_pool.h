@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ddraw_include.h"
+
+#include "../util/thread.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Worker pool
+   *
+   * Small set of persistent threads, used to split up large
+   * chunks of CPU work, such as vertex processing. The calling
+   * thread always takes part in the work, so a pool created
+   * with N threads only ever spawns N - 1 worker threads.
+   */
+  class D3DWorkerPool : public RcObject {
+
+  public:
+
+    using Job = std::function<void (uint32_t)>;
+
+    D3DWorkerPool(uint32_t threadCount);
+
+    ~D3DWorkerPool();
+
+    uint32_t GetThreadCount() const {
+      return m_workers.size() + 1;
+    }
+
+    /**
+     * \brief Runs a job for each index in [0, jobCount)
+     *
+     * Returns once all job indices have been processed.
+     * Concurrent calls from multiple threads get serialized.
+     */
+    void Run(uint32_t jobCount, const Job& job);
+
+  private:
+
+    dxvk::mutex               m_runMutex;
+
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_jobCond;
+    dxvk::condition_variable  m_doneCond;
+
+    bool                      m_stopped       = false;
+    uint64_t                  m_generation    = 0;
+    uint32_t                  m_activeWorkers = 0;
+
+    const Job*                m_job           = nullptr;
+    uint32_t                  m_jobCount      = 0;
+    std::atomic<uint32_t>     m_nextJob       = { 0u };
+
+    std::vector<dxvk::thread> m_workers;
+
+    void ExecuteJobs(const Job& job, uint32_t jobCount);
+
+    void RunWorker();
+
+  };
+
+}
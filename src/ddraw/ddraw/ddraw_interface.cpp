@@ -652,9 +652,7 @@ namespace dxvk {
     if (unlikely(commonDevice != nullptr && !m_commonIntf->GetWaitForVBlank())) {
       Logger::info("DDrawInterface::WaitForVerticalBlank: Switching to D3DPRESENT_INTERVAL_DEFAULT for presentation");
 
-      d3d9::D3DPRESENT_PARAMETERS resetParams = *commonDevice->GetPresentParameters();
-      resetParams.PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
-      HRESULT hr = commonDevice->ResetD3D9Swapchain(&resetParams);
+      HRESULT hr = commonDevice->SetPresentationInterval(D3DPRESENT_INTERVAL_DEFAULT);
       if (likely(SUCCEEDED(hr)))
         m_commonIntf->SetWaitForVBlank(true);
     }
@@ -61,6 +61,10 @@ namespace dxvk {
       }
     }
 
+    // Mip sub-levels and cube map faces report their changes to the top level surface
+    if (m_parentSurf != nullptr)
+      m_commonSurf->AttachToMipChain(m_parentSurf->GetCommonSurface());
+
     DDrawCommonInterface::AddWrappedSurface(this);
 
     m_commonSurf->SetDDSurface(this);
@@ -344,6 +348,9 @@ namespace dxvk {
       m_nextFlippable = attachedSurf;
     }
 
+    // Attachment changes can alter the cached mip chains
+    RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -360,18 +367,26 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers or depth stencils on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = lpDDSrcSurface != nullptr ?
+        static_cast<DDrawSurface*>(lpDDSrcSurface)->GetCommonSurface() : nullptr;
+      if (SUCCEEDED(m_commonSurf->BltD3D9(sourceCommonSurf, lpDestRect, lpSrcRect, dwFlags, lpDDBltFx)))
+        return DD_OK;
+    }
+
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDrawSurface* sourceSurface = static_cast<DDrawSurface*>(lpDDSrcSurface);
-      sourceSurface->DownloadSurfaceData();
+      sourceSurface->DownloadSurfaceData(lpSrcRect);
     }
     // No point in downloading the destination surface if it's going to be overwritten
     if ((lpDDBltFx == nullptr || (dwFlags & DDBLT_COLORFILL) || (dwFlags & DDBLT_DEPTHFILL)) &&
          m_commonSurf->IsFullSurfaceLock(lpDestRect, nullptr)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(lpDestRect);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -386,6 +401,7 @@ namespace dxvk {
 
         if (sourceSurface == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -402,7 +418,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(lpDestRect);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -420,7 +436,33 @@ namespace dxvk {
 
   // Docs: "The IDirectDrawSurface::BltBatch method is not currently implemented."
   HRESULT STDMETHODCALLTYPE DDrawSurface::BltBatch(LPDDBLTBATCH lpDDBltBatch, DWORD dwCount, DWORD dwFlags) {
-    return DDERR_UNSUPPORTED;
+    if (unlikely(lpDDBltBatch == nullptr || dwFlags != 0))
+      return DDERR_INVALIDPARAMS;
+
+    // Walk the batch as a series of regular blits, which lets
+    // each entry take the GPU path whenever that is possible
+    for (DWORD i = 0; i < dwCount; i++) {
+      const DDBLTBATCH& batch = lpDDBltBatch[i];
+      LPDIRECTDRAWSURFACE srcSurface = batch.lpDDSSrc;
+
+      HRESULT hr;
+      if (likely(srcSurface == nullptr || DDrawCommonInterface::IsWrappedSurface(srcSurface))) {
+        hr = Blt(batch.lprDest, srcSurface, batch.lprSrc, batch.dwFlags, batch.lpDDBltFx);
+      } else {
+        // Foreign source surfaces can only be handled by the proxied surface
+        DownloadSurfaceData(batch.lprDest);
+
+        DDBLTBATCH proxiedBatch = batch;
+        hr = GetShadowOrProxied()->BltBatch(&proxiedBatch, 1, 0);
+        if (likely(SUCCEEDED(hr)))
+          m_commonSurf->DirtyDDrawSurface(batch.lprDest);
+      }
+
+      if (unlikely(FAILED(hr)))
+        return hr;
+    }
+
+    return DD_OK;
   }
 
   HRESULT STDMETHODCALLTYPE DDrawSurface::BltFast(DWORD dwX, DWORD dwY, LPDIRECTDRAWSURFACE lpDDSrcSurface, LPRECT lpSrcRect, DWORD dwTrans) {
@@ -430,20 +472,29 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr && lpDDSrcSurface != nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = static_cast<DDrawSurface*>(lpDDSrcSurface)->GetCommonSurface();
+      if (SUCCEEDED(m_commonSurf->BltFastD3D9(sourceCommonSurf, dwX, dwY, lpSrcRect, dwTrans)))
+        return DD_OK;
+    }
+
     const RECT* sourceFullSurfaceRect = nullptr;
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDrawSurface* sourceSurface = static_cast<DDrawSurface*>(lpDDSrcSurface);
-      sourceSurface->DownloadSurfaceData();
+      sourceSurface->DownloadSurfaceData(lpSrcRect);
       sourceFullSurfaceRect = sourceSurface->GetCommonSurface()->GetFullSurfaceRect();
     }
+    RECT destRect = { };
+    const bool hasDestRect = DDrawCommonSurface::GetBltFastDestRect(dwX, dwY, lpSrcRect, sourceFullSurfaceRect, &destRect);
     // No point in downloading the destination surface if it's going to be overwritten
     if (dwX == 0 && dwY == 0 && (dwTrans & DDBLTFAST_NOCOLORKEY) &&
         m_commonSurf->IsFullSurfaceLock(lpSrcRect, sourceFullSurfaceRect)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(hasDestRect ? &destRect : nullptr);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -458,6 +509,7 @@ namespace dxvk {
 
         if (sourceSurface == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -474,7 +526,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(hasDestRect ? &destRect : nullptr);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -505,6 +557,9 @@ namespace dxvk {
       // If lpDDSAttachedSurface is NULL, then all surfaces are detached
       m_depthStencil = nullptr;
 
+      // Attachment changes can alter the cached mip chains
+      RefreshMipChains();
+
       return DD_OK;
     }
 
@@ -524,6 +579,9 @@ namespace dxvk {
       m_nextFlippable = nullptr;
     }
 
+    // Attachment changes can alter the cached mip chains
+    RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -618,15 +676,17 @@ namespace dxvk {
       if (likely(m_nextFlippable != nullptr)) {
         if (m_commonIntf->GetOptions()->emulateFrontBuffer) {
           InitializeOrUploadD3D9();
-          // Workaround for front buffer image retention issues
+          // Workaround for front buffer image retention issues, which only
+          // needs to mirror what has been written on the DDraw side
           if (m_shadowSurf != nullptr && m_nextFlippable->GetCommonSurface()->IsDDrawSurfaceDirty())
-            GetShadowOrProxied()->BltFast(0, 0, m_nextFlippable->GetShadowOrProxied(), nullptr, DDBLTFAST_NOCOLORKEY);
+            m_nextFlippable->GetCommonSurface()->CopyDirtyDDrawRects(m_commonSurf.ptr(), GetShadowOrProxied(), m_nextFlippable->GetShadowOrProxied());
         }
         m_nextFlippable->InitializeOrUploadD3D9();
       } else {
         InitializeOrUploadD3D9();
       }
 
+      m_commonIntf->AdvanceFrame();
       d3d9Device->Present(NULL, NULL, NULL, NULL);
 
     } else {
@@ -718,6 +778,7 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE DDrawSurface::GetDC(HDC *lphDC) {
     // Direct D3D9 path which can sometimes be faster (and other times slower)
     if (unlikely(m_commonIntf->GetOptions()->forceDCForwarding && m_commonSurf->IsInitialized())) {
+      m_commonSurf->FlushBatchedDraws();
       InitializeOrUploadD3D9();
 
       HRESULT hr = m_commonSurf->GetD3D9Surface()->GetDC(lphDC);
@@ -794,9 +855,16 @@ namespace dxvk {
 
   HRESULT STDMETHODCALLTYPE DDrawSurface::Lock(LPRECT lpDestRect, LPDDSURFACEDESC lpDDSurfaceDesc, DWORD dwFlags, HANDLE hEvent) {
     // Write back any dirty surface data from bound D3D9 back buffers or depth stencils
-    DownloadSurfaceData();
+    DownloadSurfaceData(lpDestRect);
+
+    HRESULT hr = GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // The locked area will get marked as dirty on unlock
+    m_commonSurf->TrackLockRect(lpDestRect);
 
-    return GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE DDrawSurface::ReleaseDC(HDC hDC) {
@@ -930,7 +998,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurfaceOnUnlock();
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
@@ -1048,13 +1116,18 @@ namespace dxvk {
       }
     }
 
-    if (likely(m_commonSurf->IsInitialized()))
-      return UploadSurfaceData();
+    if (likely(m_commonSurf->IsInitialized())) {
+      HRESULT hr = UploadSurfaceData();
+      m_commonSurf->ReleaseEvictableDDrawStorage();
+      return hr;
+    }
 
     return DD_OK;
   }
 
-  void DDrawSurface::DownloadSurfaceData() {
+  void DDrawSurface::DownloadSurfaceData(const RECT* lpRect) {
+    m_commonSurf->FlushBatchedDraws();
+
     // Some games, like The Settlers IV, use multiple devices for rendering, one to handle
     // terrain and the overall 3D scene, and one to create textures/sprites to overlay on
     // top of it. Since DXVK's D3D9 backend does not restrict cross-device surface/texture
@@ -1063,19 +1136,41 @@ namespace dxvk {
     if (likely(!m_commonIntf->GetOptions()->deviceResourceSharing))
       m_commonSurf->RefreshD3D9Device();
 
+    // Push out any queued DDraw side writes first, so the read back doesn't overwrite them
+    if (unlikely(m_commonSurf->IsDDrawSurfaceDirty() && !m_commonSurf->IsDDrawRectValid(lpRect)))
+      InitializeOrUploadD3D9();
+
+    // GPU side writes, such as D3D7 Load calls or released storage, get read back on demand
+    if (unlikely(m_commonSurf->GetMipChainRoot()->HasStaleMips()))
+      m_commonSurf->DownloadStaleMips();
+
     if (unlikely(m_commonSurf->IsD3D9BackBuffer())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDrawSurface::DownloadSurfaceData: Downloading nr. [[1-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
-                                                              m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     } else if (unlikely(m_commonSurf->IsD3D9DepthStencil())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDrawSurface::DownloadSurfaceData: Downloading nr. [[1-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
-                                                              m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     }
   }
@@ -1116,12 +1211,27 @@ namespace dxvk {
         Logger::debug(str::format("DDrawSurface::InitializeD3D9: Mismatch with declared ", desc->dwMipMapCount, " mip levels"));
     }
 
+    ListMipChain(m_proxy.ptr(), m_mipMaps.data(), mipCount);
+
     if (unlikely(m_commonIntf->GetOptions()->autoGenMipMaps))
       mipCount = 0;
 
     m_commonSurf->SetMipCount(mipCount);
   }
 
+  void DDrawSurface::RefreshMipChains() {
+    DDrawCommonSurface* rootSurf  = m_commonSurf->GetMipChainRoot();
+    DDrawSurface*       rootSurf1 = rootSurf->GetDDSurface();
+
+    // Chains only get cached once the D3D9 texture is initialized
+    if (rootSurf1 == nullptr || !rootSurf->IsInitialized() || !rootSurf->IsTexture())
+      return;
+
+    const uint16_t mipCount = std::max<uint16_t>(rootSurf->GetMipCount(), 1);
+
+    ListMipChain(rootSurf1->m_proxy.ptr(), rootSurf1->m_mipMaps.data(), mipCount);
+  }
+
   inline HRESULT DDrawSurface::UploadSurfaceData() {
     // Fast skip
     if (!m_commonSurf->IsDDrawSurfaceDirty())
@@ -1130,12 +1240,19 @@ namespace dxvk {
     //Logger::debug(str::format("DDrawSurface::UploadSurfaceData: Uploading nr. [[1-", std::hex, this, "]]"));
 
     if (m_commonSurf->IsTexture()) {
-      BlitToD3D9Texture<IDirectDrawSurface, DDSURFACEDESC>(m_commonSurf->GetD3D9Texture(), m_proxy.ptr(),
-                                                           m_commonSurf->GetMipCount(), m_commonSurf->IsDXTFormat());
+      uint64_t* mipHashes = m_commonSurf->GetMipHashes();
+      const uint32_t skippedMips = BlitToD3D9Texture<IDirectDrawSurface, DDSURFACEDESC>(m_commonSurf->GetD3D9Texture(), m_mipMaps.data(),
+                                                                                        m_commonSurf->GetMipCount(), m_commonSurf->GetDirtyMips(),
+                                                                                        m_commonSurf->IsDXTFormat(),
+                                                                                        m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount(),
+                                                                                        mipHashes);
+      if (unlikely(mipHashes != nullptr))
+        m_commonIntf->TrackTextureUploadHashes(m_commonSurf->GetDirtyMipCount(), skippedMips);
     // Blit surfaces directly
     } else {
       BlitToD3D9Surface<IDirectDrawSurface, DDSURFACEDESC>(m_commonSurf->GetD3D9Surface(), GetShadowOrProxied(),
-                                                           m_commonSurf->IsDXTFormat());
+                                                           m_commonSurf->IsDXTFormat(),
+                                                           m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount());
     }
 
     m_commonSurf->UnDirtyDDrawSurface();
@@ -1261,9 +1378,8 @@ namespace dxvk {
     params.PresentationInterval       = D3DPRESENT_INTERVAL_DEFAULT; // A D3D3 device always uses VSync
 
     Com<d3d9::IDirect3DDevice9> device9;
-    HRESULT hr = commonD3DIntf->GetD3D9Interface()->CreateDevice(
-      D3DADAPTER_DEFAULT,
-      d3d9::D3DDEVTYPE_HAL,
+    HRESULT hr = commonD3DIntf->CreateD3D9Device(
+      m_commonIntf,
       hWnd,
       deviceCreationFlags9,
       &params,
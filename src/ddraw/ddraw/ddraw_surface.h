@@ -109,10 +109,18 @@ namespace dxvk {
 
     HRESULT InitializeOrUploadD3D9();
 
-    void DownloadSurfaceData();
+    void DownloadSurfaceData(const RECT* lpRect = nullptr);
 
     void UpdateMipMapCount();
 
+    // Lists the mip chain cached on the chain root again, since
+    // attaching or detaching surfaces can change its levels
+    void RefreshMipChains();
+
+    IDirectDrawSurface* const* GetMipMaps() const {
+      return m_mipMaps.data();
+    }
+
     void SetShadowSurface(Com<DDrawSurface>&& shadowSurf) {
       m_shadowSurf = shadowSurf;
     }
@@ -206,6 +214,9 @@ namespace dxvk {
 
     DDrawSurface*             m_parentSurf    = nullptr;
 
+    // Mip chains get cached on initialization, to avoid walking them on every upload
+    std::array<IDirectDrawSurface*, ddrawCaps::MaxMipLevels> m_mipMaps = { };
+
     Com<D3D3Texture, false>   m_texture3;
     Com<D3D5Texture, false>   m_texture5;
 
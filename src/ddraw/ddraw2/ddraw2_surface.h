@@ -108,7 +108,7 @@ namespace dxvk {
 
     HRESULT InitializeOrUploadD3D9();
 
-    void DownloadSurfaceData();
+    void DownloadSurfaceData(const RECT* lpRect = nullptr);
 
     void SetShadowSurface(Com<DDraw2Surface>&& shadowSurf) {
       m_shadowSurf = shadowSurf;
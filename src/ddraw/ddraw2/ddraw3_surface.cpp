@@ -86,6 +86,10 @@ namespace dxvk {
       }
     }
 
+    // Mip sub-levels and cube map faces report their changes to the top level surface
+    if (m_parentSurf != nullptr)
+      m_commonSurf->AttachToMipChain(m_parentSurf->GetCommonSurface());
+
     DDrawCommonInterface::AddWrappedSurface(this);
 
     m_commonSurf->SetDD3Surface(this);
@@ -275,6 +279,10 @@ namespace dxvk {
       m_parent->SetNextFlippable(attachedSurfParent);
     }
 
+    // Attachment changes can alter the cached mip chains
+    if (likely(m_parent != nullptr))
+      m_parent->RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -295,18 +303,26 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers or depth stencils on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = lpDDSrcSurface != nullptr ?
+        static_cast<DDraw3Surface*>(lpDDSrcSurface)->GetCommonSurface() : nullptr;
+      if (SUCCEEDED(m_commonSurf->BltD3D9(sourceCommonSurf, lpDestRect, lpSrcRect, dwFlags, lpDDBltFx)))
+        return DD_OK;
+    }
+
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDraw3Surface* sourceSurf = static_cast<DDraw3Surface*>(lpDDSrcSurface);
-      sourceSurf->DownloadSurfaceData();
+      sourceSurf->DownloadSurfaceData(lpSrcRect);
     }
     // No point in downloading the destination surface if it's going to be overwritten
     if ((lpDDBltFx == nullptr || (dwFlags & DDBLT_COLORFILL) || (dwFlags & DDBLT_DEPTHFILL)) &&
          m_commonSurf->IsFullSurfaceLock(lpDestRect, nullptr)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(lpDestRect);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -322,6 +338,7 @@ namespace dxvk {
 
         if (sourceSurfOrig == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -338,7 +355,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(lpDestRect);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -356,7 +373,33 @@ namespace dxvk {
 
   // Docs: "The IDirectDrawSurface3::BltBatch method is not currently implemented."
   HRESULT STDMETHODCALLTYPE DDraw3Surface::BltBatch(LPDDBLTBATCH lpDDBltBatch, DWORD dwCount, DWORD dwFlags) {
-    return DDERR_UNSUPPORTED;
+    if (unlikely(lpDDBltBatch == nullptr || dwFlags != 0))
+      return DDERR_INVALIDPARAMS;
+
+    // Walk the batch as a series of regular blits, which lets
+    // each entry take the GPU path whenever that is possible
+    for (DWORD i = 0; i < dwCount; i++) {
+      const DDBLTBATCH& batch = lpDDBltBatch[i];
+      LPDIRECTDRAWSURFACE3 srcSurface = reinterpret_cast<LPDIRECTDRAWSURFACE3>(batch.lpDDSSrc);
+
+      HRESULT hr;
+      if (likely(srcSurface == nullptr || DDrawCommonInterface::IsWrappedSurface(srcSurface))) {
+        hr = Blt(batch.lprDest, srcSurface, batch.lprSrc, batch.dwFlags, batch.lpDDBltFx);
+      } else {
+        // Foreign source surfaces can only be handled by the proxied surface
+        DownloadSurfaceData(batch.lprDest);
+
+        DDBLTBATCH proxiedBatch = batch;
+        hr = GetShadowOrProxied()->BltBatch(&proxiedBatch, 1, 0);
+        if (likely(SUCCEEDED(hr)))
+          m_commonSurf->DirtyDDrawSurface(batch.lprDest);
+      }
+
+      if (unlikely(FAILED(hr)))
+        return hr;
+    }
+
+    return DD_OK;
   }
 
   HRESULT STDMETHODCALLTYPE DDraw3Surface::BltFast(DWORD dwX, DWORD dwY, LPDIRECTDRAWSURFACE3 lpDDSrcSurface, LPRECT lpSrcRect, DWORD dwTrans) {
@@ -370,20 +413,29 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr && lpDDSrcSurface != nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = static_cast<DDraw3Surface*>(lpDDSrcSurface)->GetCommonSurface();
+      if (SUCCEEDED(m_commonSurf->BltFastD3D9(sourceCommonSurf, dwX, dwY, lpSrcRect, dwTrans)))
+        return DD_OK;
+    }
+
     const RECT* sourceFullSurfaceRect = nullptr;
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDraw3Surface* sourceSurf = static_cast<DDraw3Surface*>(lpDDSrcSurface);
-      sourceSurf->DownloadSurfaceData();
+      sourceSurf->DownloadSurfaceData(lpSrcRect);
       sourceFullSurfaceRect = sourceSurf->GetCommonSurface()->GetFullSurfaceRect();
     }
+    RECT destRect = { };
+    const bool hasDestRect = DDrawCommonSurface::GetBltFastDestRect(dwX, dwY, lpSrcRect, sourceFullSurfaceRect, &destRect);
     // No point in downloading the destination surface if it's going to be overwritten
     if (dwX == 0 && dwY == 0 && (dwTrans & DDBLTFAST_NOCOLORKEY) &&
         m_commonSurf->IsFullSurfaceLock(lpSrcRect, sourceFullSurfaceRect)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(hasDestRect ? &destRect : nullptr);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -399,6 +451,7 @@ namespace dxvk {
 
         if (sourceSurfOrig == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -415,7 +468,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(hasDestRect ? &destRect : nullptr);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -450,6 +503,10 @@ namespace dxvk {
       // If lpDDSAttachedSurface is NULL, then all surfaces are detached
       m_depthStencil = nullptr;
 
+      // Attachment changes can alter the cached mip chains
+      if (likely(m_parent != nullptr))
+        m_parent->RefreshMipChains();
+
       return DD_OK;
     }
 
@@ -469,6 +526,10 @@ namespace dxvk {
       m_parent->SetNextFlippable(nullptr);
     }
 
+    // Attachment changes can alter the cached mip chains
+    if (likely(m_parent != nullptr))
+      m_parent->RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -526,15 +587,17 @@ namespace dxvk {
       if (likely(nextFlippable != nullptr)) {
         if (m_commonIntf->GetOptions()->emulateFrontBuffer) {
           InitializeOrUploadD3D9();
-          // Workaround for front buffer image retention issues
+          // Workaround for front buffer image retention issues, which only
+          // needs to mirror what has been written on the DDraw side
           if (m_shadowSurf != nullptr && nextFlippable->GetCommonSurface()->IsDDrawSurfaceDirty())
-            m_parent->GetShadowOrProxied()->BltFast(0, 0, nextFlippable->GetShadowOrProxied(), nullptr, DDBLTFAST_NOCOLORKEY);
+            nextFlippable->GetCommonSurface()->CopyDirtyDDrawRects(m_commonSurf.ptr(), m_parent->GetShadowOrProxied(), nextFlippable->GetShadowOrProxied());
         }
         nextFlippable->InitializeOrUploadD3D9();
       } else {
         InitializeOrUploadD3D9();
       }
 
+      m_commonIntf->AdvanceFrame();
       d3d9Device->Present(NULL, NULL, NULL, NULL);
 
     } else {
@@ -626,6 +689,7 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE DDraw3Surface::GetDC(HDC *lphDC) {
     // Direct D3D9 path which can sometimes be faster (and other times slower)
     if (unlikely(m_commonIntf->GetOptions()->forceDCForwarding && m_commonSurf->IsInitialized())) {
+      m_commonSurf->FlushBatchedDraws();
       InitializeOrUploadD3D9();
 
       HRESULT hr = m_commonSurf->GetD3D9Surface()->GetDC(lphDC);
@@ -702,9 +766,16 @@ namespace dxvk {
 
   HRESULT STDMETHODCALLTYPE DDraw3Surface::Lock(LPRECT lpDestRect, LPDDSURFACEDESC lpDDSurfaceDesc, DWORD dwFlags, HANDLE hEvent) {
     // Write back any dirty surface data from bound D3D9 back buffers or depth stencils
-    DownloadSurfaceData();
+    DownloadSurfaceData(lpDestRect);
 
-    return GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    HRESULT hr = GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // The locked area will get marked as dirty on unlock
+    m_commonSurf->TrackLockRect(lpDestRect);
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE DDraw3Surface::ReleaseDC(HDC hDC) {
@@ -838,7 +909,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurfaceOnUnlock();
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
@@ -913,6 +984,9 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE DDraw3Surface::SetSurfaceDesc(LPDDSURFACEDESC lpDDSD, DWORD dwFlags) {
+    // Any released texture storage needs to be in place beforehand
+    m_commonSurf->PinDDrawStorage();
+
     // Can be used only to set the surface data and pixel format
     // used by an explicit system-memory surface (will be validated)
     HRESULT hr = m_proxy->SetSurfaceDesc(lpDDSD, dwFlags);
@@ -960,13 +1034,18 @@ namespace dxvk {
       }
     }
 
-    if (likely(m_commonSurf->IsInitialized()))
-      return UploadSurfaceData();
+    if (likely(m_commonSurf->IsInitialized())) {
+      HRESULT hr = UploadSurfaceData();
+      m_commonSurf->ReleaseEvictableDDrawStorage();
+      return hr;
+    }
 
     return DD_OK;
   }
 
-  void DDraw3Surface::DownloadSurfaceData() {
+  void DDraw3Surface::DownloadSurfaceData(const RECT* lpRect) {
+    m_commonSurf->FlushBatchedDraws();
+
     // Some games, like The Settlers IV, use multiple devices for rendering, one to handle
     // terrain and the overall 3D scene, and one to create textures/sprites to overlay on
     // top of it. Since DXVK's D3D9 backend does not restrict cross-device surface/texture
@@ -975,19 +1054,41 @@ namespace dxvk {
     if (likely(!m_commonIntf->GetOptions()->deviceResourceSharing))
       m_commonSurf->RefreshD3D9Device();
 
+    // Push out any queued DDraw side writes first, so the read back doesn't overwrite them
+    if (unlikely(m_commonSurf->IsDDrawSurfaceDirty() && !m_commonSurf->IsDDrawRectValid(lpRect)))
+      InitializeOrUploadD3D9();
+
+    // GPU side writes, such as D3D7 Load calls or released storage, get read back on demand
+    if (unlikely(m_commonSurf->GetMipChainRoot()->HasStaleMips()))
+      m_commonSurf->DownloadStaleMips();
+
     if (unlikely(m_commonSurf->IsD3D9BackBuffer())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDraw3Surface::DownloadSurfaceData: Downloading nr. [[3-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
-                                                               m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                 m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                 m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     } else if (unlikely(m_commonSurf->IsD3D9DepthStencil())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDraw3Surface::DownloadSurfaceData: Downloading nr. [[3-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
-                                                               m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                 m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface3, DDSURFACEDESC>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                 m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     }
   }
@@ -1000,12 +1101,20 @@ namespace dxvk {
     //Logger::debug(str::format("DDraw3Surface::UploadSurfaceData: Uploading nr. [[3-", std::hex, this, "]]"));
 
     if (m_commonSurf->IsTexture()) {
-      BlitToD3D9Texture<IDirectDrawSurface3, DDSURFACEDESC>(m_commonSurf->GetD3D9Texture(), m_proxy.ptr(),
-                                                            m_commonSurf->GetMipCount(), m_commonSurf->IsDXTFormat());
+      uint64_t* mipHashes = m_commonSurf->GetMipHashes();
+      // The mip chain is cached on the IDirectDrawSurface origin
+      const uint32_t skippedMips = BlitToD3D9Texture<IDirectDrawSurface, DDSURFACEDESC>(m_commonSurf->GetD3D9Texture(), m_parent->GetMipMaps(),
+                                                                                        m_commonSurf->GetMipCount(), m_commonSurf->GetDirtyMips(),
+                                                                                        m_commonSurf->IsDXTFormat(),
+                                                                                        m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount(),
+                                                                                        mipHashes);
+      if (unlikely(mipHashes != nullptr))
+        m_commonIntf->TrackTextureUploadHashes(m_commonSurf->GetDirtyMipCount(), skippedMips);
     // Blit surfaces directly
     } else {
       BlitToD3D9Surface<IDirectDrawSurface3, DDSURFACEDESC>(m_commonSurf->GetD3D9Surface(), GetShadowOrProxied(),
-                                                            m_commonSurf->IsDXTFormat());
+                                                            m_commonSurf->IsDXTFormat(),
+                                                            m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount());
     }
 
     m_commonSurf->UnDirtyDDrawSurface();
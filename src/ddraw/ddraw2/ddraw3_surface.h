@@ -110,7 +110,7 @@ namespace dxvk {
 
     HRESULT InitializeOrUploadD3D9();
 
-    void DownloadSurfaceData();
+    void DownloadSurfaceData(const RECT* lpRect = nullptr);
 
     void SetShadowSurface(Com<DDraw3Surface>&& shadowSurf) {
       m_shadowSurf = shadowSurf;
@@ -125,7 +125,7 @@ namespace dxvk {
 
     HRESULT InitializeOrUploadD3D9();
 
-    void DownloadSurfaceData();
+    void DownloadSurfaceData(const RECT* lpRect = nullptr);
 
     void SetShadowSurface(Com<DDraw4Surface>&& shadowSurf) {
       m_shadowSurf = shadowSurf;
@@ -185,6 +185,9 @@ namespace dxvk {
 
     inline void UpdateMipMapCount();
 
+    // Lists the mip chain cached on the chain root again
+    inline void RefreshMipChains();
+
     inline HRESULT UploadSurfaceData();
 
     bool                    m_isChildObject = true;
@@ -194,6 +197,9 @@ namespace dxvk {
 
     DDraw4Surface*          m_parentSurf    = nullptr;
 
+    // Mip chains get cached on initialization, to avoid walking them on every upload
+    std::array<IDirectDrawSurface4*, ddrawCaps::MaxMipLevels> m_mipMaps = { };
+
     Com<D3D3Texture, false> m_texture3;
     // D3D5Texture (aka IDirect3DTexture2) is shared between D3D5 and D3D6
     Com<D3D5Texture, false> m_texture6;
@@ -58,6 +58,10 @@ namespace dxvk {
       }
     }
 
+    // Mip sub-levels and cube map faces report their changes to the top level surface
+    if (m_parentSurf != nullptr)
+      m_commonSurf->AttachToMipChain(m_parentSurf->GetCommonSurface());
+
     DDrawCommonInterface::AddWrappedSurface(this);
 
     m_commonSurf->SetDD7Surface(this);
@@ -71,8 +75,10 @@ namespace dxvk {
     if (m_parent != nullptr && m_isChildObject)
       m_parent->AddRef();
 
-    // Cube map face surfaces
-    m_cubeMapSurfaces.fill(nullptr);
+    // Mip maps and cube map face surfaces
+    m_mipMaps.fill(nullptr);
+    for (auto& cubeMapFace : m_cubeMapSurfaces)
+      cubeMapFace.fill(nullptr);
 
     //Logger::debug(str::format("DDraw7Surface: Created a new surface nr. [[7-", std::hex, this, "]]"));
 
@@ -250,6 +256,9 @@ namespace dxvk {
     attachedSurf->SetParentSurface(this);
     m_depthStencil = attachedSurf;
 
+    // Attachment changes can alter the cached mip chains
+    RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -265,18 +274,26 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers or depth stencils on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = lpDDSrcSurface != nullptr ?
+        static_cast<DDraw7Surface*>(lpDDSrcSurface)->GetCommonSurface() : nullptr;
+      if (SUCCEEDED(m_commonSurf->BltD3D9(sourceCommonSurf, lpDestRect, lpSrcRect, dwFlags, lpDDBltFx)))
+        return DD_OK;
+    }
+
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDraw7Surface* sourceSurface = static_cast<DDraw7Surface*>(lpDDSrcSurface);
-      sourceSurface->DownloadSurfaceData();
+      sourceSurface->DownloadSurfaceData(lpSrcRect);
     }
     // No point in downloading the destination surface if it's going to be overwritten
     if ((lpDDBltFx == nullptr || (dwFlags & DDBLT_COLORFILL) || (dwFlags & DDBLT_DEPTHFILL)) &&
          m_commonSurf->IsFullSurfaceLock(lpDestRect, nullptr)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(lpDestRect);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -291,6 +308,7 @@ namespace dxvk {
 
         if (sourceSurface == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -307,7 +325,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(lpDestRect);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -325,7 +343,33 @@ namespace dxvk {
 
   // Docs: "The IDirectDrawSurface7::BltBatch method is not currently implemented."
   HRESULT STDMETHODCALLTYPE DDraw7Surface::BltBatch(LPDDBLTBATCH lpDDBltBatch, DWORD dwCount, DWORD dwFlags) {
-    return DDERR_UNSUPPORTED;
+    if (unlikely(lpDDBltBatch == nullptr || dwFlags != 0))
+      return DDERR_INVALIDPARAMS;
+
+    // Walk the batch as a series of regular blits, which lets
+    // each entry take the GPU path whenever that is possible
+    for (DWORD i = 0; i < dwCount; i++) {
+      const DDBLTBATCH& batch = lpDDBltBatch[i];
+      LPDIRECTDRAWSURFACE7 srcSurface = reinterpret_cast<LPDIRECTDRAWSURFACE7>(batch.lpDDSSrc);
+
+      HRESULT hr;
+      if (likely(srcSurface == nullptr || DDrawCommonInterface::IsWrappedSurface(srcSurface))) {
+        hr = Blt(batch.lprDest, srcSurface, batch.lprSrc, batch.dwFlags, batch.lpDDBltFx);
+      } else {
+        // Foreign source surfaces can only be handled by the proxied surface
+        DownloadSurfaceData(batch.lprDest);
+
+        DDBLTBATCH proxiedBatch = batch;
+        hr = GetShadowOrProxied()->BltBatch(&proxiedBatch, 1, 0);
+        if (likely(SUCCEEDED(hr)))
+          m_commonSurf->DirtyDDrawSurface(batch.lprDest);
+      }
+
+      if (unlikely(FAILED(hr)))
+        return hr;
+    }
+
+    return DD_OK;
   }
 
   HRESULT STDMETHODCALLTYPE DDraw7Surface::BltFast(DWORD dwX, DWORD dwY, LPDIRECTDRAWSURFACE7 lpDDSrcSurface, LPRECT lpSrcRect, DWORD dwTrans) {
@@ -335,20 +379,29 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
+    // Keep blits targeting D3D9 back buffers on the GPU, if possible
+    if (likely(m_shadowSurf == nullptr && lpDDSrcSurface != nullptr)) {
+      DDrawCommonSurface* sourceCommonSurf = static_cast<DDraw7Surface*>(lpDDSrcSurface)->GetCommonSurface();
+      if (SUCCEEDED(m_commonSurf->BltFastD3D9(sourceCommonSurf, dwX, dwY, lpSrcRect, dwTrans)))
+        return DD_OK;
+    }
+
     const RECT* sourceFullSurfaceRect = nullptr;
     // Write back any dirty surface data from bound D3D9 back buffers or
     // depth stencils, for both the source surface and the current surface
     if (likely(lpDDSrcSurface != nullptr)) {
       DDraw7Surface* sourceSurface = static_cast<DDraw7Surface*>(lpDDSrcSurface);
-      sourceSurface->DownloadSurfaceData();
+      sourceSurface->DownloadSurfaceData(lpSrcRect);
       sourceFullSurfaceRect = sourceSurface->GetCommonSurface()->GetFullSurfaceRect();
     }
+    RECT destRect = { };
+    const bool hasDestRect = DDrawCommonSurface::GetBltFastDestRect(dwX, dwY, lpSrcRect, sourceFullSurfaceRect, &destRect);
     // No point in downloading the destination surface if it's going to be overwritten
     if (dwX == 0 && dwY == 0 && (dwTrans & DDBLTFAST_NOCOLORKEY) &&
         m_commonSurf->IsFullSurfaceLock(lpSrcRect, sourceFullSurfaceRect)) {
       m_commonSurf->UnDirtyD3D9Surface();
     } else {
-      DownloadSurfaceData();
+      DownloadSurfaceData(hasDestRect ? &destRect : nullptr);
     }
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
@@ -363,6 +416,7 @@ namespace dxvk {
 
         if (sourceSurface == renderTarget) {
           renderTarget->InitializeOrUploadD3D9();
+          m_commonIntf->AdvanceFrame();
           d3d9Device->Present(NULL, NULL, NULL, NULL);
           return DD_OK;
         }
@@ -379,7 +433,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurface(hasDestRect ? &destRect : nullptr);
 
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
       const bool shouldPresent = m_commonIntf->GetOptions()->legacyPresentGuard == D3DLegacyPresentGuard::Auto ?
@@ -411,6 +465,9 @@ namespace dxvk {
       // If lpDDSAttachedSurface is NULL, then all surfaces are detached
       m_depthStencil = nullptr;
 
+      // Attachment changes can alter the cached mip chains
+      RefreshMipChains();
+
       return DD_OK;
     }
 
@@ -425,6 +482,9 @@ namespace dxvk {
     if (likely(m_depthStencil == attachedSurf))
       m_depthStencil = nullptr;
 
+    // Attachment changes can alter the cached mip chains
+    RefreshMipChains();
+
     return DD_OK;
   }
 
@@ -511,32 +571,28 @@ namespace dxvk {
         return DDERR_NOTFLIPPABLE;
 
       // If the interface is waiting for VBlank and we get a no VSync flip, switch
-      // to doing immediate presents by resetting the swapchain appropriately
+      // to doing immediate presents, which only changes the D3D9 present mode
       if (unlikely(m_commonIntf->GetWaitForVBlank() && (dwFlags & DDFLIP_NOVSYNC))) {
-        Logger::info("DDraw7Surface::Flip: Switching to D3DPRESENT_INTERVAL_IMMEDIATE for presentation");
+        Logger::debug("DDraw7Surface::Flip: Switching to D3DPRESENT_INTERVAL_IMMEDIATE for presentation");
 
         D3DCommonDevice* commonD3DDevice = m_commonSurf->GetCommonD3DDevice();
 
-        d3d9::D3DPRESENT_PARAMETERS resetParams = *commonD3DDevice->GetPresentParameters();
-        resetParams.PresentationInterval = D3DPRESENT_INTERVAL_IMMEDIATE;
-        HRESULT hrReset = commonD3DDevice->ResetD3D9Swapchain(&resetParams);
-        if (unlikely(FAILED(hrReset))) {
-          Logger::warn("DDraw7Surface::Flip: Failed D3D9 swapchain reset");
+        HRESULT hrInterval = commonD3DDevice->SetPresentationInterval(D3DPRESENT_INTERVAL_IMMEDIATE);
+        if (unlikely(FAILED(hrInterval))) {
+          Logger::warn("DDraw7Surface::Flip: Failed to change the D3D9 presentation interval");
         } else {
           m_commonIntf->SetWaitForVBlank(false);
         }
       // If the interface is not waiting for VBlank and we stop getting DDFLIP_NOVSYNC
-      // flags, reset the swapchain in order to return to VSync presentation using DEFAULT
+      // flags, return to VSync presentation using DEFAULT
       } else if (unlikely(!m_commonIntf->GetWaitForVBlank() && IsVSyncFlipFlag(dwFlags))) {
-        Logger::info("DDraw7Surface::Flip: Switching to D3DPRESENT_INTERVAL_DEFAULT for presentation");
+        Logger::debug("DDraw7Surface::Flip: Switching to D3DPRESENT_INTERVAL_DEFAULT for presentation");
 
         D3DCommonDevice* commonD3DDevice = m_commonSurf->GetCommonD3DDevice();
 
-        d3d9::D3DPRESENT_PARAMETERS resetParams = *commonD3DDevice->GetPresentParameters();
-        resetParams.PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
-        HRESULT hrReset = commonD3DDevice->ResetD3D9Swapchain(&resetParams);
-        if (unlikely(FAILED(hrReset))) {
-          Logger::warn("DDraw7Surface::Flip: Failed D3D9 swapchain reset");
+        HRESULT hrInterval = commonD3DDevice->SetPresentationInterval(D3DPRESENT_INTERVAL_DEFAULT);
+        if (unlikely(FAILED(hrInterval))) {
+          Logger::warn("DDraw7Surface::Flip: Failed to change the D3D9 presentation interval");
         } else {
           m_commonIntf->SetWaitForVBlank(true);
         }
@@ -551,15 +607,17 @@ namespace dxvk {
       if (likely(m_nextFlippable != nullptr)) {
         if (m_commonIntf->GetOptions()->emulateFrontBuffer) {
           InitializeOrUploadD3D9();
-          // Workaround for front buffer image retention issues
+          // Workaround for front buffer image retention issues, which only
+          // needs to mirror what has been written on the DDraw side
           if (m_shadowSurf != nullptr && m_nextFlippable->GetCommonSurface()->IsDDrawSurfaceDirty())
-            GetShadowOrProxied()->BltFast(0, 0, m_nextFlippable->GetShadowOrProxied(), nullptr, DDBLTFAST_NOCOLORKEY);
+            m_nextFlippable->GetCommonSurface()->CopyDirtyDDrawRects(m_commonSurf.ptr(), GetShadowOrProxied(), m_nextFlippable->GetShadowOrProxied());
         }
         m_nextFlippable->InitializeOrUploadD3D9();
       } else {
         InitializeOrUploadD3D9();
       }
 
+      m_commonIntf->AdvanceFrame();
       d3d9Device->Present(NULL, NULL, NULL, NULL);
 
     } else {
@@ -654,6 +712,7 @@ namespace dxvk {
   HRESULT STDMETHODCALLTYPE DDraw7Surface::GetDC(HDC *lphDC) {
     // Direct D3D9 path which can sometimes be faster (and other times slower)
     if (unlikely(m_commonIntf->GetOptions()->forceDCForwarding && m_commonSurf->IsInitialized())) {
+      m_commonSurf->FlushBatchedDraws();
       InitializeOrUploadD3D9();
 
       HRESULT hr = m_commonSurf->GetD3D9Surface()->GetDC(lphDC);
@@ -730,9 +789,16 @@ namespace dxvk {
 
   HRESULT STDMETHODCALLTYPE DDraw7Surface::Lock(LPRECT lpDestRect, LPDDSURFACEDESC2 lpDDSurfaceDesc, DWORD dwFlags, HANDLE hEvent) {
     // Write back any dirty surface data from bound D3D9 back buffers or depth stencils
-    DownloadSurfaceData();
+    DownloadSurfaceData(lpDestRect);
 
-    return GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    HRESULT hr = GetShadowOrProxied()->Lock(lpDestRect, lpDDSurfaceDesc, dwFlags, hEvent);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // The locked area will get marked as dirty on unlock
+    m_commonSurf->TrackLockRect(lpDestRect);
+
+    return hr;
   }
 
   HRESULT STDMETHODCALLTYPE DDraw7Surface::ReleaseDC(HDC hDC) {
@@ -866,7 +932,7 @@ namespace dxvk {
     if (unlikely(FAILED(hr)))
       return hr;
 
-    m_commonSurf->DirtyDDrawSurface();
+    m_commonSurf->DirtyDDrawSurfaceOnUnlock();
 
     d3d9::IDirect3DDevice9* d3d9Device = m_commonSurf->GetRefreshedD3D9Device();
     if (unlikely(m_shadowSurf != nullptr && d3d9Device != nullptr)) {
@@ -941,6 +1007,9 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE DDraw7Surface::SetSurfaceDesc(LPDDSURFACEDESC2 lpDDSD, DWORD dwFlags) {
+    // Any released texture storage needs to be in place beforehand
+    m_commonSurf->PinDDrawStorage();
+
     // Can be used only to set the surface data and pixel format
     // used by an explicit system-memory surface (will be validated)
     HRESULT hr = m_proxy->SetSurfaceDesc(lpDDSD, dwFlags);
@@ -1146,13 +1215,18 @@ namespace dxvk {
         InitializeAllCubeMapSurfaces();
     }
 
-    if (likely(m_commonSurf->IsInitialized()))
-      return UploadSurfaceData();
+    if (likely(m_commonSurf->IsInitialized())) {
+      HRESULT hr = UploadSurfaceData();
+      m_commonSurf->ReleaseEvictableDDrawStorage();
+      return hr;
+    }
 
     return DD_OK;
   }
 
-  void DDraw7Surface::DownloadSurfaceData() {
+  void DDraw7Surface::DownloadSurfaceData(const RECT* lpRect) {
+    m_commonSurf->FlushBatchedDraws();
+
     // Some games, like The Settlers IV, use multiple devices for rendering, one to handle
     // terrain and the overall 3D scene, and one to create textures/sprites to overlay on
     // top of it. Since DXVK's D3D9 backend does not restrict cross-device surface/texture
@@ -1161,23 +1235,81 @@ namespace dxvk {
     if (likely(!m_commonIntf->GetOptions()->deviceResourceSharing))
       m_commonSurf->RefreshD3D9Device();
 
+    // Push out any queued DDraw side writes first, so the read back doesn't overwrite them
+    if (unlikely(m_commonSurf->IsDDrawSurfaceDirty() && !m_commonSurf->IsDDrawRectValid(lpRect)))
+      InitializeOrUploadD3D9();
+
+    // Mips written on the GPU, such as through D3D7 Load calls, are read back on demand
+    if (unlikely(m_commonSurf->GetMipChainRoot()->HasStaleMips()))
+      DownloadStaleMips();
+
     if (unlikely(m_commonSurf->IsD3D9BackBuffer())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDraw7Surface::DownloadSurfaceData: Downloading nr. [[7-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
-                                                                m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                  m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(GetShadowOrProxied(), m_commonSurf->GetD3D9Surface(),
+                                                                  m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     } else if (unlikely(m_commonSurf->IsD3D9DepthStencil())) {
-      if (m_commonSurf->IsInitialized() && m_commonSurf->IsD3D9SurfaceDirty()) {
+      if (m_commonSurf->IsInitialized() && !m_commonSurf->IsDDrawRectValid(lpRect)) {
         //Logger::debug(str::format("DDraw7Surface::DownloadSurfaceData: Downloading nr. [[7-", std::hex, this, "]]"));
-        BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
-                                                                m_commonSurf->IsDXTFormat());
-        m_commonSurf->UnDirtyD3D9Surface();
+        // Only read back the requested rect, if it can be tracked as valid
+        RECT validRect;
+        if (m_commonSurf->TrackValidDDrawRect(lpRect, &validRect)) {
+          BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                  m_commonSurf->IsDXTFormat(), &validRect);
+        } else {
+          BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(m_proxy.ptr(), m_commonSurf->GetD3D9Surface(),
+                                                                  m_commonSurf->IsDXTFormat());
+          m_commonSurf->UnDirtyD3D9Surface();
+        }
       }
     }
   }
 
+  void DDraw7Surface::DownloadStaleMips() {
+    DDrawCommonSurface* rootSurf = m_commonSurf->GetMipChainRoot();
+
+    // Released storage needs to be put back in place before reading into it
+    if (unlikely(rootSurf->IsDDrawStorageReleased()))
+      rootSurf->RestoreDDrawStorage();
+
+    const bool isDXTFormat = m_commonSurf->IsDXTFormat();
+
+    auto downloadMip = [rootSurf, isDXTFormat] (IDirectDrawSurface7* surface, uint32_t face, uint32_t level) {
+      if (surface == nullptr || !(rootSurf->GetStaleMips(face) & (1u << level)))
+        return;
+
+      Com<d3d9::IDirect3DSurface9> surface9 = rootSurf->GetD3D9MipSurface(face, level);
+      if (likely(surface9 != nullptr))
+        BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(surface, surface9.ptr(), isDXTFormat);
+
+      rootSurf->UnStaleDDrawMip(face, level);
+    };
+
+    // Mip sub-levels and cube map faces only read back their own data
+    if (rootSurf != m_commonSurf.ptr()) {
+      downloadMip(m_proxy.ptr(), m_commonSurf->GetMipChainFace(), m_commonSurf->GetMipChainLevel());
+    } else if (m_commonSurf->IsCubeMap()) {
+      const uint16_t mipCount = std::min<uint16_t>(m_commonSurf->GetMipCount(), ddrawCaps::MaxMipLevels);
+      for (uint32_t face = 0; face < ddrawCaps::MaxCubeMapFaces; face++) {
+        for (uint32_t level = 0; level < mipCount; level++)
+          downloadMip(m_cubeMapSurfaces[face][level], face, level);
+      }
+    } else {
+      const uint16_t mipCount = std::min<uint16_t>(m_commonSurf->GetMipCount(), ddrawCaps::MaxMipLevels);
+      for (uint32_t level = 0; level < mipCount; level++)
+        downloadMip(m_mipMaps[level], 0, level);
+    }
+  }
+
   inline void DDraw7Surface::UpdateMipMapCount() {
     // We need to count the number of actual mips on initialization by going through
     // the mip chain, since the dwMipMapCount number may or may not be accurate. I am
@@ -1214,12 +1346,40 @@ namespace dxvk {
         Logger::debug(str::format("DDraw7Surface::UpdateMipMapCount: Mismatch with declared ", desc2->dwMipMapCount, " mip levels"));
     }
 
+    ListMipChain(m_proxy.ptr(), m_mipMaps.data(), mipCount);
+
     if (unlikely(m_commonIntf->GetOptions()->autoGenMipMaps))
       mipCount = 0;
 
     m_commonSurf->SetMipCount(mipCount);
   }
 
+  inline void DDraw7Surface::RefreshMipChains() {
+    DDrawCommonSurface* rootSurf  = m_commonSurf->GetMipChainRoot();
+    DDraw7Surface*      rootSurf7 = rootSurf->GetDD7Surface();
+
+    // Chains only get cached once the D3D9 texture is initialized
+    if (rootSurf7 == nullptr || !rootSurf->IsInitialized() || !rootSurf->IsTextureOrCubeMap())
+      return;
+
+    const uint16_t mipCount = std::max<uint16_t>(rootSurf->GetMipCount(), 1);
+
+    ListMipChain(rootSurf7->m_proxy.ptr(), rootSurf7->m_mipMaps.data(), mipCount);
+
+    if (rootSurf->IsCubeMap()) {
+      CubeMapAttachedSurfaces cubeMapAttachedSurfaces;
+      rootSurf7->m_proxy->EnumAttachedSurfaces(&cubeMapAttachedSurfaces, EnumAndAttachCubeMapFacesCallback);
+
+      // Faces which are no longer around get listed as empty chains
+      ListMipChain(rootSurf7->m_proxy.ptr(),         rootSurf7->m_cubeMapSurfaces[0].data(), mipCount);
+      ListMipChain(cubeMapAttachedSurfaces.negativeX, rootSurf7->m_cubeMapSurfaces[1].data(), mipCount);
+      ListMipChain(cubeMapAttachedSurfaces.positiveY, rootSurf7->m_cubeMapSurfaces[2].data(), mipCount);
+      ListMipChain(cubeMapAttachedSurfaces.negativeY, rootSurf7->m_cubeMapSurfaces[3].data(), mipCount);
+      ListMipChain(cubeMapAttachedSurfaces.positiveZ, rootSurf7->m_cubeMapSurfaces[4].data(), mipCount);
+      ListMipChain(cubeMapAttachedSurfaces.negativeZ, rootSurf7->m_cubeMapSurfaces[5].data(), mipCount);
+    }
+  }
+
   inline void DDraw7Surface::InitializeAndAttachCubeFace(
         IDirectDrawSurface7* surf,
         d3d9::IDirect3DCubeTexture9* cubeTex9,
@@ -1252,32 +1412,34 @@ namespace dxvk {
     if (unlikely(cubeMapAttachedSurfaces.positiveX != nullptr))
       Logger::warn("DDraw7Surface::InitializeAllCubeMapSurfaces: Non-null positive X cube map face");
 
-    m_cubeMapSurfaces[0] = m_proxy.ptr();
+    const uint16_t mipCount = m_commonSurf->GetMipCount();
+
+    ListMipChain(m_proxy.ptr(), m_cubeMapSurfaces[0].data(), mipCount);
 
     // We can't know in advance which faces have been generated,
     // so check them one by one, initialize and bind as needed
     if (cubeMapAttachedSurfaces.negativeX != nullptr) {
-      m_cubeMapSurfaces[1] = cubeMapAttachedSurfaces.negativeX;
+      ListMipChain(cubeMapAttachedSurfaces.negativeX, m_cubeMapSurfaces[1].data(), mipCount);
       InitializeAndAttachCubeFace(cubeMapAttachedSurfaces.negativeX, m_commonSurf->GetD3D9CubeTexture(),
                                   d3d9::D3DCUBEMAP_FACE_NEGATIVE_X);
     }
     if (cubeMapAttachedSurfaces.positiveY != nullptr) {
-      m_cubeMapSurfaces[2] = cubeMapAttachedSurfaces.positiveY;
+      ListMipChain(cubeMapAttachedSurfaces.positiveY, m_cubeMapSurfaces[2].data(), mipCount);
       InitializeAndAttachCubeFace(cubeMapAttachedSurfaces.positiveY, m_commonSurf->GetD3D9CubeTexture(),
                                   d3d9::D3DCUBEMAP_FACE_POSITIVE_Y);
     }
     if (cubeMapAttachedSurfaces.negativeY != nullptr) {
-      m_cubeMapSurfaces[3] = cubeMapAttachedSurfaces.negativeY;
+      ListMipChain(cubeMapAttachedSurfaces.negativeY, m_cubeMapSurfaces[3].data(), mipCount);
       InitializeAndAttachCubeFace(cubeMapAttachedSurfaces.negativeY, m_commonSurf->GetD3D9CubeTexture(),
                                   d3d9::D3DCUBEMAP_FACE_NEGATIVE_Y);
     }
     if (cubeMapAttachedSurfaces.positiveZ != nullptr) {
-      m_cubeMapSurfaces[4] = cubeMapAttachedSurfaces.positiveZ;
+      ListMipChain(cubeMapAttachedSurfaces.positiveZ, m_cubeMapSurfaces[4].data(), mipCount);
       InitializeAndAttachCubeFace(cubeMapAttachedSurfaces.positiveZ, m_commonSurf->GetD3D9CubeTexture(),
                                   d3d9::D3DCUBEMAP_FACE_POSITIVE_Z);
     }
     if (cubeMapAttachedSurfaces.negativeZ != nullptr) {
-      m_cubeMapSurfaces[5] = cubeMapAttachedSurfaces.negativeZ;
+      ListMipChain(cubeMapAttachedSurfaces.negativeZ, m_cubeMapSurfaces[5].data(), mipCount);
       InitializeAndAttachCubeFace(cubeMapAttachedSurfaces.negativeZ, m_commonSurf->GetD3D9CubeTexture(),
                                   d3d9::D3DCUBEMAP_FACE_NEGATIVE_Z);
     }
@@ -1293,35 +1455,31 @@ namespace dxvk {
     // Cube maps will also get marked as textures, so need to be handled first
     if (unlikely(m_commonSurf->IsCubeMap())) {
       // In theory we won't know which faces have been generated,
-      // so check them one by one, and upload as needed
+      // so check them one by one, and only upload the dirty ones
       const uint16_t mipCount    = m_commonSurf->GetMipCount();
       const bool     isDXTFormat = m_commonSurf->IsDXTFormat();
-      if (likely(m_cubeMapSurfaces[0] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[0], mipCount, isDXTFormat);
-      }
-      if (likely(m_cubeMapSurfaces[1] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[1], mipCount, isDXTFormat);
-      }
-      if (likely(m_cubeMapSurfaces[2] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[2], mipCount, isDXTFormat);
-      }
-      if (likely(m_cubeMapSurfaces[3] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[3], mipCount, isDXTFormat);
-      }
-      if (likely(m_cubeMapSurfaces[4] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[4], mipCount, isDXTFormat);
-      }
-      if (likely(m_cubeMapSurfaces[5] != nullptr)) {
-        BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), m_cubeMapSurfaces[5], mipCount, isDXTFormat);
+      for (uint32_t face = 0; face < ddrawCaps::MaxCubeMapFaces; face++) {
+        const uint16_t dirtyMips = m_commonSurf->GetDirtyMips(face);
+        if (m_cubeMapSurfaces[face][0] != nullptr && dirtyMips != 0) {
+          BlitToD3D9CubeMap(m_commonSurf->GetD3D9CubeTexture(), static_cast<d3d9::D3DCUBEMAP_FACES>(face),
+                            m_cubeMapSurfaces[face].data(), mipCount, dirtyMips, isDXTFormat);
+        }
       }
-    // Blit all the mips for textures
+    // Blit the dirty mips for textures
     } else if (m_commonSurf->IsTexture()) {
-      BlitToD3D9Texture<IDirectDrawSurface7, DDSURFACEDESC2>(m_commonSurf->GetD3D9Texture(), m_proxy.ptr(),
-                                                             m_commonSurf->GetMipCount(), m_commonSurf->IsDXTFormat());
+      uint64_t* mipHashes = m_commonSurf->GetMipHashes();
+      const uint32_t skippedMips = BlitToD3D9Texture<IDirectDrawSurface7, DDSURFACEDESC2>(m_commonSurf->GetD3D9Texture(), m_mipMaps.data(),
+                                                                                          m_commonSurf->GetMipCount(), m_commonSurf->GetDirtyMips(),
+                                                                                          m_commonSurf->IsDXTFormat(),
+                                                                                          m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount(),
+                                                                                          mipHashes);
+      if (unlikely(mipHashes != nullptr))
+        m_commonIntf->TrackTextureUploadHashes(m_commonSurf->GetDirtyMipCount(), skippedMips);
     // Blit surfaces directly
     } else {
       BlitToD3D9Surface<IDirectDrawSurface7, DDSURFACEDESC2>(m_commonSurf->GetD3D9Surface(), GetShadowOrProxied(),
-                                                             m_commonSurf->IsDXTFormat());
+                                                             m_commonSurf->IsDXTFormat(),
+                                                             m_commonSurf->GetDirtyRects(), m_commonSurf->GetDirtyRectCount());
     }
 
     m_commonSurf->UnDirtyDDrawSurface();
@@ -134,7 +134,9 @@ namespace dxvk {
 
     HRESULT InitializeOrUploadD3D9();
 
-    void DownloadSurfaceData();
+    void DownloadSurfaceData(const RECT* lpRect = nullptr);
+
+    void DownloadStaleMips();
 
     void SetShadowSurface(Com<DDraw7Surface>&& shadowSurf) {
       m_shadowSurf = shadowSurf;
@@ -194,6 +196,9 @@ namespace dxvk {
 
     inline void UpdateMipMapCount();
 
+    // Lists the mip chains cached on the chain root again
+    inline void RefreshMipChains();
+
     inline void InitializeAndAttachCubeFace(
         IDirectDrawSurface7* surf,
         d3d9::IDirect3DCubeTexture9* cubeTex9,
@@ -210,7 +215,11 @@ namespace dxvk {
 
     DDraw7Surface*                      m_parentSurf      = nullptr;
 
-    std::array<IDirectDrawSurface7*, 6> m_cubeMapSurfaces;
+    // Mip chains get cached on initialization, to avoid walking them on every upload
+    std::array<IDirectDrawSurface7*, ddrawCaps::MaxMipLevels> m_mipMaps;
+
+    std::array<std::array<IDirectDrawSurface7*, ddrawCaps::MaxMipLevels>,
+               ddrawCaps::MaxCubeMapFaces> m_cubeMapSurfaces;
 
     DDraw7Surface*                      m_nextFlippable   = nullptr;
 
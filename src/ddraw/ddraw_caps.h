@@ -4,6 +4,8 @@ namespace dxvk::ddrawCaps {
 
   static constexpr uint32_t MaxClipPlanes           = 6;
   static constexpr uint32_t MaxTextureDimension     = 8192;
+  static constexpr uint32_t MaxMipLevels            = 14; // Down to 1x1 from MaxTextureDimension
+  static constexpr uint32_t MaxCubeMapFaces         = 6;
 
   static constexpr uint32_t MaxSimultaneousTextures = 8;
   static constexpr uint32_t TextureStageCount       = MaxSimultaneousTextures;
@@ -15,11 +17,20 @@ namespace dxvk::ddrawCaps {
 
   static constexpr uint32_t MaxEnabledLights        = 8;
 
-  static constexpr uint8_t  IndexBufferCount        = 10;
-  // Actual index buffer sizes are 2x, so 0.25 kb, 0.5 kb, 1kb, 2 kb, 4kb, 8 kb, 16kb, 32 kb, 64 kb and 128 kb
-  // Note: The DXVK backend gives us 256 byte chunks anyway as a minimum, so there's no point going below that
-  static constexpr UINT     IndexCount[IndexBufferCount] = {128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, D3DMAXNUMVERTICES};
-  static constexpr UINT     MaxIndexCount           = IndexCount[IndexBufferCount - 1];
+  // Dirty rects get merged beyond this point, to keep uploads cheap to track
+  static constexpr uint32_t MaxDirtyRects           = 8;
+
+  static constexpr UINT     MaxIndexCount           = D3DMAXNUMVERTICES;
+
+  // Initial size of the streaming index buffer, which grows on demand
+  static constexpr UINT     StreamingIndexBufferSize  = 1 << 20; // 1 MB
+
+  // Initial size of the streaming vertex buffer, which grows on demand
+  static constexpr UINT     StreamingVertexBufferSize = 1 << 22; // 4 MB
+
+  // Begin/Vertex/End vertices and indices get drawn in chunks of this size,
+  // which is a multiple of 6 so that lists never need to be split up
+  static constexpr UINT     ImmediateChunkSize      = 1020;
 
   static constexpr uint8_t  NumberOfFOURCCCodes     = 6;
   static constexpr DWORD    SupportedFourCCs[]      =
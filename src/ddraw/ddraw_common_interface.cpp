@@ -4,7 +4,10 @@
 #include "d3d_common_texture.h"
 
 #include "ddraw/ddraw_surface.h"
+#include "ddraw2/ddraw2_surface.h"
+#include "ddraw2/ddraw3_surface.h"
 #include "ddraw4/ddraw4_surface.h"
+#include "ddraw7/ddraw7_surface.h"
 
 #include "d3d3/d3d3_interface.h"
 
@@ -16,9 +19,50 @@ namespace dxvk {
 
   DDrawCommonInterface::DDrawCommonInterface(const D3DOptions& d3dOptions)
     : m_d3dOptions ( d3dOptions ) {
+    // Options are the same for all interfaces, so this is set before any surfaces exist
+    if (unlikely(m_d3dOptions.textureEvictionFrames > 0))
+      s_surfacesScanned = true;
   }
 
   DDrawCommonInterface::~DDrawCommonInterface() {
+    if (unlikely(m_uploadHashChecks != 0)) {
+      Logger::info(str::format("DDrawCommonInterface: Skipped ", m_uploadHashHits, " out of ", m_uploadHashChecks,
+                               " texture mip uploads (", (m_uploadHashHits * 100) / m_uploadHashChecks, "% hit rate)"));
+    }
+    if (unlikely(m_releasedStorage != 0)) {
+      Logger::info(str::format("DDrawCommonInterface: Released ", m_releasedStorage >> 10, " KB of texture storage, ",
+                               m_restoredStorage >> 10, " KB of which had to be restored"));
+    }
+  }
+
+  void DDrawCommonInterface::AdvanceFrame() {
+    m_frameCount++;
+
+    const int32_t evictionFrames = m_d3dOptions.textureEvictionFrames;
+    if (likely(evictionFrames <= 0 || m_frameCount % static_cast<uint32_t>(evictionFrames) != 0))
+      return;
+
+    // Storage is only released by the next use of each surface, since other threads
+    // may be locking or blitting them right now. Common surfaces shared by several
+    // interfaces get visited more than once, which doesn't matter for marking.
+    auto markStorage = [this] (DDrawCommonSurface* commonSurf) {
+      if (commonSurf->GetCommonInterface() == this)
+        commonSurf->MarkDDrawStorageEvictable();
+    };
+
+    // Surfaces can get created or released on other threads in the meantime
+    std::lock_guard<dxvk::recursive_mutex> lock(s_surfacesMutex);
+
+    for (IDirectDrawSurface7* surface : s_surfaces7)
+      markStorage(static_cast<DDraw7Surface*>(surface)->GetCommonSurface());
+    for (IDirectDrawSurface4* surface : s_surfaces4)
+      markStorage(static_cast<DDraw4Surface*>(surface)->GetCommonSurface());
+    for (IDirectDrawSurface3* surface : s_surfaces3)
+      markStorage(static_cast<DDraw3Surface*>(surface)->GetCommonSurface());
+    for (IDirectDrawSurface2* surface : s_surfaces2)
+      markStorage(static_cast<DDraw2Surface*>(surface)->GetCommonSurface());
+    for (IDirectDrawSurface* surface : s_surfaces)
+      markStorage(static_cast<DDrawSurface*>(surface)->GetCommonSurface());
   }
 
   D3D3Interface* DDrawCommonInterface::GetOrCreateD3D3Interface() {
@@ -41,6 +85,8 @@ namespace dxvk {
   }
 
   bool DDrawCommonInterface::IsWrappedSurface(IDirectDrawSurface* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces.find(surface);
     if (likely(it != s_surfaces.end()))
       return true;
@@ -49,10 +95,14 @@ namespace dxvk {
   }
 
   void DDrawCommonInterface::AddWrappedSurface(IDirectDrawSurface* surface) {
+    auto lock = LockWrappedSurfaces();
+
     s_surfaces.insert(surface);
   }
 
   void DDrawCommonInterface::RemoveWrappedSurface(IDirectDrawSurface* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces.find(surface);
     if (likely(it != s_surfaces.end())) {
       s_surfaces.erase(it);
@@ -62,6 +112,8 @@ namespace dxvk {
   }
 
   bool DDrawCommonInterface::IsWrappedSurface(IDirectDrawSurface2* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces2.find(surface);
     if (likely(it != s_surfaces2.end()))
       return true;
@@ -70,10 +122,14 @@ namespace dxvk {
   }
 
   void DDrawCommonInterface::AddWrappedSurface(IDirectDrawSurface2* surface) {
+    auto lock = LockWrappedSurfaces();
+
     s_surfaces2.insert(surface);
   }
 
   void DDrawCommonInterface::RemoveWrappedSurface(IDirectDrawSurface2* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces2.find(surface);
     if (likely(it != s_surfaces2.end())) {
       s_surfaces2.erase(it);
@@ -83,6 +139,8 @@ namespace dxvk {
   }
 
   bool DDrawCommonInterface::IsWrappedSurface(IDirectDrawSurface3* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces3.find(surface);
     if (likely(it != s_surfaces3.end()))
       return true;
@@ -91,10 +149,14 @@ namespace dxvk {
   }
 
   void DDrawCommonInterface::AddWrappedSurface(IDirectDrawSurface3* surface) {
+    auto lock = LockWrappedSurfaces();
+
     s_surfaces3.insert(surface);
   }
 
   void DDrawCommonInterface::RemoveWrappedSurface(IDirectDrawSurface3* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces3.find(surface);
     if (likely(it != s_surfaces3.end())) {
       s_surfaces3.erase(it);
@@ -104,6 +166,8 @@ namespace dxvk {
   }
 
   bool DDrawCommonInterface::IsWrappedSurface(IDirectDrawSurface4* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces4.find(surface);
     if (likely(it != s_surfaces4.end()))
       return true;
@@ -112,10 +176,14 @@ namespace dxvk {
   }
 
   void DDrawCommonInterface::AddWrappedSurface(IDirectDrawSurface4* surface) {
+    auto lock = LockWrappedSurfaces();
+
     s_surfaces4.insert(surface);
   }
 
   void DDrawCommonInterface::RemoveWrappedSurface(IDirectDrawSurface4* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces4.find(surface);
     if (likely(it != s_surfaces4.end())) {
       s_surfaces4.erase(it);
@@ -125,6 +193,8 @@ namespace dxvk {
   }
 
   bool DDrawCommonInterface::IsWrappedSurface(IDirectDrawSurface7* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces7.find(surface);
     if (likely(it != s_surfaces7.end()))
       return true;
@@ -133,10 +203,14 @@ namespace dxvk {
   }
 
   void DDrawCommonInterface::AddWrappedSurface(IDirectDrawSurface7* surface) {
+    auto lock = LockWrappedSurfaces();
+
     s_surfaces7.insert(surface);
   }
 
   void DDrawCommonInterface::RemoveWrappedSurface(IDirectDrawSurface7* surface) {
+    auto lock = LockWrappedSurfaces();
+
     auto it = s_surfaces7.find(surface);
     if (likely(it != s_surfaces7.end())) {
       s_surfaces7.erase(it);
@@ -3,6 +3,8 @@
 #include "ddraw_include.h"
 #include "ddraw_options.h"
 
+#include "../util/thread.h"
+
 #include <unordered_set>
 #include <unordered_map>
 
@@ -114,6 +116,10 @@ namespace dxvk {
     }
 
     void SetCooperativeLevel(HWND hWnd, DWORD dwFlags) {
+      // A retained device can only be adopted on the window it was created on
+      if (hWnd != m_retainedHWnd)
+        DropRetainedD3D9Device();
+
       m_hWnd = hWnd;
       m_cooperativeLevel = dwFlags;
     }
@@ -211,6 +217,53 @@ namespace dxvk {
       return m_origin;
     }
 
+    void TrackTextureUploadHashes(uint32_t checkedMips, uint32_t skippedMips) {
+      m_uploadHashChecks += checkedMips;
+      m_uploadHashHits   += skippedMips;
+    }
+
+    // Gets called on every Flip or windowed present, and periodically
+    // releases the DDraw side storage of textures which went idle
+    void AdvanceFrame();
+
+    uint32_t GetFrameCount() const {
+      return m_frameCount;
+    }
+
+    void TrackReleasedStorage(uint64_t size) {
+      m_releasedStorage += size;
+    }
+
+    void TrackRestoredStorage(uint64_t size) {
+      m_restoredStorage += size;
+    }
+
+    // Keeps the D3D9 device of a released D3D device around, so that
+    // the next D3D device can adopt it along with all of its resources
+    void RetainD3D9Device(Com<d3d9::IDirect3DDevice9>&& device9, HWND hWnd, DWORD creationFlags9) {
+      m_retainedDevice9        = std::move(device9);
+      m_retainedHWnd           = hWnd;
+      m_retainedCreationFlags9 = creationFlags9;
+    }
+
+    // Only a device created with the same window and flags can be adopted
+    Com<d3d9::IDirect3DDevice9> AdoptD3D9Device(HWND hWnd, DWORD creationFlags9) {
+      Com<d3d9::IDirect3DDevice9> device9 = std::move(m_retainedDevice9);
+
+      if (hWnd != m_retainedHWnd || creationFlags9 != m_retainedCreationFlags9)
+        return nullptr;
+
+      return device9;
+    }
+
+    // Display mode changes are fine, since the adopting device resets the
+    // retained one with its own present parameters, but windows are not
+    void DropRetainedD3D9Device() {
+      m_retainedDevice9        = nullptr;
+      m_retainedHWnd           = nullptr;
+      m_retainedCreationFlags9 = 0;
+    }
+
   private:
 
     bool                              m_isInitialized      = false;
@@ -239,6 +292,19 @@ namespace dxvk {
     // that gets created through a DirectDrawCreate(Ex) call
     IUnknown*                         m_origin             = nullptr;
 
+    // Texture mip upload content hash statistics
+    uint64_t                          m_uploadHashChecks   = 0;
+    uint64_t                          m_uploadHashHits     = 0;
+
+    // Texture DDraw side storage residency statistics, in bytes
+    uint32_t                          m_frameCount         = 0;
+    uint64_t                          m_releasedStorage    = 0;
+    uint64_t                          m_restoredStorage    = 0;
+
+    Com<d3d9::IDirect3DDevice9>       m_retainedDevice9;
+    HWND                              m_retainedHWnd           = nullptr;
+    DWORD                             m_retainedCreationFlags9 = 0;
+
     // Tests have indicated that once created, texture handles are shared across
     // all devices and DDraw interfaces, regardless of their relation
     static std::atomic<D3DTEXTUREHANDLE> s_textureHandle;
@@ -253,6 +319,18 @@ namespace dxvk {
     static inline std::unordered_set<IDirectDrawSurface2*> s_surfaces2;
     static inline std::unordered_set<IDirectDrawSurface*>  s_surfaces;
 
+    // Guards all of the above, which texture storage eviction scans. Without
+    // eviction, nothing walks the sets and the lock isn't worth taking.
+    static inline dxvk::recursive_mutex s_surfacesMutex;
+    static inline std::atomic<bool>     s_surfacesScanned = false;
+
+    static std::unique_lock<dxvk::recursive_mutex> LockWrappedSurfaces() {
+      if (likely(!s_surfacesScanned.load(std::memory_order_relaxed)))
+        return std::unique_lock<dxvk::recursive_mutex>();
+
+      return std::unique_lock<dxvk::recursive_mutex>(s_surfacesMutex);
+    }
+
   };
 
 }
\ No newline at end of file
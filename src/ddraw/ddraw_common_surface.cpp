@@ -8,6 +8,8 @@
 #include "ddraw2/ddraw2_surface.h"
 #include "ddraw/ddraw_surface.h"
 
+#include "../d3d9/d3d9_bridge.h"
+
 namespace dxvk {
 
   DDrawCommonSurface::DDrawCommonSurface(DDrawCommonInterface* commonIntf)
@@ -19,7 +21,7 @@ namespace dxvk {
       m_commonIntf->SetPrimarySurface(nullptr);
 
     if (unlikely(m_palette != nullptr))
-      m_palette->SetCommonSurface(nullptr);
+      m_palette->RemoveCommonSurface(this);
   }
 
   IUnknown* DDrawCommonSurface::GetShadowSurfaceProxied() {
@@ -85,6 +87,10 @@ namespace dxvk {
   HRESULT DDrawCommonSurface::RefreshSurfaceDescripton(const bool refreshFormat) {
     HRESULT hr;
 
+    // The placeholder storage would otherwise show up in the desc
+    if (unlikely(m_ddrawStorageReleased))
+      RestoreDDrawStorage();
+
     DDSURFACEDESC2 desc2;
     desc2.dwSize = sizeof(DDSURFACEDESC2);
 
@@ -128,35 +134,273 @@ namespace dxvk {
     return DD_OK;
   }
 
+  void DDrawCommonSurface::FlushBatchedDraws() {
+    D3DCommonDevice* commonD3DDevice = m_commonIntf->GetCommonD3DDevice();
+
+    if (likely(commonD3DDevice != nullptr))
+      commonD3DDevice->FlushBatchedDraws();
+  }
+
   void DDrawCommonSurface::RefreshD3D9Device() {
     D3DCommonDevice* commonD3DDevice = m_commonIntf->GetCommonD3DDevice();
 
     if (unlikely(m_commonD3DDevice != commonD3DDevice)) {
-      // Check if the device has been recreated and reset all D3D9 resources
-      if (m_commonD3DDevice != nullptr) {
-        Logger::debug("DDrawCommonSurface: Device has changed, clearing all D3D9 resources");
-        m_cubeMap9 = nullptr;
-        m_texture9 = nullptr;
-        m_surface9 = nullptr;
-        // Also reset all D3D9 related tracking flags
-        m_isD3D9BackBuffer = false;
-        m_isD3D9DepthStencil = false;
-        m_dirtyD3D9 = false;
+      const bool hasResources = m_surface9 != nullptr || m_texture9 != nullptr || m_cubeMap9 != nullptr;
+
+      if (hasResources) {
+        // Resources survive if the new device has adopted their D3D9 device,
+        // which remains possible for as long as there is no new device
+        const bool keepResources = m_commonIntf->GetOptions()->deviceReuse
+                                && (commonD3DDevice == nullptr || IsOnD3D9Device(commonD3DDevice->GetD3D9Device()));
+
+        if (keepResources) {
+          Logger::debug("DDrawCommonSurface: Device has changed, keeping D3D9 resources");
+          // Swapchain surfaces don't survive the D3D9 device reset
+          if (m_isD3D9BackBuffer) {
+            m_surface9 = nullptr;
+            m_isD3D9BackBuffer = false;
+            m_dirtyD3D9 = false;
+          }
+        // Check if the device has been recreated and reset all D3D9 resources
+        } else {
+          Logger::debug("DDrawCommonSurface: Device has changed, clearing all D3D9 resources");
+          // Read back GPU side writes, while the resources holding them are still around
+          if (unlikely(HasStaleMips()))
+            DownloadStaleMips();
+          m_cubeMap9 = nullptr;
+          m_texture9 = nullptr;
+          m_surface9 = nullptr;
+          // Also reset all D3D9 related tracking flags
+          m_isD3D9BackBuffer = false;
+          m_isD3D9DepthStencil = false;
+          m_dirtyD3D9 = false;
+          m_staleMips.fill(0);
+        }
       }
 
       m_commonD3DDevice = commonD3DDevice;
     }
   }
 
+  bool DDrawCommonSurface::IsOnD3D9Device(d3d9::IDirect3DDevice9* device9) const {
+    Com<d3d9::IDirect3DDevice9> resourceDevice9;
+
+    if (m_texture9 != nullptr)
+      m_texture9->GetDevice(&resourceDevice9);
+    else if (m_cubeMap9 != nullptr)
+      m_cubeMap9->GetDevice(&resourceDevice9);
+    else if (m_surface9 != nullptr)
+      m_surface9->GetDevice(&resourceDevice9);
+
+    return resourceDevice9 != nullptr && resourceDevice9.ptr() == device9;
+  }
+
   d3d9::IDirect3DDevice9* DDrawCommonSurface::GetRefreshedD3D9Device() {
     RefreshD3D9Device();
 
-    if (likely(m_commonD3DDevice != nullptr))
+    // Anything going through the D3D9 device from here on may
+    // depend on the results of previously batched draws
+    if (likely(m_commonD3DDevice != nullptr)) {
+      m_commonD3DDevice->FlushBatchedDraws();
       return m_commonD3DDevice->GetD3D9Device();
+    }
 
     return nullptr;
   }
 
+  static inline bool IsEmptyRect(const RECT& rect) {
+    return rect.right <= rect.left || rect.bottom <= rect.top;
+  }
+
+  static inline bool RectsTouch(const RECT& a, const RECT& b) {
+    return a.left <= b.right && b.left <= a.right
+        && a.top <= b.bottom && b.top <= a.bottom;
+  }
+
+  static inline RECT UnionOfRects(const RECT& a, const RECT& b) {
+    return { std::min(a.left, b.left),   std::min(a.top, b.top),
+             std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+  }
+
+  static inline int64_t RectArea(const RECT& rect) {
+    return static_cast<int64_t>(rect.right - rect.left) * static_cast<int64_t>(rect.bottom - rect.top);
+  }
+
+  static inline bool RectContains(const RECT& outer, const RECT& inner) {
+    return outer.left  <= inner.left  && outer.top    <= inner.top
+        && outer.right >= inner.right && outer.bottom >= inner.bottom;
+  }
+
+  void DDrawCommonSurface::DirtyDDrawSurface(const RECT* dirtyRect) {
+    if (dirtyRect == nullptr) {
+      DirtyDDrawSurface();
+      return;
+    }
+
+    m_ddrawWrites++;
+    // Only mirrors which have been taken before the next upload hold everything else
+    m_mirrorPending = false;
+
+    DirtyMipChainRoot();
+
+    // Already marked for a full upload
+    if (m_dirtyDDraw && m_dirtyRectCount == 0 && (m_dirtyMips[0] & 1u))
+      return;
+
+    RECT rect = { std::max<LONG>(dirtyRect->left,  0),            std::max<LONG>(dirtyRect->top,    0),
+                  std::min<LONG>(dirtyRect->right, m_rect.right), std::min<LONG>(dirtyRect->bottom, m_rect.bottom) };
+
+    // Nothing of the surface has been touched
+    if (unlikely(IsEmptyRect(rect)))
+      return;
+
+    // 8-bit formats get expanded as a whole on the D3D9 side
+    if (unlikely(Is8BitFormat())) {
+      DirtyDDrawTopLevel();
+      return;
+    }
+
+    // While the DDraw surface is only partially valid, rects can't be merged, as
+    // that could pull in stale data during uploads. Queue them up as they are
+    // instead, for as long as there are slots left
+    if (unlikely(m_dirtyD3D9 && IsInitialized())) {
+      for (uint32_t i = 0; i < m_dirtyRectCount; i++) {
+        if (RectContains(m_dirtyRects[i], rect))
+          return;
+      }
+
+      // All writes land within rects which have been read back first, so once out
+      // of slots, mark all of those as dirty and leave the upload to the next use
+      if (unlikely(m_dirtyRectCount == m_dirtyRects.size())) {
+        DirtyDDrawTopLevel();
+
+        std::copy(m_validRects.begin(), m_validRects.begin() + m_validRectCount, m_dirtyRects.begin());
+        m_dirtyRectCount = m_validRectCount;
+        return;
+      }
+
+      m_dirtyRects[m_dirtyRectCount++] = rect;
+      m_dirtyDDraw    = true;
+      m_dirtyMips[0] |= 1u;
+      return;
+    }
+
+    // Fold in all tracked rects that overlap or border the new one
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (uint32_t i = 0; i < m_dirtyRectCount; i++) {
+        if (RectsTouch(m_dirtyRects[i], rect)) {
+          rect = UnionOfRects(m_dirtyRects[i], rect);
+          m_dirtyRects[i] = m_dirtyRects[--m_dirtyRectCount];
+          merged = true;
+          break;
+        }
+      }
+    }
+
+    // When out of slots, merge with the rect which grows the least
+    if (m_dirtyRectCount == m_dirtyRects.size()) {
+      uint32_t bestIndex = 0;
+      int64_t  bestGrowth = std::numeric_limits<int64_t>::max();
+      for (uint32_t i = 0; i < m_dirtyRectCount; i++) {
+        const int64_t growth = RectArea(UnionOfRects(m_dirtyRects[i], rect)) - RectArea(m_dirtyRects[i]);
+        if (growth < bestGrowth) {
+          bestGrowth = growth;
+          bestIndex  = i;
+        }
+      }
+      rect = UnionOfRects(m_dirtyRects[bestIndex], rect);
+      m_dirtyRects[bestIndex] = m_dirtyRects[--m_dirtyRectCount];
+    }
+
+    if (IsFullSurfaceLock(&rect, nullptr)) {
+      DirtyDDrawTopLevel();
+      return;
+    }
+
+    m_dirtyRects[m_dirtyRectCount++] = rect;
+    m_dirtyDDraw    = true;
+    m_dirtyMips[0] |= 1u;
+  }
+
+  void DDrawCommonSurface::AttachToMipChain(DDrawCommonSurface* parent) {
+    if (m_mipChainRoot != nullptr || parent == nullptr || parent == this
+     || !IsTextureOrCubeMap() || !parent->IsTextureOrCubeMap())
+      return;
+
+    const uint32_t face       = IsCubeMap()         ? static_cast<uint32_t>(GetCubemapFace(&m_desc2))         : 0u;
+    const uint32_t parentFace = parent->IsCubeMap() ? static_cast<uint32_t>(GetCubemapFace(&parent->m_desc2)) : 0u;
+
+    uint32_t level;
+    // Cube map faces are attached to the positive X face, which is the top level
+    if (face != parentFace)
+      level = 0;
+    // Mip sub-levels are attached to the level right above them
+    else if (IsTextureMip() && parent->IsTextureMip())
+      level = parent->m_mipChainLevel + 1;
+    else
+      return;
+
+    if (unlikely(level >= ddrawCaps::MaxMipLevels))
+      return;
+
+    m_mipChainRoot  = parent->m_mipChainRoot != nullptr ? parent->m_mipChainRoot.ptr() : parent;
+    m_mipChainFace  = face;
+    m_mipChainLevel = level;
+  }
+
+  void DDrawCommonSurface::TrackLockRect(const RECT* lockRect) {
+    const RECT* rect = lockRect != nullptr ? lockRect : &m_rect;
+
+    m_lockRect = IsEmptyRect(m_lockRect) ? *rect : UnionOfRects(m_lockRect, *rect);
+
+    TouchDDrawStorage();
+  }
+
+  void DDrawCommonSurface::DirtyDDrawSurfaceOnUnlock() {
+    // Unlocks which can't be matched to a lock will dirty the whole surface
+    if (unlikely(IsEmptyRect(m_lockRect))) {
+      DirtyDDrawSurface();
+    } else {
+      DirtyDDrawSurface(&m_lockRect);
+    }
+
+    m_lockRect = { };
+  }
+
+  bool DDrawCommonSurface::IsDDrawRectValid(const RECT* rect) const {
+    if (rect == nullptr)
+      return !m_dirtyD3D9;
+
+    for (uint32_t i = 0; i < m_validRectCount; i++) {
+      if (RectContains(m_validRects[i], *rect))
+        return true;
+    }
+
+    return !m_dirtyD3D9;
+  }
+
+  bool DDrawCommonSurface::TrackValidDDrawRect(const RECT* rect, RECT* validRect) {
+    // Full surface read backs and block/FOURCC formats can't be tracked as rects. Also
+    // skip primary surfaces, which may use screen coordinates in windowed mode.
+    if (rect == nullptr || !HasFixedPixelSize() || IsPrimarySurface()
+     || m_validRectCount == m_validRects.size())
+      return false;
+
+    *validRect = { std::max<LONG>(rect->left,  0),            std::max<LONG>(rect->top,    0),
+                   std::min<LONG>(rect->right, m_rect.right), std::min<LONG>(rect->bottom, m_rect.bottom) };
+
+    if (unlikely(IsEmptyRect(*validRect) || IsFullSurfaceLock(validRect, nullptr)))
+      return false;
+
+    m_validRects[m_validRectCount++] = *validRect;
+
+    InvalidateDDrawMirror();
+
+    return true;
+  }
+
   HRESULT DDrawCommonSurface::InitializeD3D9(const bool initRenderTarget) {
     const DWORD dwWidth  = static_cast<DWORD>(m_rect.right);
     const DWORD dwHeight = static_cast<DWORD>(m_rect.bottom);
@@ -171,10 +415,13 @@ namespace dxvk {
       return DDERR_UNSUPPORTED;
     }
 
-    // Don't initialize P8 textures/surfaces since we don't support them.
-    // Some applications do require them to be created by ddraw, otherwise
+    // P8 textures/surfaces get expanded on the GPU, however we can't
+    // do the same for swap chain surfaces or render targets. Some
+    // applications do require them to be created by ddraw, otherwise
     // they will simply fail to start, so just ignore them for now.
-    if (unlikely(m_format9 == d3d9::D3DFMT_P8)) {
+    if (unlikely(m_format9 == d3d9::D3DFMT_P8
+              && (IsPrimarySurface() || IsFrontBuffer() || IsBackBufferOrFlippable()
+               || IsRenderTarget() || Is3DSurface() || initRenderTarget))) {
       static bool s_formatP8ErrorShown;
 
       if (!std::exchange(s_formatP8ErrorShown, true))
@@ -365,9 +612,54 @@ namespace dxvk {
       }
     }
 
+    // Newly created D3D9 resources hold none of the previously uploaded
+    // data, so any pending partial upload needs to cover the full surface
+    if (m_dirtyDDraw)
+      DirtyDDrawSurface();
+    m_mipHashes.fill(0);
+
+    // The palette needs to be in place before any index data gets uploaded
+    if (unlikely(m_format9 == d3d9::D3DFMT_P8))
+      UpdateD3D9Palette();
+
     return DD_OK;
   }
 
+  HRESULT DDrawCommonSurface::UpdateD3D9Palette() {
+    if (m_format9 != d3d9::D3DFMT_P8 || m_palette == nullptr || !IsInitialized())
+      return DD_OK;
+
+    DWORD paletteCaps = 0;
+    HRESULT hr = m_palette->GetCaps(&paletteCaps);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // Only 8-bit palettes can cover all the P8 indices
+    if (unlikely(!(paletteCaps & DDPCAPS_8BIT)))
+      return DD_OK;
+
+    std::array<PALETTEENTRY, 256> entries;
+    hr = m_palette->GetEntries(0, 0, entries.size(), entries.data());
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // peFlags only holds alpha values for DDPCAPS_ALPHA palettes
+    if (!(paletteCaps & DDPCAPS_ALPHA)) {
+      for (PALETTEENTRY& entry : entries)
+        entry.peFlags = 0xFF;
+    }
+
+    d3d9::IDirect3DDevice9* d3d9Device = m_commonD3DDevice->GetD3D9Device();
+
+    Com<IDxvkLegacyD3DDeviceBridge> bridge;
+    if (unlikely(FAILED(d3d9Device->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&bridge))))) {
+      Logger::err("DDrawCommonSurface::UpdateD3D9Palette: Failed to get D3D9 Bridge");
+      return DDERR_GENERIC;
+    }
+
+    return bridge->SetSurfacePalette(m_surface9.ptr(), entries.data());
+  }
+
   HRESULT DDrawCommonSurface::InitializeOrUploadD3D9() {
     if (m_surf7 != nullptr) {
       return m_surf7->InitializeOrUploadD3D9();
@@ -388,4 +680,460 @@ namespace dxvk {
     return DDERR_GENERIC;
   }
 
+  HRESULT DDrawCommonSurface::BltD3D9(
+        DDrawCommonSurface* srcSurface,
+        const RECT* destRect,
+        const RECT* srcRect,
+        DWORD dwFlags,
+        const DDBLTFX* bltFx) {
+    static constexpr DWORD SupportedFlags = DDBLT_WAIT | DDBLT_ASYNC | DDBLT_DONOTWAIT
+                                          | DDBLT_COLORFILL | DDBLT_DEPTHFILL
+                                          | DDBLT_KEYSRC | DDBLT_KEYSRCOVERRIDE;
+
+    if (!m_commonIntf->GetOptions()->gpuBlits)
+      return DDERR_UNSUPPORTED;
+
+    // Destination color keys, ROPs and other effects are left to the CPU blitter
+    if (dwFlags & ~SupportedFlags)
+      return DDERR_UNSUPPORTED;
+
+    // Anything being presented or clipped is also best left alone
+    if (m_clipper != nullptr || IsPrimarySurface() || IsFrontBuffer())
+      return DDERR_UNSUPPORTED;
+
+    // Queued blits only get flushed when something depends on them
+    RefreshD3D9Device();
+    if (unlikely(m_commonD3DDevice == nullptr || !IsInitialized()))
+      return DDERR_UNSUPPORTED;
+
+    d3d9::IDirect3DDevice9* d3d9Device = m_commonD3DDevice->GetD3D9Device();
+
+    HRESULT hr9 = D3DERR_INVALIDCALL;
+
+    if (dwFlags & DDBLT_COLORFILL) {
+      // Only back buffers get read back to DDraw if needed after a D3D9 write
+      if (!IsD3D9BackBuffer() || bltFx == nullptr)
+        return DDERR_UNSUPPORTED;
+
+      const DDPIXELFORMAT* pixelFormat = (m_desc2.dwFlags & DDSD_PIXELFORMAT) ? &m_desc2.ddpfPixelFormat : &m_desc.ddpfPixelFormat;
+      DWORD color = 0;
+      if (!FillColorToARGB(pixelFormat, bltFx->dwFillColor, &color))
+        return DDERR_UNSUPPORTED;
+
+      // Any pending DDraw side changes need to reach D3D9 first
+      if (unlikely(FAILED(InitializeOrUploadD3D9())))
+        return DDERR_UNSUPPORTED;
+
+      hr9 = d3d9Device->ColorFill(m_surface9.ptr(), destRect, color);
+    } else if (dwFlags & DDBLT_DEPTHFILL) {
+      if (!IsD3D9DepthStencil() || bltFx == nullptr)
+        return DDERR_UNSUPPORTED;
+
+      // Clears only work on the currently bound depth stencil
+      Com<d3d9::IDirect3DSurface9> currentDepthStencil;
+      d3d9Device->GetDepthStencilSurface(&currentDepthStencil);
+      if (currentDepthStencil.ptr() != m_surface9.ptr())
+        return DDERR_UNSUPPORTED;
+
+      if (unlikely(FAILED(InitializeOrUploadD3D9())))
+        return DDERR_UNSUPPORTED;
+
+      const D3DRECT clearRect = destRect != nullptr ?
+        D3DRECT{ destRect->left, destRect->top, destRect->right, destRect->bottom } :
+        D3DRECT{ 0, 0, m_rect.right, m_rect.bottom };
+
+      // Clears are bound by the viewport, so temporarily cover the entire surface
+      d3d9::D3DVIEWPORT9 viewport9;
+      m_commonD3DDevice->GetViewport(&viewport9);
+      d3d9::D3DVIEWPORT9 fullViewport9 = { 0, 0, static_cast<DWORD>(m_rect.right),
+                                           static_cast<DWORD>(m_rect.bottom), 0.0f, 1.0f };
+      m_commonD3DDevice->SetViewport(&fullViewport9);
+
+      hr9 = d3d9Device->Clear(1, &clearRect, D3DCLEAR_ZBUFFER, 0,
+                              GetNormalizedFloatDepth(bltFx->dwFillDepth), 0);
+
+      m_commonD3DDevice->SetViewport(&viewport9);
+    } else {
+      if (srcSurface == nullptr || srcSurface == this || !IsD3D9BackBuffer())
+        return DDERR_UNSUPPORTED;
+
+      srcSurface->RefreshD3D9Device();
+      if (srcSurface->GetCommonD3DDevice() != m_commonD3DDevice || !srcSurface->IsInitialized())
+        return DDERR_UNSUPPORTED;
+
+      // Uploads flush all queued blits, so only go through them if there is anything to upload
+      if (unlikely((srcSurface->IsDDrawSurfaceDirty() && FAILED(srcSurface->InitializeOrUploadD3D9()))
+                || (IsDDrawSurfaceDirty() && FAILED(InitializeOrUploadD3D9()))))
+        return DDERR_UNSUPPORTED;
+
+      hr9 = QueueBltD3D9(srcSurface, destRect, srcRect, dwFlags, bltFx);
+
+      // Plain copies which can't be queued are done right away instead
+      if (FAILED(hr9) && !(dwFlags & (DDBLT_KEYSRC | DDBLT_KEYSRCOVERRIDE))) {
+        m_commonD3DDevice->FlushBatchedDraws();
+
+        const RECT* srcFullRect = srcSurface->GetFullSurfaceRect();
+        const LONG srcWidth   = srcRect  != nullptr ? srcRect->right   - srcRect->left  : srcFullRect->right;
+        const LONG srcHeight  = srcRect  != nullptr ? srcRect->bottom  - srcRect->top   : srcFullRect->bottom;
+        const LONG destWidth  = destRect != nullptr ? destRect->right  - destRect->left : m_rect.right;
+        const LONG destHeight = destRect != nullptr ? destRect->bottom - destRect->top  : m_rect.bottom;
+        const bool isStretched = srcWidth != destWidth || srcHeight != destHeight;
+
+        // DDraw stretching is expected to use point sampling
+        hr9 = d3d9Device->StretchRect(srcSurface->GetD3D9Surface(), srcRect, m_surface9.ptr(), destRect,
+                                      isStretched ? d3d9::D3DTEXF_POINT : d3d9::D3DTEXF_NONE);
+
+        // StretchRect won't work with SYSTEMMEM sources, but UpdateSurface will
+        if (FAILED(hr9) && !isStretched) {
+          const POINT destPoint = { destRect != nullptr ? destRect->left : 0,
+                                    destRect != nullptr ? destRect->top  : 0 };
+          hr9 = d3d9Device->UpdateSurface(srcSurface->GetD3D9Surface(), srcRect, m_surface9.ptr(), &destPoint);
+        }
+      }
+    }
+
+    if (FAILED(hr9))
+      return DDERR_UNSUPPORTED;
+
+    // The DDraw side surface data is now stale
+    DirtyD3D9Surface();
+
+    return DD_OK;
+  }
+
+  HRESULT DDrawCommonSurface::BltFastD3D9(
+        DDrawCommonSurface* srcSurface,
+        DWORD dwX,
+        DWORD dwY,
+        const RECT* srcRect,
+        DWORD dwTrans) {
+    if (srcSurface == nullptr || (dwTrans & DDBLTFAST_DESTCOLORKEY))
+      return DDERR_UNSUPPORTED;
+
+    RECT destRect;
+    if (!GetBltFastDestRect(dwX, dwY, srcRect, srcSurface->GetFullSurfaceRect(), &destRect))
+      return DDERR_UNSUPPORTED;
+
+    return BltD3D9(srcSurface, &destRect, srcRect, (dwTrans & DDBLTFAST_SRCCOLORKEY) ? DDBLT_KEYSRC : 0, nullptr);
+  }
+
+  HRESULT DDrawCommonSurface::QueueBltD3D9(
+        DDrawCommonSurface* srcSurface,
+        const RECT* destRect,
+        const RECT* srcRect,
+        DWORD dwFlags,
+        const DDBLTFX* bltFx) {
+    const bool colorKeyed = dwFlags & (DDBLT_KEYSRC | DDBLT_KEYSRCOVERRIDE);
+
+    // Palette indices can't be matched against the expanded colors
+    if (colorKeyed && srcSurface->m_format9 == d3d9::D3DFMT_P8)
+      return D3DERR_INVALIDCALL;
+
+    const DDPIXELFORMAT* pixelFormat = (srcSurface->m_desc2.dwFlags & DDSD_PIXELFORMAT) ?
+                                       &srcSurface->m_desc2.ddpfPixelFormat : &srcSurface->m_desc.ddpfPixelFormat;
+
+    DDCOLORKEY colorKey = { };
+    if (dwFlags & DDBLT_KEYSRCOVERRIDE) {
+      if (bltFx == nullptr)
+        return D3DERR_INVALIDCALL;
+
+      colorKey = ColorKeyToARGB(pixelFormat, bltFx->ddckSrcColorkey.dwColorSpaceLowValue);
+    } else if (dwFlags & DDBLT_KEYSRC) {
+      if (!srcSurface->HasValidColorKey())
+        return D3DERR_INVALIDCALL;
+
+      colorKey = srcSurface->GetColorKeyNormalized();
+    }
+
+    const RECT src  = srcRect  != nullptr ? *srcRect  : srcSurface->m_rect;
+    const RECT dest = destRect != nullptr ? *destRect : m_rect;
+
+    // Leave any invalid rects to the CPU path to reject
+    if (IsEmptyRect(src) || IsEmptyRect(dest)
+     || src.left  < 0 || src.top  < 0 || src.right  > srcSurface->m_rect.right || src.bottom  > srcSurface->m_rect.bottom
+     || dest.left < 0 || dest.top < 0 || dest.right > m_rect.right             || dest.bottom > m_rect.bottom)
+      return D3DERR_INVALIDCALL;
+
+    // Top level textures can be sampled directly, unless they live in system memory
+    d3d9::IDirect3DTexture9* srcTexture9 = srcSurface->IsMipChainRoot() ? srcSurface->GetD3D9Texture() : nullptr;
+    if (srcTexture9 != nullptr) {
+      d3d9::D3DSURFACE_DESC srcDesc9;
+      srcTexture9->GetLevelDesc(0, &srcDesc9);
+      if (srcDesc9.Pool == d3d9::D3DPOOL_SYSTEMMEM)
+        srcTexture9 = nullptr;
+    }
+
+    // Anything else needs a copy to the scratch atlas, which
+    // plain copies are better off doing without altogether
+    if (srcTexture9 == nullptr && !colorKeyed)
+      return D3DERR_INVALIDCALL;
+
+    return m_commonD3DDevice->QueueBlt(m_surface9.ptr(), dest, srcSurface->GetD3D9Surface(),
+                                       srcTexture9, src, colorKeyed ? &colorKey : nullptr);
+  }
+
+  HRESULT DDrawCommonSurface::LoadD3D9(
+        DDrawCommonSurface* srcSurface,
+        const POINT* destPoint,
+        const RECT* srcRect,
+        DWORD dwFlags) {
+    if (!m_commonIntf->GetOptions()->gpuBlits || srcSurface == nullptr)
+      return DDERR_UNSUPPORTED;
+
+    // Only whole mip chains of identically laid out textures or cube maps are handled
+    if (!IsTextureOrCubeMap() || !srcSurface->IsTextureOrCubeMap()
+     || IsCubeMap() != srcSurface->IsCubeMap()
+     || !IsMipChainRoot() || !srcSurface->IsMipChainRoot()
+     || m_format9 != srcSurface->m_format9
+     || m_rect.right  != srcSurface->m_rect.right
+     || m_rect.bottom != srcSurface->m_rect.bottom)
+      return DDERR_UNSUPPORTED;
+
+    RECT  rect  = srcRect   != nullptr ? *srcRect   : srcSurface->m_rect;
+    POINT point = destPoint != nullptr ? *destPoint : POINT{ 0, 0 };
+
+    // Leave any invalid parameters to the CPU path to reject
+    if (rect.left < 0 || rect.top < 0 || IsEmptyRect(rect)
+     || rect.right > m_rect.right || rect.bottom > m_rect.bottom
+     || point.x < 0 || point.y < 0
+     || point.x + (rect.right  - rect.left) > m_rect.right
+     || point.y + (rect.bottom - rect.top)  > m_rect.bottom)
+      return DDERR_UNSUPPORTED;
+
+    // Halved rects would not stay block aligned on lower mips
+    if (IsDXTFormat() && (point.x != 0 || point.y != 0 || !IsFullSurfaceLock(&rect, nullptr)))
+      return DDERR_UNSUPPORTED;
+
+    // Cube map faces are selected through the flags
+    uint32_t faceMask = 1u;
+    if (IsCubeMap()) {
+      faceMask = (dwFlags & DDSCAPS2_CUBEMAP_ALLFACES) / DDSCAPS2_CUBEMAP_POSITIVEX;
+      if (faceMask == 0)
+        return DDERR_UNSUPPORTED;
+    }
+
+    const uint32_t mipCount = std::min<uint32_t>(GetMipCount(), ddrawCaps::MaxMipLevels);
+    if (srcSurface->GetMipCount() < mipCount)
+      return DDERR_UNSUPPORTED;
+
+    // Both sides need to be up to date on the D3D9 side first
+    if (unlikely(FAILED(srcSurface->InitializeOrUploadD3D9()) || FAILED(InitializeOrUploadD3D9())))
+      return DDERR_UNSUPPORTED;
+
+    d3d9::IDirect3DDevice9* d3d9Device = GetRefreshedD3D9Device();
+    if (unlikely(d3d9Device == nullptr || !IsInitialized() || !srcSurface->IsInitialized()))
+      return DDERR_UNSUPPORTED;
+
+    Com<IDxvkLegacyD3DDeviceBridge> bridge;
+    if (unlikely(FAILED(d3d9Device->QueryInterface(__uuidof(IDxvkLegacyD3DDeviceBridge), reinterpret_cast<void**>(&bridge))))) {
+      Logger::err("DDrawCommonSurface::LoadD3D9: Failed to get D3D9 Bridge");
+      return DDERR_UNSUPPORTED;
+    }
+
+    d3d9::D3DSURFACE_DESC srcDesc9;
+    d3d9::D3DSURFACE_DESC destDesc9;
+    srcSurface->m_surface9->GetDesc(&srcDesc9);
+    m_surface9->GetDesc(&destDesc9);
+
+    // UpdateSurface copies from D3DPOOL_SYSTEMMEM to D3DPOOL_DEFAULT, other
+    // destinations get filled straight out of the source's system memory
+    if (srcDesc9.Pool != d3d9::D3DPOOL_SYSTEMMEM)
+      return DDERR_UNSUPPORTED;
+
+    const bool useUpdateSurface = destDesc9.Pool == d3d9::D3DPOOL_DEFAULT;
+
+    std::array<uint16_t, ddrawCaps::MaxCubeMapFaces> loadedMips = { };
+
+    for (uint32_t face = 0; face < ddrawCaps::MaxCubeMapFaces; face++) {
+      if (!(faceMask & (1u << face)))
+        continue;
+
+      RECT  levelRect  = rect;
+      POINT levelPoint = point;
+
+      for (uint32_t level = 0; level < mipCount; level++) {
+        if (unlikely(IsEmptyRect(levelRect)))
+          break;
+
+        Com<d3d9::IDirect3DSurface9> srcLevel9  = srcSurface->GetD3D9MipSurface(face, level);
+        Com<d3d9::IDirect3DSurface9> destLevel9 = GetD3D9MipSurface(face, level);
+        // D3D9 may have capped the number of mip levels
+        if (unlikely(srcLevel9 == nullptr || destLevel9 == nullptr))
+          break;
+
+        HRESULT hr9 = D3DERR_INVALIDCALL;
+
+        if (useUpdateSurface)
+          hr9 = d3d9Device->UpdateSurface(srcLevel9.ptr(), &levelRect, destLevel9.ptr(), &levelPoint);
+
+        if (FAILED(hr9))
+          hr9 = bridge->UpdateTextureFromBuffer(destLevel9.ptr(), srcLevel9.ptr(), &levelRect, &levelPoint);
+
+        // Anything copied so far gets overwritten by the CPU path
+        if (unlikely(FAILED(hr9)))
+          return DDERR_UNSUPPORTED;
+
+        loadedMips[face] |= 1u << level;
+
+        // Lower mips receive the same region, scaled down accordingly
+        const LONG levelWidth  = std::max<LONG>(1, m_rect.right  >> (level + 1));
+        const LONG levelHeight = std::max<LONG>(1, m_rect.bottom >> (level + 1));
+
+        levelPoint = { levelPoint.x / 2, levelPoint.y / 2 };
+        levelRect  = { levelRect.left / 2, levelRect.top / 2,
+                       std::max<LONG>(levelRect.left / 2 + 1, levelRect.right  / 2),
+                       std::max<LONG>(levelRect.top  / 2 + 1, levelRect.bottom / 2) };
+        levelRect.right  = std::min(levelRect.right,  levelRect.left + (levelWidth  - levelPoint.x));
+        levelRect.bottom = std::min(levelRect.bottom, levelRect.top  + (levelHeight - levelPoint.y));
+      }
+    }
+
+    // The DDraw side now only gets read back if it's ever locked
+    for (uint32_t face = 0; face < ddrawCaps::MaxCubeMapFaces; face++) {
+      if (loadedMips[face] != 0)
+        StaleDDrawMips(face, loadedMips[face]);
+    }
+
+    return DD_OK;
+  }
+
+  Com<d3d9::IDirect3DSurface9> DDrawCommonSurface::GetD3D9MipSurface(uint32_t face, uint32_t level) const {
+    Com<d3d9::IDirect3DSurface9> surface9;
+
+    if (m_cubeMap9 != nullptr)
+      m_cubeMap9->GetCubeMapSurface(static_cast<d3d9::D3DCUBEMAP_FACES>(face), level, &surface9);
+    else if (m_texture9 != nullptr && face == 0)
+      m_texture9->GetSurfaceLevel(level, &surface9);
+
+    return surface9;
+  }
+
+  bool DDrawCommonSurface::CanReleaseDDrawStorage() const {
+    if (m_ddrawStorageReleased || m_ddrawStoragePinned)
+      return false;
+
+    // SetSurfaceDesc can only replace the storage of single level, unmanaged
+    // system memory surfaces, and we can only read back fixed size formats
+    if (!IsTexture() || IsCubeMap() || IsTextureMip() || IsManaged() || !IsInSystemMemory()
+      || IsRenderTarget() || !HasFixedPixelSize() || m_format9 == d3d9::D3DFMT_P8)
+      return false;
+
+    // The D3D9 side needs to hold the current content, and nothing may be locked
+    if (m_texture9 == nullptr || m_dirtyDDraw || HasStaleMips() || !IsEmptyRect(m_lockRect))
+      return false;
+
+    const uint32_t idleFrames = m_commonIntf->GetFrameCount() - m_ddrawStorageFrame;
+    return idleFrames >= static_cast<uint32_t>(m_commonIntf->GetOptions()->textureEvictionFrames);
+  }
+
+  bool DDrawCommonSurface::ReleaseDDrawStorage() {
+    // Swapping in a placeholder frees the storage allocated by DDraw,
+    // and we're free to do the same with our own after a restore
+    DDSURFACEDESC2 desc2 = { };
+    desc2.dwSize    = sizeof(DDSURFACEDESC2);
+    desc2.dwFlags   = DDSD_LPSURFACE | DDSD_WIDTH | DDSD_HEIGHT | DDSD_PITCH;
+    desc2.dwWidth   = 1;
+    desc2.dwHeight  = 1;
+    desc2.lPitch    = sizeof(m_ddrawStoragePlaceholder);
+    desc2.lpSurface = &m_ddrawStoragePlaceholder;
+
+    Com<IDirectDrawSurface7> proxied7 = QueryProxied7();
+
+    HRESULT hr = proxied7 != nullptr ? proxied7->SetSurfaceDesc(&desc2, 0) : DDERR_UNSUPPORTED;
+    if (unlikely(FAILED(hr))) {
+      Logger::debug("DDrawCommonSurface::ReleaseDDrawStorage: Failed to replace surface storage");
+      // Don't retry this on every scan
+      m_ddrawStoragePinned = true;
+      return false;
+    }
+
+    m_ddrawStorage = std::vector<uint8_t>();
+    m_ddrawStorageReleased = true;
+
+    // The content is now held only by the D3D9 side, and gets read back on demand
+    StaleDDrawMips(0, 1u);
+
+    m_commonIntf->TrackReleasedStorage(static_cast<uint64_t>(GetDDrawStoragePitch()) * m_rect.bottom);
+
+    return true;
+  }
+
+  void DDrawCommonSurface::RestoreDDrawStorage() {
+    const uint32_t pitch = GetDDrawStoragePitch();
+    const size_t   size  = static_cast<size_t>(pitch) * m_rect.bottom;
+
+    m_ddrawStorage.resize(size);
+
+    DDSURFACEDESC2 desc2 = { };
+    desc2.dwSize    = sizeof(DDSURFACEDESC2);
+    desc2.dwFlags   = DDSD_LPSURFACE | DDSD_WIDTH | DDSD_HEIGHT | DDSD_PITCH;
+    desc2.dwWidth   = m_rect.right;
+    desc2.dwHeight  = m_rect.bottom;
+    desc2.lPitch    = pitch;
+    desc2.lpSurface = m_ddrawStorage.data();
+
+    Com<IDirectDrawSurface7> proxied7 = QueryProxied7();
+
+    HRESULT hr = proxied7 != nullptr ? proxied7->SetSurfaceDesc(&desc2, 0) : DDERR_UNSUPPORTED;
+    if (unlikely(FAILED(hr)))
+      Logger::err("DDrawCommonSurface::RestoreDDrawStorage: Failed to restore surface storage");
+
+    m_ddrawStorageReleased = false;
+
+    m_commonIntf->TrackRestoredStorage(size);
+
+    TouchDDrawStorage();
+  }
+
+  void DDrawCommonSurface::PinDDrawStorage() {
+    // Restores the storage and reads back its content
+    if (unlikely(m_ddrawStorageReleased))
+      DownloadStaleMips();
+
+    m_ddrawStoragePinned = true;
+  }
+
+  void DDrawCommonSurface::DownloadStaleMips() {
+    // D3D7 surfaces can have any of their mips or faces written by Load
+    if (m_surf7 != nullptr) {
+      m_surf7->DownloadStaleMips();
+      return;
+    }
+
+    // Otherwise only the storage of single level textures gets released
+    if (unlikely(m_ddrawStorageReleased))
+      RestoreDDrawStorage();
+
+    if (!(GetStaleMips(0) & 1u))
+      return;
+
+    Com<IDirectDrawSurface7>     proxied7 = QueryProxied7();
+    Com<d3d9::IDirect3DSurface9> surface9 = GetD3D9MipSurface(0, 0);
+    if (likely(proxied7 != nullptr && surface9 != nullptr))
+      BlitToDDrawSurface<IDirectDrawSurface7, DDSURFACEDESC2>(proxied7.ptr(), surface9.ptr(), IsDXTFormat());
+
+    UnStaleDDrawMip(0, 0);
+  }
+
+  Com<IDirectDrawSurface7> DDrawCommonSurface::QueryProxied7() const {
+    if (m_surf7 != nullptr)
+      return m_surf7->GetProxied();
+
+    IUnknown* proxied = nullptr;
+    if (m_surf4 != nullptr)
+      proxied = m_surf4->GetProxied();
+    else if (m_surf3 != nullptr)
+      proxied = m_surf3->GetProxied();
+    else if (m_surf2 != nullptr)
+      proxied = m_surf2->GetProxied();
+    else if (m_surf != nullptr)
+      proxied = m_surf->GetProxied();
+
+    Com<IDirectDrawSurface7> proxied7;
+    if (proxied != nullptr)
+      proxied->QueryInterface(__uuidof(IDirectDrawSurface7), reinterpret_cast<void**>(&proxied7));
+
+    return proxied7;
+  }
+
 }
\ No newline at end of file
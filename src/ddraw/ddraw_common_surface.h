@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ddraw_include.h"
+#include "ddraw_caps.h"
 #include "ddraw_format.h"
 
 #include "ddraw_common_interface.h"
@@ -8,6 +9,10 @@
 #include "ddraw_clipper.h"
 #include "ddraw_palette.h"
 
+#include <array>
+#include <atomic>
+#include <vector>
+
 namespace dxvk {
 
   class D3DCommonDevice;
@@ -39,12 +44,25 @@ namespace dxvk {
 
     void RefreshD3D9Device();
 
+    bool IsOnD3D9Device(d3d9::IDirect3DDevice9* device9) const;
+
     d3d9::IDirect3DDevice9* GetRefreshedD3D9Device();
 
+    // Needs to be called before reading back or writing to the
+    // surface, in case a pending batched draw depends on it
+    void FlushBatchedDraws();
+
     HRESULT InitializeD3D9(const bool initRenderTarget);
 
     HRESULT InitializeOrUploadD3D9();
 
+    HRESULT BltD3D9(DDrawCommonSurface* srcSurface, const RECT* destRect, const RECT* srcRect,
+                    DWORD dwFlags, const DDBLTFX* bltFx);
+
+    HRESULT BltFastD3D9(DDrawCommonSurface* srcSurface, DWORD dwX, DWORD dwY, const RECT* srcRect, DWORD dwTrans);
+
+    HRESULT LoadD3D9(DDrawCommonSurface* srcSurface, const POINT* destPoint, const RECT* srcRect, DWORD dwFlags);
+
     bool IsInitialized() const {
       return m_surface9 != nullptr;
     }
@@ -183,23 +201,199 @@ namespace dxvk {
     }
 
     void DirtyDDrawSurface() {
-      m_dirtyDDraw = true;
+      m_dirtyDDraw     = true;
+      m_dirtyRectCount = 0;
+      m_ddrawWrites++;
+      InvalidateDDrawMirror();
+      // Stale mips haven't been read back, so their DDraw side data is not worth uploading
+      for (uint32_t face = 0; face < ddrawCaps::MaxCubeMapFaces; face++)
+        m_dirtyMips[face] = AllMipLevels & ~m_staleMips[face];
+
+      DirtyMipChainRoot();
     }
 
+    void DirtyDDrawSurface(const RECT* dirtyRect);
+
     void UnDirtyDDrawSurface() {
-      m_dirtyDDraw = false;
+      m_dirtyDDraw     = false;
+      m_dirtyRectCount = 0;
+      m_dirtyMips.fill(0);
+      // Mirrors made right before the upload now only lack what gets written next
+      m_mirrorExact    = m_mirrorPending;
+      m_mirrorPending  = false;
+
+      TouchDDrawStorage();
+    }
+
+    // Mip levels of the given cube map face (or of a plain texture,
+    // as face 0) which need to be uploaded, one bit for every level
+    uint16_t GetDirtyMips(uint32_t face = 0) const {
+      return m_dirtyMips[face];
+    }
+
+    uint32_t GetDirtyMipCount(uint32_t face = 0) const {
+      const uint32_t levelCount = std::min<uint32_t>(GetMipCount(), ddrawCaps::MaxMipLevels);
+      return bit::popcnt(static_cast<uint32_t>(m_dirtyMips[face]) & ((1u << levelCount) - 1u));
+    }
+
+    void AttachToMipChain(DDrawCommonSurface* parent);
+
+    DDrawCommonSurface* GetMipChainRoot() {
+      return m_mipChainRoot != nullptr ? m_mipChainRoot.ptr() : this;
+    }
+
+    bool IsMipChainRoot() const {
+      return m_mipChainRoot == nullptr;
+    }
+
+    uint32_t GetMipChainFace() const {
+      return m_mipChainFace;
+    }
+
+    uint32_t GetMipChainLevel() const {
+      return m_mipChainLevel;
+    }
+
+    // Mip levels of the given cube map face (or of a plain texture, as face 0)
+    // which have been written on the GPU, and as such have a stale DDraw side copy
+    uint16_t GetStaleMips(uint32_t face = 0) const {
+      return m_staleMips[face];
+    }
+
+    bool HasStaleMips() const {
+      for (uint16_t staleMips : m_staleMips) {
+        if (staleMips != 0)
+          return true;
+      }
+      return false;
+    }
+
+    void StaleDDrawMips(uint32_t face, uint16_t mips) {
+      m_staleMips[face] |= mips;
+      // Any pending DDraw side writes have been uploaded prior to the GPU write
+      m_dirtyMips[face] &= ~mips;
+      m_mipHashes.fill(0);
+    }
+
+    void UnStaleDDrawMip(uint32_t face, uint32_t level) {
+      m_staleMips[face] &= ~(1u << level);
     }
 
+    Com<d3d9::IDirect3DSurface9> GetD3D9MipSurface(uint32_t face, uint32_t level) const;
+
+    // Idle textures can have their DDraw side storage replaced by a placeholder,
+    // with the content being held only by D3D9 until it gets accessed again
+    bool IsDDrawStorageReleased() const {
+      return m_ddrawStorageReleased;
+    }
+
+    void TouchDDrawStorage() {
+      m_ddrawStorageFrame = m_commonIntf->GetFrameCount();
+    }
+
+    bool CanReleaseDDrawStorage() const;
+
+    bool ReleaseDDrawStorage();
+
+    // The eviction scan only marks surfaces, which get their storage released on their
+    // next upload, by the thread using them, like any other change to the surface
+    void MarkDDrawStorageEvictable() {
+      m_ddrawStorageEvictable.store(true, std::memory_order_relaxed);
+    }
+
+    void ReleaseEvictableDDrawStorage() {
+      if (likely(!m_ddrawStorageEvictable.load(std::memory_order_relaxed)))
+        return;
+
+      m_ddrawStorageEvictable.store(false, std::memory_order_relaxed);
+
+      if (CanReleaseDDrawStorage())
+        ReleaseDDrawStorage();
+    }
+
+    void RestoreDDrawStorage();
+
+    // Needed before the application replaces the storage itself
+    void PinDDrawStorage();
+
+    // Reads back GPU side writes, including the content of released storage
+    void DownloadStaleMips();
+
+    // Dirty surfaces without any tracked rects need a full upload
+    uint32_t GetDirtyRectCount() const {
+      return m_dirtyRectCount;
+    }
+
+    const RECT* GetDirtyRects() const {
+      return m_dirtyRects.data();
+    }
+
+    void TrackLockRect(const RECT* lockRect);
+
+    void DirtyDDrawSurfaceOnUnlock();
+
     bool IsD3D9SurfaceDirty() const {
       return m_dirtyD3D9;
     }
 
     void DirtyD3D9Surface() {
-      m_dirtyD3D9 = true;
+      m_dirtyD3D9      = true;
+      m_validRectCount = 0;
+      // D3D9 side content no longer matches what was last uploaded
+      m_mipHashes.fill(0);
     }
 
     void UnDirtyD3D9Surface() {
-      m_dirtyD3D9 = false;
+      m_dirtyD3D9      = false;
+      m_validRectCount = 0;
+      // Read backs change the DDraw side outside of any dirty rects
+      InvalidateDDrawMirror();
+    }
+
+    bool IsDDrawRectValid(const RECT* rect) const;
+
+    // Mirrors the DDraw side onto another surface, such as the emulated front
+    // buffer. Only the dirty rects get copied if those are known to cover every
+    // change on either side since the last mirror, otherwise the entire surface.
+    template <typename SurfaceType>
+    void CopyDirtyDDrawRects(const DDrawCommonSurface* destCommonSurf, SurfaceType* destSurface, SurfaceType* srcSurface) {
+      const bool rectsExact = m_mirrorExact && m_dirtyRectCount != 0
+                           && m_mirrorDest       == destCommonSurf
+                           && m_mirrorDestWrites == destCommonSurf->m_ddrawWrites;
+
+      if (rectsExact) {
+        for (uint32_t i = 0; i < m_dirtyRectCount; i++) {
+          RECT rect = m_dirtyRects[i];
+          destSurface->BltFast(rect.left, rect.top, srcSurface, &rect, DDBLTFAST_NOCOLORKEY);
+        }
+      } else {
+        destSurface->BltFast(0, 0, srcSurface, nullptr, DDBLTFAST_NOCOLORKEY);
+      }
+
+      m_mirrorDest       = destCommonSurf;
+      m_mirrorDestWrites = destCommonSurf->m_ddrawWrites;
+      m_mirrorPending    = true;
+    }
+
+    uint64_t* GetMipHashes() {
+      return m_commonIntf->GetOptions()->textureUploadHashing ? m_mipHashes.data() : nullptr;
+    }
+
+    bool TrackValidDDrawRect(const RECT* rect, RECT* validRect);
+
+    static bool GetBltFastDestRect(DWORD dwX, DWORD dwY, const RECT* srcRect,
+                                   const RECT* srcFullSurfaceRect, RECT* destRect) {
+      if (srcRect == nullptr)
+        srcRect = srcFullSurfaceRect;
+
+      if (unlikely(srcRect == nullptr))
+        return false;
+
+      *destRect = { static_cast<LONG>(dwX), static_cast<LONG>(dwY),
+                    static_cast<LONG>(dwX) + (srcRect->right  - srcRect->left),
+                    static_cast<LONG>(dwY) + (srcRect->bottom - srcRect->top) };
+
+      return true;
     }
 
     void SetIsAttached(bool isAttached) {
@@ -241,15 +435,19 @@ namespace dxvk {
     void SetPalette(DDrawPalette* palette) {
       if (likely(m_palette != palette)) {
         if (unlikely(m_palette != nullptr))
-          m_palette->SetCommonSurface(nullptr);
+          m_palette->RemoveCommonSurface(this);
 
         m_palette = palette;
 
-        if (likely(m_palette != nullptr))
-          m_palette->SetCommonSurface(this);
+        if (likely(m_palette != nullptr)) {
+          m_palette->AddCommonSurface(this);
+          UpdateD3D9Palette();
+        }
       }
     }
 
+    HRESULT UpdateD3D9Palette();
+
     DDrawPalette* GetPalette() const {
       return m_palette.ptr();
     }
@@ -411,6 +609,13 @@ namespace dxvk {
           || m_format9 == d3d9::D3DFMT_DXT5;
     }
 
+    bool HasFixedPixelSize() const {
+      const DDPIXELFORMAT* pixelFormat = (m_desc2.dwFlags & DDSD_PIXELFORMAT) ? &m_desc2.ddpfPixelFormat : &m_desc.ddpfPixelFormat;
+      const uint8_t colorBitCount = GetColorBitCount();
+
+      return !(pixelFormat->dwFlags & DDPF_FOURCC) && colorBitCount != 0 && (colorBitCount % 8) == 0;
+    }
+
     bool Is8BitFormat() const {
       return m_format9 == d3d9::D3DFMT_R3G3B2
           || m_format9 == d3d9::D3DFMT_P8;
@@ -501,6 +706,48 @@ namespace dxvk {
 
   private:
 
+    static constexpr uint16_t AllMipLevels = (1u << ddrawCaps::MaxMipLevels) - 1u;
+
+    // Only marks the top level as dirty, leaving any other mips as they are
+    void DirtyDDrawTopLevel() {
+      m_dirtyDDraw     = true;
+      m_dirtyRectCount = 0;
+      m_dirtyMips[0]  |= 1u;
+      m_ddrawWrites++;
+      InvalidateDDrawMirror();
+    }
+
+    // For changes of the DDraw side which the dirty rects don't cover
+    void InvalidateDDrawMirror() {
+      m_mirrorExact   = false;
+      m_mirrorPending = false;
+    }
+
+    void DirtyDDrawSubresource(uint32_t face, uint32_t level) {
+      m_dirtyDDraw        = true;
+      m_dirtyMips[face]  |= 1u << level;
+    }
+
+    // Mip sub-levels and cube map faces forward their changes to the top level surface
+    void DirtyMipChainRoot() {
+      if (unlikely(m_mipChainRoot != nullptr))
+        m_mipChainRoot->DirtyDDrawSubresource(m_mipChainFace, m_mipChainLevel);
+    }
+
+    // Source color keyed blits, as well as plain blits from textures, get
+    // queued on the D3D device and drawn as a batch of textured quads
+    HRESULT QueueBltD3D9(DDrawCommonSurface* srcSurface, const RECT* destRect, const RECT* srcRect,
+                         DWORD dwFlags, const DDBLTFX* bltFx);
+
+    // Every DDraw surface exposes IDirectDrawSurface7, no matter which
+    // interface version it got created with, so storage swaps use it
+    Com<IDirectDrawSurface7> QueryProxied7() const;
+
+    // Restored storage rows need to be DWORD aligned
+    uint32_t GetDDrawStoragePitch() const {
+      return (static_cast<uint32_t>(m_rect.right) * (GetColorBitCount() / 8u) + 3u) & ~3u;
+    }
+
     inline void RefreshStaticDescData(const bool refreshFormat) {
       // determine and cache various frequently used flag combinations
       m_isRenderTarget          = IsFrontBuffer() || IsBackBuffer() || IsFlippable() || Is3DSurface();
@@ -522,6 +769,47 @@ namespace dxvk {
     bool                             m_dirtyDDraw         = false;
     bool                             m_dirtyD3D9          = false;
 
+    uint32_t                         m_dirtyRectCount     = 0;
+    std::array<RECT, ddrawCaps::MaxDirtyRects> m_dirtyRects = { };
+    // Union of all currently outstanding surface lock rects
+    RECT                             m_lockRect           = { };
+
+    // Regions of the DDraw surface which have already been read back
+    // from a dirty D3D9 surface, and as such don't need to be read again
+    uint32_t                         m_validRectCount     = 0;
+    std::array<RECT, ddrawCaps::MaxDirtyRects> m_validRects = { };
+
+    // Counts DDraw side writes, so mirrors can tell if their destination got written
+    uint64_t                         m_ddrawWrites        = 0;
+    // Surface last mirrored onto, see CopyDirtyDDrawRects
+    const DDrawCommonSurface*        m_mirrorDest         = nullptr;
+    uint64_t                         m_mirrorDestWrites   = 0;
+    bool                             m_mirrorExact        = false;
+    bool                             m_mirrorPending      = false;
+
+    // Content hashes of the last uploaded texture mips, with 0 meaning unknown
+    std::array<uint64_t, ddrawCaps::MaxMipLevels> m_mipHashes = { };
+
+    // Per cube map face (or face 0 for textures) bit masks of dirty mip levels
+    std::array<uint16_t, ddrawCaps::MaxCubeMapFaces> m_dirtyMips = { };
+
+    // Per cube map face (or face 0 for textures) bit masks of mip levels which
+    // only hold valid data on the D3D9 side, and get read back on demand
+    std::array<uint16_t, ddrawCaps::MaxCubeMapFaces> m_staleMips = { };
+
+    // DDraw side storage of textures, once it's been restored after a release
+    std::vector<uint8_t>             m_ddrawStorage;
+    uint32_t                         m_ddrawStoragePlaceholder = 0;
+    uint32_t                         m_ddrawStorageFrame       = 0;
+    bool                             m_ddrawStorageReleased    = false;
+    bool                             m_ddrawStoragePinned      = false;
+    std::atomic<bool>                m_ddrawStorageEvictable   = { false };
+
+    // Top level surface of the mip chain or cube map this surface is a part of
+    Com<DDrawCommonSurface>          m_mipChainRoot;
+    uint32_t                         m_mipChainFace       = 0;
+    uint32_t                         m_mipChainLevel      = 0;
+
     bool                             m_isAttached         = false;
     bool                             m_isD3D9BackBuffer   = false;
     bool                             m_isD3D9DepthStencil = false;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ddraw_include.h"
+#include "ddraw_caps.h"
 
 #include <vector>
 #include <cmath>
@@ -686,18 +687,22 @@ namespace dxvk {
     return DDENUMRET_OK;
   }
 
+  // Uploads the dirty mips of a cube map face, using its cached mip chain
   inline void BlitToD3D9CubeMap(
         d3d9::IDirect3DCubeTexture9* cubeTex9,
-        IDirectDrawSurface7* surface,
+        const d3d9::D3DCUBEMAP_FACES face,
+        IDirectDrawSurface7* const* mipMaps,
         const uint16_t mipLevels,
+        const uint16_t dirtyMips,
         const bool isDXTFormat) {
-    DDSURFACEDESC2 desc;
-    desc.dwSize = sizeof(DDSURFACEDESC2);
-    surface->GetSurfaceDesc(&desc);
-    const d3d9::D3DCUBEMAP_FACES face = GetCubemapFace(&desc);
-    IDirectDrawSurface7* mipMap = surface;
+    const uint16_t levelCount = std::min<uint16_t>(mipLevels, ddrawCaps::MaxMipLevels);
 
-    for (uint16_t i = 0; i < mipLevels; i++) {
+    for (uint16_t i = 0; i < levelCount; i++) {
+      // Only upload the mips which have actually been touched
+      if (!(dirtyMips & (1u << i)))
+        continue;
+
+      IDirectDrawSurface7* mipMap = mipMaps[i];
       // Should never occur normally, but acts as a last ditch safety check
       if (unlikely(mipMap == nullptr)) {
         Logger::warn(str::format("BlitToD3D9CubeMap: Last found source mip ", i - 1));
@@ -738,90 +743,277 @@ namespace dxvk {
           Logger::warn(str::format("BlitToD3D9CubeMap: Failed to lock mip ", i));
         }
         cubeTex9->UnlockRect(face, i);
-
-        IDirectDrawSurface7* parentSurface = mipMap;
-        mipMap = nullptr;
-
-        parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfaces7Callback);
       } else {
         Logger::warn(str::format("BlitToD3D9CubeMap: Failed to lock D3D9 mip ", i));
       }
     }
   }
 
-  template <typename SurfaceType, typename DescType>
-  inline void BlitToD3D9Texture(
-        d3d9::IDirect3DTexture9* texture9,
+  template <typename SurfaceType>
+  inline SurfaceType* GetNextMipMap(SurfaceType* parentSurface) {
+    SurfaceType* mipMap = nullptr;
+
+    if constexpr (std::is_same<SurfaceType, IDirectDrawSurface7>::value) {
+      parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfaces7Callback);
+    } else if constexpr (std::is_same<SurfaceType, IDirectDrawSurface4>::value) {
+      parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfaces4Callback);
+    } else if constexpr (std::is_same<SurfaceType, IDirectDrawSurface>::value) {
+      parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfacesCallback);
+    } else {
+      Logger::err("GetNextMipMap: Unsupported surface type");
+    }
+
+    return mipMap;
+  }
+
+  // Walks the mip chain of a surface once, caching every level along the way,
+  // so that uploads don't need to go through EnumAttachedSurfaces each time
+  template <typename SurfaceType>
+  inline void ListMipChain(
         SurfaceType* surface,
-        const uint16_t mipLevels,
-        const bool isDXTFormat) {
+        SurfaceType** mipMaps,
+        const uint16_t mipLevels) {
+    const uint16_t levelCount = std::min<uint16_t>(mipLevels, ddrawCaps::MaxMipLevels);
+
     SurfaceType* mipMap = surface;
+    for (uint16_t i = 0; i < ddrawCaps::MaxMipLevels; i++) {
+      mipMaps[i] = mipMap;
+      if (mipMap != nullptr)
+        mipMap = i + 1 < levelCount ? GetNextMipMap(mipMap) : nullptr;
+    }
+  }
+
+  template <typename DescType>
+  inline uint32_t GetBytesPerPixel(const DescType& desc) {
+    // FOURCC formats have no fixed per-pixel size we can rely on
+    if (unlikely(desc.ddpfPixelFormat.dwFlags & DDPF_FOURCC))
+      return 0;
+
+    const DWORD bitCount = desc.ddpfPixelFormat.dwRGBBitCount;
+
+    return (bitCount % 8) == 0 ? bitCount / 8 : 0;
+  }
+
+  // Copies only the given dirty rects of a locked DDraw surface to the D3D9 surface.
+  // Returns false if a partial copy isn't possible, in which case a full copy is needed.
+  template <typename DescType>
+  inline bool BlitDirtyRectsToD3D9Surface(
+        d3d9::IDirect3DSurface9* surface9,
+        const DescType& desc,
+        const RECT* dirtyRects,
+        const uint32_t dirtyRectCount) {
+    const uint32_t bytesPerPixel = GetBytesPerPixel(desc);
+    if (unlikely(bytesPerPixel == 0))
+      return false;
+
+    const uint8_t* data7 = reinterpret_cast<const uint8_t*>(desc.lpSurface);
+    const size_t pitch7 = static_cast<size_t>(desc.lPitch);
+
+    for (uint32_t i = 0; i < dirtyRectCount; i++) {
+      const RECT& rect = dirtyRects[i];
+
+      d3d9::D3DLOCKED_RECT rect9;
+      // Can't use D3DLOCK_DISCARD here, since the rest of the surface needs to be preserved
+      HRESULT hr9 = surface9->LockRect(&rect9, &rect, 0);
+      if (unlikely(FAILED(hr9))) {
+        Logger::warn("BlitDirtyRectsToD3D9Surface: Failed to lock D3D9 surface rect");
+        return false;
+      }
+
+      uint8_t* data9 = reinterpret_cast<uint8_t*>(rect9.pBits);
+      const uint8_t* rectData7 = &data7[rect.top * pitch7 + rect.left * bytesPerPixel];
+
+      const size_t rowSize = static_cast<size_t>(rect.right - rect.left) * bytesPerPixel;
+      const uint32_t rowCount = static_cast<uint32_t>(rect.bottom - rect.top);
+      for (uint32_t h = 0; h < rowCount; h++)
+        memcpy(&data9[h * rect9.Pitch], &rectData7[h * pitch7], rowSize);
 
-    for (uint16_t i = 0; i < mipLevels; i++) {
+      surface9->UnlockRect();
+    }
+
+    return true;
+  }
+
+  template <typename SurfaceType, typename DescType>
+  inline bool BlitDirtyRectsToD3D9Surface(
+        d3d9::IDirect3DSurface9* surface9,
+        SurfaceType* surface,
+        const RECT* dirtyRects,
+        const uint32_t dirtyRectCount) {
+    DescType desc;
+    desc.dwSize = sizeof(DescType);
+    HRESULT hr = surface->Lock(NULL, &desc, DDLOCK_READONLY, NULL);
+    if (unlikely(FAILED(hr))) {
+      Logger::warn("BlitDirtyRectsToD3D9Surface: Failed to lock surface");
+      return false;
+    }
+
+    const bool blitted = BlitDirtyRectsToD3D9Surface(surface9, desc, dirtyRects, dirtyRectCount);
+
+    surface->Unlock(NULL);
+
+    return blitted;
+  }
+
+  // Quick 64-bit hash of the rows of a locked surface. Four independent lanes
+  // get fed 32 bytes at a time, which keeps the multiplies pipelined and leaves
+  // the compiler free to vectorize, before the lanes get folded together.
+  inline uint64_t HashSurfaceData(
+        const uint8_t* data,
+        const size_t rowSize,
+        const uint32_t rowCount,
+        const size_t pitch) {
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+
+    auto rotl = [] (uint64_t value, uint32_t bits) {
+      return (value << bits) | (value >> (64u - bits));
+    };
+
+    uint64_t lanes[4] = { Prime1, Prime2, ~Prime1, ~Prime2 };
+
+    for (uint32_t h = 0; h < rowCount; h++) {
+      const uint8_t* row = data + h * pitch;
+
+      size_t i = 0;
+      for (; i + 32 <= rowSize; i += 32) {
+        for (uint32_t l = 0; l < 4; l++) {
+          uint64_t value;
+          memcpy(&value, row + i + l * sizeof(value), sizeof(value));
+          lanes[l] = rotl(lanes[l] + value * Prime2, 31) * Prime1;
+        }
+      }
+
+      for (; i < rowSize; i++)
+        lanes[i & 3] = (lanes[i & 3] ^ row[i]) * Prime1;
+    }
+
+    uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+
+    return hash;
+  }
+
+  // Uploads the dirty mips of a texture, using its cached mip chain. When mip hashes
+  // are provided, mips whose content hasn't changed since their last upload will
+  // be skipped entirely. Returns the number of mips that have been skipped.
+  template <typename SurfaceType, typename DescType>
+  inline uint32_t BlitToD3D9Texture(
+        d3d9::IDirect3DTexture9* texture9,
+        SurfaceType* const* mipMaps,
+        const uint16_t mipLevels,
+        const uint16_t dirtyMips,
+        const bool isDXTFormat,
+        const RECT* dirtyRects = nullptr,
+        const uint32_t dirtyRectCount = 0,
+        uint64_t* mipHashes = nullptr) {
+    const uint16_t levelCount = std::min<uint16_t>(mipLevels, ddrawCaps::MaxMipLevels);
+    uint32_t skippedMips = 0;
+
+    for (uint16_t i = 0; i < levelCount; i++) {
+      // Only upload the mips which have actually been touched
+      if (!(dirtyMips & (1u << i)))
+        continue;
+
+      SurfaceType* mipMap = mipMaps[i];
       // Should never occur normally, but acts as a last ditch safety check
       if (unlikely(mipMap == nullptr)) {
         Logger::warn(str::format("BlitToD3D9Texture: Last found source mip ", i - 1));
         break;
       }
 
+      // Dirty rects only ever apply to the top level mip
+      if (i == 0 && dirtyRectCount != 0 && !isDXTFormat) {
+        Com<d3d9::IDirect3DSurface9> level9;
+        HRESULT hr9 = texture9->GetSurfaceLevel(0, &level9);
+        if (likely(SUCCEEDED(hr9)) &&
+            BlitDirtyRectsToD3D9Surface<SurfaceType, DescType>(level9.ptr(), mipMap, dirtyRects, dirtyRectCount)) {
+          // The top level mip hash is no longer accurate
+          if (mipHashes != nullptr)
+            mipHashes[0] = 0;
+          continue;
+        }
+      }
+
+      DescType descMip;
+      descMip.dwSize = sizeof(DescType);
+      HRESULT hr = mipMap->Lock(NULL, &descMip, DDLOCK_READONLY, NULL);
+      if (unlikely(FAILED(hr))) {
+        Logger::warn(str::format("BlitToD3D9Texture: Failed to lock mip ", i));
+        continue;
+      }
+
+      const uint8_t* data7 = reinterpret_cast<const uint8_t*>(descMip.lpSurface);
+
+      // Skip the D3D9 side lock and copy altogether if the content is unchanged
+      if (mipHashes != nullptr) {
+        const uint32_t bytesPerPixel = GetBytesPerPixel(descMip);
+        // The lock pitch of a DXT surface represents its entire size, apparently
+        const uint32_t rowCount = isDXTFormat ? 1 : descMip.dwHeight;
+        const size_t   rowSize  = isDXTFormat || bytesPerPixel == 0 ? static_cast<size_t>(descMip.lPitch)
+                                                                    : static_cast<size_t>(descMip.dwWidth * bytesPerPixel);
+        const uint64_t hash     = HashSurfaceData(data7, rowSize, rowCount, static_cast<size_t>(descMip.lPitch));
+
+        if (hash == mipHashes[i]) {
+          mipMap->Unlock(NULL);
+          skippedMips++;
+          continue;
+        }
+
+        mipHashes[i] = hash;
+      }
+
       d3d9::D3DLOCKED_RECT rect9mip;
       // D3DLOCK_DISCARD will get ignored for MANAGED/SYSTEMMEM, but will work on DEFAULT
       HRESULT hr9 = texture9->LockRect(i, &rect9mip, NULL, D3DLOCK_DISCARD);
       if (likely(SUCCEEDED(hr9))) {
-        DescType descMip;
-        descMip.dwSize = sizeof(DescType);
-        HRESULT hr = mipMap->Lock(NULL, &descMip, DDLOCK_READONLY, NULL);
-        if (likely(SUCCEEDED(hr))) {
-          // The lock pitch of a DXT surface represents its entire size, apparently
-          if (isDXTFormat) {
-            const size_t size = static_cast<size_t>(descMip.lPitch);
-            memcpy(rect9mip.pBits, descMip.lpSurface, size);
-            //Logger::debug(str::format("BlitToD3D9Texture: Done blitting DXT mip ", i));
-          } else if (descMip.lPitch != rect9mip.Pitch) {
-            //Logger::debug(str::format("BlitToD3D9Texture: Incompatible mip map ", i, " pitch"));
+        // The lock pitch of a DXT surface represents its entire size, apparently
+        if (isDXTFormat) {
+          const size_t size = static_cast<size_t>(descMip.lPitch);
+          memcpy(rect9mip.pBits, data7, size);
+          //Logger::debug(str::format("BlitToD3D9Texture: Done blitting DXT mip ", i));
+        } else if (descMip.lPitch != rect9mip.Pitch) {
+          //Logger::debug(str::format("BlitToD3D9Texture: Incompatible mip map ", i, " pitch"));
 
-            uint8_t* data9 = reinterpret_cast<uint8_t*>(rect9mip.pBits);
-            uint8_t* data7 = reinterpret_cast<uint8_t*>(descMip.lpSurface);
+          uint8_t* data9 = reinterpret_cast<uint8_t*>(rect9mip.pBits);
 
-            const size_t copyPitch = std::min<size_t>(descMip.lPitch, rect9mip.Pitch);
-            for (uint32_t h = 0; h < descMip.dwHeight; h++)
-              memcpy(&data9[h * rect9mip.Pitch], &data7[h * descMip.lPitch], copyPitch);
+          const size_t copyPitch = std::min<size_t>(descMip.lPitch, rect9mip.Pitch);
+          for (uint32_t h = 0; h < descMip.dwHeight; h++)
+            memcpy(&data9[h * rect9mip.Pitch], &data7[h * descMip.lPitch], copyPitch);
 
-            //Logger::debug(str::format("BlitToD3D9Texture: Done blitting mip ", i, " row by row"));
-          } else {
-            const size_t size = static_cast<size_t>(descMip.dwHeight * descMip.lPitch);
-            memcpy(rect9mip.pBits, descMip.lpSurface, size);
-            //Logger::debug(str::format("BlitToD3D9Texture: Done blitting mip ", i));
-          }
-          mipMap->Unlock(NULL);
+          //Logger::debug(str::format("BlitToD3D9Texture: Done blitting mip ", i, " row by row"));
         } else {
-          Logger::warn(str::format("BlitToD3D9Texture: Failed to lock mip ", i));
+          const size_t size = static_cast<size_t>(descMip.dwHeight * descMip.lPitch);
+          memcpy(rect9mip.pBits, data7, size);
+          //Logger::debug(str::format("BlitToD3D9Texture: Done blitting mip ", i));
         }
         texture9->UnlockRect(i);
-
-        SurfaceType* parentSurface = mipMap;
-        mipMap = nullptr;
-
-        if constexpr (std::is_same<SurfaceType, IDirectDrawSurface7>::value) {
-          parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfaces7Callback);
-        } else if constexpr (std::is_same<SurfaceType, IDirectDrawSurface4>::value) {
-          parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfaces4Callback);
-        } else if constexpr (std::is_same<SurfaceType, IDirectDrawSurface>::value) {
-          parentSurface->EnumAttachedSurfaces(&mipMap, ListMipChainSurfacesCallback);
-        } else {
-          Logger::err("BlitToD3D9Texture: Unsupported surface type");
-        }
       } else {
         Logger::warn(str::format("BlitToD3D9Texture: Failed to lock D3D9 mip ", i));
+        // Make sure the mip gets uploaded next time around
+        if (mipHashes != nullptr)
+          mipHashes[i] = 0;
       }
+      mipMap->Unlock(NULL);
     }
+
+    return skippedMips;
   }
 
   template <typename SurfaceType, typename DescType>
   inline void BlitToD3D9Surface(
         d3d9::IDirect3DSurface9* surface9,
         SurfaceType* surface,
-        const bool isDXTFormat) {
+        const bool isDXTFormat,
+        const RECT* dirtyRects = nullptr,
+        const uint32_t dirtyRectCount = 0) {
+    // Only copy the dirty regions of the surface, if any are being tracked
+    if (dirtyRectCount != 0 && !isDXTFormat &&
+        BlitDirtyRectsToD3D9Surface<SurfaceType, DescType>(surface9, surface, dirtyRects, dirtyRectCount))
+      return;
+
     d3d9::D3DLOCKED_RECT rect9;
     // D3DLOCK_DISCARD will get ignored for MANAGED/SYSTEMMEM, but will work on DEFAULT
     HRESULT hr9 = surface9->LockRect(&rect9, NULL, D3DLOCK_DISCARD);
@@ -865,19 +1057,36 @@ namespace dxvk {
   inline void BlitToDDrawSurface(
         SurfaceType* surface,
         d3d9::IDirect3DSurface9* surface9,
-        const bool isDXTFormat) {
+        const bool isDXTFormat,
+        const RECT* rect = nullptr) {
+    // Partial read backs aren't possible for DXT formats
+    if (unlikely(isDXTFormat))
+      rect = nullptr;
+
+    RECT* lockRect = const_cast<RECT*>(rect);
+
     DescType desc;
     desc.dwSize = sizeof(DescType);
-    HRESULT hr = surface->Lock(NULL, &desc, DDLOCK_WRITEONLY, NULL);
+    HRESULT hr = surface->Lock(lockRect, &desc, DDLOCK_WRITEONLY, NULL);
     if (likely(SUCCEEDED(hr))) {
       d3d9::D3DLOCKED_RECT rect9;
-      HRESULT hr9 = surface9->LockRect(&rect9, NULL, D3DLOCK_READONLY);
+      HRESULT hr9 = surface9->LockRect(&rect9, rect, D3DLOCK_READONLY);
       if (likely(SUCCEEDED(hr9))) {
         // The lock pitch of a DXT surface represents its entire size, apparently
         if (unlikely(isDXTFormat)) {
           const size_t size = static_cast<size_t>(desc.lPitch);
           memcpy(desc.lpSurface, rect9.pBits, size);
           //Logger::debug("BlitToDDrawSurface: Done blitting DXT surface");
+        } else if (rect != nullptr) {
+          uint8_t* data7 = reinterpret_cast<uint8_t*>(desc.lpSurface);
+          uint8_t* data9 = reinterpret_cast<uint8_t*>(rect9.pBits);
+
+          const size_t rowSize = static_cast<size_t>(rect->right - rect->left) * GetBytesPerPixel(desc);
+          const uint32_t rowCount = static_cast<uint32_t>(rect->bottom - rect->top);
+          for (uint32_t h = 0; h < rowCount; h++)
+            memcpy(&data7[h * desc.lPitch], &data9[h * rect9.Pitch], rowSize);
+
+          //Logger::debug("BlitToDDrawSurface: Done blitting surface rect");
         } else if (desc.lPitch != rect9.Pitch) {
           //Logger::debug("BlitToDDrawSurface: Incompatible surface pitch");
 
@@ -898,7 +1107,12 @@ namespace dxvk {
       } else {
         Logger::warn("BlitToDDrawSurface: Failed to lock D3D9 surface");
       }
-      surface->Unlock(NULL);
+      // Older surface versions expect the locked surface pointer on unlock
+      if constexpr (std::is_same<DescType, DDSURFACEDESC2>::value) {
+        surface->Unlock(lockRect);
+      } else {
+        surface->Unlock(rect != nullptr ? desc.lpSurface : NULL);
+      }
     } else {
       Logger::warn("BlitToDDrawSurface: Failed to lock surface");
     }
@@ -931,6 +1145,37 @@ namespace dxvk {
     return colorKey;
   }
 
+  inline DWORD ExpandColorChannel(DWORD pixel, DWORD mask) {
+    if (unlikely(mask == 0))
+      return 0;
+
+    uint32_t shift = 0;
+    DWORD cmask = mask;
+    while ((cmask & 1) == 0) {
+      cmask >>= 1;
+      shift++;
+    }
+
+    const DWORD value = (pixel & mask) >> shift;
+
+    return (value * 255 + cmask / 2) / cmask;
+  }
+
+  // Unlike color keys, fill colors need to match the DDraw pixel value exactly
+  inline bool FillColorToARGB(const DDPIXELFORMAT* fmt, DWORD fillColor, DWORD* argbColor) {
+    if (unlikely(!(fmt->dwFlags & DDPF_RGB) || (fmt->dwFlags & DDPF_PALETTEINDEXED8)))
+      return false;
+
+    const DWORD b = ExpandColorChannel(fillColor, fmt->dwBBitMask);
+    const DWORD g = ExpandColorChannel(fillColor, fmt->dwGBitMask);
+    const DWORD r = ExpandColorChannel(fillColor, fmt->dwRBitMask);
+    const DWORD a = (fmt->dwFlags & DDPF_ALPHAPIXELS) ? ExpandColorChannel(fillColor, fmt->dwRGBAlphaBitMask) : 255;
+
+    *argbColor = b | (g << 8) | (r << 16) | (a << 24);
+
+    return true;
+  }
+
   inline DDCOLORKEY ColorKeyToARGB(const DDPIXELFORMAT* fmt, DWORD colorKey) {
     DDCOLORKEY rgbColorKey = { };
 
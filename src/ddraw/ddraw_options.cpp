@@ -16,14 +16,21 @@ namespace dxvk {
     this->viewportZCorrection    = config.getOption<bool>   ("ddraw.viewportZCorrection",    false);
     this->forceLegacyDiscard     = config.getOption<bool>   ("ddraw.forceLegacyDiscard",     false);
     this->cpuProcessVertices     = config.getOption<bool>   ("ddraw.cpuProcessVertices",      true);
+    this->simdProcessVertices    = config.getOption<bool>   ("ddraw.simdProcessVertices",     true);
+    this->processVerticesThreads = config.getOption<int32_t>("ddraw.processVerticesThreads",     0);
+    this->batching               = config.getOption<bool>   ("ddraw.batching",               false);
     this->backBufferResize       = config.getOption<bool>   ("ddraw.backBufferResize",        true);
     this->forceLegacyPresent     = config.getOption<bool>   ("ddraw.forceLegacyPresent",     false);
     this->forceRTFlip            = config.getOption<bool>   ("ddraw.forceRTFlip",            false);
     this->forceDCForwarding      = config.getOption<bool>   ("ddraw.forceDCForwarding",      false);
+    this->gpuBlits               = config.getOption<bool>   ("ddraw.gpuBlits",                true);
+    this->textureUploadHashing   = config.getOption<bool>   ("ddraw.textureUploadHashing",   false);
+    this->textureEvictionFrames  = config.getOption<int32_t>("ddraw.textureEvictionFrames",      0);
     this->emulateFrontBuffer     = config.getOption<bool>   ("ddraw.emulateFrontBuffer",     false);
     this->ignoreGammaRamp        = config.getOption<bool>   ("ddraw.ignoreGammaRamp",        false);
     this->autoGenMipMaps         = config.getOption<bool>   ("ddraw.autoGenMipMaps",         false);
     this->deviceResourceSharing  = config.getOption<bool>   ("ddraw.deviceResourceSharing",  false);
+    this->deviceReuse            = config.getOption<bool>   ("ddraw.deviceReuse",            false);
     this->colorKeyMasking        = config.getOption<bool>   ("ddraw.colorKeyMasking",        false);
     this->legacyDeviceNames      = config.getOption<bool>   ("ddraw.legacyDeviceNames",      false);
     this->nonLocalVideoMemory    = config.getOption<bool>   ("ddraw.nonLocalVideoMemory",     true);
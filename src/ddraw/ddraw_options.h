@@ -67,6 +67,15 @@ namespace dxvk {
     /// Process vertices on the CPU, instead of relaying to D3D9
     bool cpuProcessVertices;
 
+    /// Use the SIMD kernel when processing vertices on the CPU
+    bool simdProcessVertices;
+
+    /// Number of threads used for processing large vertex batches, 0 for auto
+    int32_t processVerticesThreads;
+
+    /// Merge consecutive small draws with identical state into one draw
+    bool batching;
+
     /// Resize the back buffer size to screen size when needed
     bool backBufferResize;
 
@@ -79,6 +88,15 @@ namespace dxvk {
     /// Forwards all DC operations to D3D9 surfaces
     bool forceDCForwarding;
 
+    /// Performs blits between D3D9 backed surfaces on the GPU, when possible
+    bool gpuBlits;
+
+    /// Skips texture mip uploads when their content hash is unchanged
+    bool textureUploadHashing;
+
+    /// Frames after which idle textures release their DDraw side storage, 0 to disable
+    int32_t textureEvictionFrames;
+
     /// Emulate an explicit D3D9 front buffer by uploading its content from DDraw
     bool emulateFrontBuffer;
 
@@ -91,6 +109,9 @@ namespace dxvk {
     /// Allow cross-device resource (surfaces/textures) use
     bool deviceResourceSharing;
 
+    /// Reuse the D3D9 device of a released D3D device, along with its resources
+    bool deviceReuse;
+
     /// Masks the color key values based on surface format color depth
     bool colorKeyMasking;
 
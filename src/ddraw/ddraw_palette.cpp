@@ -13,8 +13,10 @@ namespace dxvk {
   }
 
   DDrawPalette::~DDrawPalette() {
-    if (m_commonSurf != nullptr)
-      m_commonSurf->SetPalette(nullptr);
+    // Detaching modifies the set, so walk over a copy
+    const std::unordered_set<DDrawCommonSurface*> commonSurfs = m_commonSurfs;
+    for (DDrawCommonSurface* commonSurf : commonSurfs)
+      commonSurf->SetPalette(nullptr);
 
     if (m_parent != nullptr)
       m_parent->Release();
@@ -52,7 +54,15 @@ namespace dxvk {
   }
 
   HRESULT STDMETHODCALLTYPE DDrawPalette::SetEntries(DWORD dwFlags, DWORD dwStartingEntry, DWORD dwCount, LPPALETTEENTRY lpEntries) {
-    return m_proxy->SetEntries(dwFlags, dwStartingEntry, dwCount, lpEntries);
+    HRESULT hr = m_proxy->SetEntries(dwFlags, dwStartingEntry, dwCount, lpEntries);
+    if (unlikely(FAILED(hr)))
+      return hr;
+
+    // Only the palette needs updating, since P8 surface data gets expanded on the GPU
+    for (DDrawCommonSurface* commonSurf : m_commonSurfs)
+      commonSurf->UpdateD3D9Palette();
+
+    return hr;
   }
 
 }
@@ -3,6 +3,8 @@
 #include "ddraw_include.h"
 #include "ddraw_wrapped_object.h"
 
+#include <unordered_set>
+
 namespace dxvk {
 
   class DDrawCommonSurface;
@@ -27,13 +29,18 @@ namespace dxvk {
 
     HRESULT STDMETHODCALLTYPE SetEntries(DWORD dwFlags, DWORD dwStartingEntry, DWORD dwCount, LPPALETTEENTRY lpEntries);
 
-    void SetCommonSurface(DDrawCommonSurface* commonSurf) {
-      m_commonSurf = commonSurf;
+    // A palette can be attached to any number of surfaces
+    void AddCommonSurface(DDrawCommonSurface* commonSurf) {
+      m_commonSurfs.insert(commonSurf);
+    }
+
+    void RemoveCommonSurface(DDrawCommonSurface* commonSurf) {
+      m_commonSurfs.erase(commonSurf);
     }
 
   private:
 
-    DDrawCommonSurface* m_commonSurf   = nullptr;
+    std::unordered_set<DDrawCommonSurface*> m_commonSurfs;
 
   };
 
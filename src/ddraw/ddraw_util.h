@@ -11,17 +11,6 @@
 
 namespace dxvk {
 
-  struct PackedVertexBuffer {
-    UINT stride;
-    std::vector<uint8_t> vertexData;
-  };
-
-  struct VertexStreamInfo {
-    D3DPRIMITIVETYPE d3dpt;
-    D3DVERTEXTYPE d3dvt;
-    DWORD dwFlags = 0;
-  };
-
   inline bool IsValidDDrawCapsSize(DWORD size) {
     return size == sizeof(DDCAPS_DX7)
         || size == sizeof(DDCAPS_DX6)
@@ -176,7 +165,7 @@ namespace dxvk {
     return usageFlagsD3D9;
   }
 
-  inline size_t GetFVFPositionSize(DWORD fvf) {
+  constexpr size_t GetFVFPositionSize(DWORD fvf) {
     size_t size = 0;
 
     switch (fvf & D3DFVF_POSITION_MASK) {
@@ -206,7 +195,7 @@ namespace dxvk {
     return size;
   }
 
-  inline size_t GetFVFTexCoordSize(DWORD fvf, DWORD coord) {
+  constexpr size_t GetFVFTexCoordSize(DWORD fvf, DWORD coord) {
     size_t size = 0;
 
     const DWORD texCoordSize = (fvf >> (coord * 2 + 16)) & 0x3;
@@ -232,7 +221,7 @@ namespace dxvk {
     return size;
   }
 
-  inline size_t GetFVFSize(DWORD fvf) {
+  constexpr size_t GetFVFSize(DWORD fvf) {
     size_t size = 0;
 
     size += GetFVFPositionSize(fvf);
@@ -269,57 +258,6 @@ namespace dxvk {
     }
   }
 
-  inline PackedVertexBuffer TransformStridedtoUP(
-        DWORD dwFVF,
-        LPD3DDRAWPRIMITIVESTRIDEDDATA lpVBStrided,
-        DWORD dwNumVertices) {
-    PackedVertexBuffer pvb;
-    pvb.stride = GetFVFSize(dwFVF);
-    pvb.vertexData.resize(pvb.stride * dwNumVertices);
-
-    const DWORD dwNumTextures = (dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT;
-
-    for (DWORD i = 0; i < dwNumVertices; i++) {
-      uint8_t* ptr = pvb.vertexData.data() + i * pvb.stride;
-
-      if ((dwFVF & D3DFVF_POSITION_MASK) && lpVBStrided->position.lpvData) {
-        const size_t size = GetFVFPositionSize(dwFVF);
-        memcpy(ptr, static_cast<uint8_t*>(lpVBStrided->position.lpvData) + i * lpVBStrided->position.dwStride, size);
-        ptr += size;
-      }
-
-      if ((dwFVF & D3DFVF_NORMAL) && lpVBStrided->normal.lpvData) {
-        memcpy(ptr, static_cast<uint8_t*>(lpVBStrided->normal.lpvData) + i * lpVBStrided->normal.dwStride, 3 * sizeof(FLOAT));
-        ptr += 3 * sizeof(FLOAT);
-      }
-
-      if (dwFVF & D3DFVF_RESERVED1) {
-        // D3DLVERTEX
-        ptr += sizeof(DWORD);
-      }
-
-      if ((dwFVF & D3DFVF_DIFFUSE) && lpVBStrided->diffuse.lpvData) {
-        memcpy(ptr, static_cast<uint8_t*>(lpVBStrided->diffuse.lpvData) + i * lpVBStrided->diffuse.dwStride, sizeof(D3DCOLOR));
-        ptr += sizeof(D3DCOLOR);
-      }
-
-      if ((dwFVF & D3DFVF_SPECULAR) && lpVBStrided->specular.lpvData) {
-        memcpy(ptr, static_cast<uint8_t*>(lpVBStrided->specular.lpvData) + i * lpVBStrided->specular.dwStride, sizeof(D3DCOLOR));
-        ptr += sizeof(D3DCOLOR);
-      }
-
-      for (DWORD t = 0; t < dwNumTextures; t++) {
-        if (lpVBStrided->textureCoords[t].lpvData) {
-          const size_t size = GetFVFTexCoordSize(dwFVF, t);
-          memcpy(ptr, static_cast<uint8_t*>(lpVBStrided->textureCoords[t].lpvData) + i * lpVBStrided->textureCoords[t].dwStride, size);
-          ptr += size;
-        }
-      }
-    }
-
-    return pvb;
-  }
-
   // If this D3DTEXTURESTAGESTATETYPE has been remapped to a d3d9::D3DSAMPLERSTATETYPE
   // it will be returned, otherwise returns -1u
   inline d3d9::D3DSAMPLERSTATETYPE ConvertSamplerStateType(const D3DTEXTURESTAGESTATETYPE StageType) {